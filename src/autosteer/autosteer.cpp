@@ -1,48 +1,191 @@
 #include "autosteer.h"
+
+#include <atomic>
+
 #include "pid_controller.h"
+#include "gain_schedule.h"
+#include "setpoint.h"
+#include "guidance_link.h"
+#include "settings.h"
 #include "buttons.h"
 #include "udp_io.h"
 #include "utils/log.h"
 #include "was.h"
 #include "motor.h"
 #include "imu.h"
+#include "heading.h"
+#include "telemetry.h"
+#include "network/live.h"
+#include "utils/timebase.h"
+#include "utils/trace.h"
+#include "utils/blackbox.h"
+#include "utils/metrics.h"
 #include "config/defines.h"
 
 namespace autosteer {
 bool prevSteerEnable = false;
 bool steerEnable     = false;
 int pulseCount       = 0; //TODO:IMPLEMENT ENCODER
+uint16_t tracedId    = 0; // Last set point whose first control cycle was traced
+std::atomic<bool> inhibited{false};
+State state          = {};
+portMUX_TYPE stateMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void publishState(const State &current) {
+    portENTER_CRITICAL(&stateMux);
+    state = current;
+    portEXIT_CRITICAL(&stateMux);
+}
+
+void setInhibited(bool inhibited_) {
+    inhibited.store(inhibited_);
+}
+
+State getState() {
+    portENTER_CRITICAL(&stateMux);
+    State copy = state;
+    portEXIT_CRITICAL(&stateMux);
+    return copy;
+}
+
 void handler() {
+    static uint32_t lastRun_us = 0;
+    uint32_t run_us = micros();
+    if (lastRun_us != 0) {
+        metrics::observe(metrics::Histogram::control_period_us, run_us - lastRun_us);
+    }
+    lastRun_us = run_us;
+
+    // Trace only the first cycle that runs on a new set point
+    uint16_t traceId = trace::published_id();
+    bool traceCycle  = trace::is_running() && traceId != tracedId;
+    if (traceCycle) {
+        tracedId = traceId;
+        trace::record(trace::Point::control_start, traceId);
+    }
+
     bool hwEnable = buttons::steerBntEnabled();
     bool swEnable = getSwSwitchStatus();
-    if (hwEnable && swEnable) {
+    bool aboveMinSpeed = Set.minSpeed == 0 || getGpsSpeed() >= Set.minSpeed;
+    if (hwEnable && swEnable && aboveMinSpeed && !inhibited.load()) {
         steerEnable = true;
     } else {
         steerEnable = false;
     }
 
     if (steerEnable != prevSteerEnable) {
-        debugf("Steer enable state changed: %s", steerEnable ? "enabled" : "disabled");
+        metrics::inc(metrics::Counter::motor_enable_transitions);
+        LOGD(autosteer, "Steer enable state changed: %s", steerEnable ? "enabled" : "disabled");
         prevSteerEnable = steerEnable;
     }
 
     float steerAngleActual   = was::get_steering_angle(); //get the steering angle from the steering wheel encoder
+    if (traceCycle) trace::record(trace::Point::was_sample, traceId);
     float steerAngleSetPoint = getSteerSetPoint(); //get the steering setpoint AGIO
 
     float steerAngleError = steerAngleActual - steerAngleSetPoint; //calculate the steering error
 
-    auto control_out = calcSteeringPID(steerAngleError); //do the pid
+    auto gains       = gain_schedule::get(getGpsSpeed()); //speed-scheduled gains
+    PidTerms terms;
+    auto control_out = calcSteeringPID(steerAngleError, setpoint::get_rate(), gains, &terms); //do the pid
 
     // Properly limit the PWM value to 0-255 range
     uint8_t pwm   = min(abs(control_out), 255);
     bool reversed = control_out < 0;
 
+    // Guidance past its timeout: GUIDANCE_POLICY decides how much output is left
+    uint32_t now_ms = millis();
+    float authority = guidance_link::authority(now_ms);
+    if (authority < 1.0f) {
+        pwm = static_cast<uint8_t>(pwm * authority);
+    }
+
     if (steerEnable) {
         motor::driveMotor(pwm, reversed); //out to motors the pwm value
+        if (traceCycle) trace::record(trace::Point::pwm_write, traceId);
     } else {
         motor::stopMotor();
         pulseCount = 0; //Reset counters if Autosteer is offline
     }
+
+    publishState({now_ms, steerAngleSetPoint, steerAngleActual, steerAngleError, static_cast<int16_t>(control_out),
+                  static_cast<uint8_t>(steerEnable ? pwm : 0), reversed, steerEnable, hwEnable, swEnable});
+
+    metrics::set(metrics::Gauge::steer_enabled, steerEnable);
+    metrics::set(metrics::Gauge::steer_angle, steerAngleActual);
+    metrics::set(metrics::Gauge::steer_set_point, steerAngleSetPoint);
+    metrics::set(metrics::Gauge::pwm, steerEnable ? pwm : 0);
+    metrics::set(metrics::Gauge::guidance_age_ms, guidance_link::get_stats(now_ms).age_ms);
+
+    if (live::is_active()) {
+        live::Sample sample;
+        sample.time_ms        = now_ms;
+        sample.setPoint       = steerAngleSetPoint;
+        sample.actual         = steerAngleActual;
+        sample.heading        = heading::get();
+        sample.roll           = imu::get_roll();
+        sample.pwm            = steerEnable ? pwm : 0;
+        sample.switches       = (hwEnable ? live::SWITCH_STEER : 0) |
+                                (buttons::workBntEnabled() ? live::SWITCH_WORK : 0) |
+                                (steerEnable ? live::SWITCH_ENABLED : 0);
+        sample.guidanceAge_ms = min(guidance_link::get_stats(now_ms).age_ms, static_cast<uint32_t>(UINT16_MAX));
+        live::record(sample, micros());
+    }
+
+    if (blackbox::due(micros())) {
+        blackbox::Sample sample;
+        sample.time_ms        = now_ms;
+        sample.gnss_us        = timebase::now_gnss();
+        sample.setPoint       = steerAngleSetPoint;
+        sample.actual         = steerAngleActual;
+        sample.heading        = heading::get();
+        sample.roll           = imu::get_roll();
+        sample.pitch          = imu::get_pitch();
+        sample.speed          = getGpsSpeed();
+        sample.output         = static_cast<int16_t>(control_out);
+        sample.pwm            = steerEnable ? pwm : 0;
+        sample.switches       = (hwEnable ? blackbox::SWITCH_STEER : 0) |
+                                (buttons::workBntEnabled() ? blackbox::SWITCH_WORK : 0) |
+                                (steerEnable ? blackbox::SWITCH_ENABLED : 0) |
+                                (reversed ? blackbox::SWITCH_REVERSED : 0) |
+                                (timebase::synced() ? blackbox::SWITCH_SYNCED : 0);
+        auto link             = guidance_link::get_stats(now_ms);
+        sample.guidanceAge_ms = min(link.age_ms, static_cast<uint32_t>(UINT16_MAX));
+        sample.linkState      = static_cast<uint8_t>(link.state);
+        blackbox::record(sample);
+    }
+
+    telemetry::update();
+    if (telemetry::is_enabled()) {
+        auto link = guidance_link::get_stats(now_ms);
+        telemetry::Sample sample;
+        sample.time_us      = timebase::now_gnss();
+        sample.setPoint     = steerAngleSetPoint;
+        sample.actual       = steerAngleActual;
+        sample.error        = steerAngleError;
+        sample.pTerm        = terms.p;
+        sample.ffTerm       = terms.ff;
+        sample.pwmLimit     = terms.limit;
+        sample.setPointRate = setpoint::get_rate();
+        sample.speed        = getGpsSpeed();
+        sample.heading      = heading::get();
+        sample.roll         = imu::get_roll();
+        sample.output       = control_out;
+        sample.wasRaw       = was::get_raw_steering_position();
+        sample.pwm          = steerEnable ? pwm : 0;
+        sample.flags        = (steerEnable ? telemetry::FLAG_ENABLED : 0) |
+                              (reversed ? telemetry::FLAG_REVERSED : 0) |
+                              (hwEnable ? telemetry::FLAG_HW_ENABLE : 0) |
+                              (swEnable ? telemetry::FLAG_SW_ENABLE : 0) |
+                              (timebase::synced() ? telemetry::FLAG_SYNCED : 0);
+        sample.linkAge      = link.age_ms;
+        sample.linkPeriod   = link.period_ms;
+        sample.linkJitter   = link.jitter_ms;
+        sample.linkTimeout  = link.timeout_ms;
+        sample.linkLoss     = link.loss;
+        sample.linkState    = static_cast<uint8_t>(link.state);
+        telemetry::record(sample);
+    }
     if (getLastSentInterval() > 200) {
         sendSteerData();
     }
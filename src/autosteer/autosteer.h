@@ -1,9 +1,30 @@
 #ifndef STEERING_CONTROL_H
 #define STEERING_CONTROL_H
 
+#include <stdint.h>
+
 namespace autosteer {
+// Values of the last control cycle, for readers on other tasks
+struct State {
+    uint32_t time_ms;
+    float setPoint;
+    float actual;
+    float error;
+    int16_t output;
+    uint8_t pwm;       // Applied PWM, 0 while disabled
+    bool reversed;
+    bool enabled;
+    bool hwEnable;
+    bool swEnable;
+};
+
 void handler();
 
+State getState();
+
+// Keeps steering disengaged regardless of the switches, e.g. during a firmware update
+void setInhibited(bool inhibited);
+
 // Get the combined steer switch state (physical button and software switch)
 bool getSteerSwitchState();
 }
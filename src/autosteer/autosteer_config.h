@@ -6,7 +6,35 @@
 #define AUTOSTEER_CONFIG_H
 
 #define LOW_HIGH_DEGREES 3.0
-#define WATCHDOG_TIMEOUT 200 // Watchdog timeout in milliseconds
+#define WATCHDOG_TIMEOUT 200 // Guidance timeout in milliseconds until the packet period is learned
+
+// Set point conditioning between PGN 254 packets
+#define SETPOINT_MODE_HOLD 0        // Apply each packet as received (staircase)
+#define SETPOINT_MODE_INTERPOLATE 1 // Ramp to each new packet over one packet period
+#define SETPOINT_MODE_PREDICT 2     // Extrapolate with the estimated set point rate
+#define SETPOINT_MODE SETPOINT_MODE_PREDICT
+#define SETPOINT_PREDICT_HORIZON 150 // Max extrapolation past the last packet in milliseconds
+#define SETPOINT_MAX_SLEW 60.0f      // Max set point change in degrees per second
+#define SETPOINT_RATE_FILTER 0.5f    // EWMA weight of a new rate sample
+
+// Guidance link watchdog, the timeout follows the learned PGN 254 period
+#define GUIDANCE_POLICY_HOLD 0      // Keep steering on the last set point through the grace window
+#define GUIDANCE_POLICY_FADE 1      // Ramp the motor output down to zero across the grace window
+#define GUIDANCE_POLICY_DISENGAGE 2 // Stop steering at the timeout
+#define GUIDANCE_POLICY GUIDANCE_POLICY_HOLD
+#define GUIDANCE_MISSED_PERIODS 3   // Timeout after this many periods (plus twice the jitter) without a packet
+#define GUIDANCE_GRACE_PERIODS 2    // Length of the hold/fade window in periods
+#define GUIDANCE_TIMEOUT_MIN 100    // Timeout bounds in milliseconds
+#define GUIDANCE_TIMEOUT_MAX 1000
+#define GUIDANCE_LEARN_PACKETS 5    // Intervals needed before the learned period is used
+#define GUIDANCE_RATE_FILTER 0.1f   // EWMA weight of a new interval sample
+#define GUIDANCE_RELEARN_GAPS 5     // Gaps in a row at the same multiple of the period that make it the new period
+#define GUIDANCE_RELEARN_TOLERANCE 0.15f // Allowed deviation of those gaps from the multiple, in periods
+#define GUIDANCE_LOG_INTERVAL 10000 // Link statistics report interval in milliseconds
+
+// Dual antenna heading blending
+#define DUAL_HEADING_GAIN 0.2f     // Weight of each dual antenna epoch against the IMU-propagated heading
+#define DUAL_HEADING_TIMEOUT 500   // Fall back to the IMU heading after this long without a valid epoch (ms)
 
 
 #endif //AUTOSTEER_CONFIG_H
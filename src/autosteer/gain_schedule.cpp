@@ -0,0 +1,39 @@
+#include "gain_schedule.h"
+
+#include "settings.h"
+
+namespace gain_schedule {
+    static Gains from_point(const GainPoint &p) {
+        return {static_cast<float>(p.gainP), static_cast<float>(p.lowPWM), static_cast<float>(p.maxPWM),
+                static_cast<float>(p.minPWM), p.ffGain / 10.0f};
+    }
+
+    static float lerp(float a, float b, float t) {
+        return a + (b - a) * t;
+    }
+
+    Gains get(float speed) {
+        const GainSchedule schedule = settings::getSchedule();
+        if (schedule.count == 0) {
+            return {static_cast<float>(Set.gainP), static_cast<float>(Set.lowPWM), static_cast<float>(Set.maxPWM),
+                    static_cast<float>(Set.minPWM), 0.0f};
+        }
+
+        float speed10 = speed * 10.0f;
+        if (speed10 <= schedule.points[0].speed) {
+            return from_point(schedule.points[0]);
+        }
+        for (uint8_t i = 1; i < schedule.count; i++) {
+            const GainPoint &hi = schedule.points[i];
+            if (speed10 < hi.speed) {
+                const GainPoint &lo = schedule.points[i - 1];
+                float t             = (speed10 - lo.speed) / static_cast<float>(hi.speed - lo.speed);
+                Gains a             = from_point(lo);
+                Gains b             = from_point(hi);
+                return {lerp(a.gainP, b.gainP, t), lerp(a.lowPWM, b.lowPWM, t), lerp(a.maxPWM, b.maxPWM, t),
+                        lerp(a.minPWM, b.minPWM, t), lerp(a.ffGain, b.ffGain, t)};
+            }
+        }
+        return from_point(schedule.points[schedule.count - 1]);
+    }
+}
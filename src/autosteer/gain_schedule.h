@@ -0,0 +1,17 @@
+#ifndef GAIN_SCHEDULE_H
+#define GAIN_SCHEDULE_H
+
+namespace gain_schedule {
+    struct Gains {
+        float gainP;
+        float lowPWM;
+        float maxPWM;
+        float minPWM;
+        float ffGain; // PWM per deg/s of set point rate
+    };
+
+    // Gains interpolated for speed (km/h). Without a configured table the AOG steer settings are used.
+    Gains get(float speed);
+}
+
+#endif //GAIN_SCHEDULE_H
@@ -0,0 +1,226 @@
+#include "guidance_link.h"
+
+#include <Arduino.h>
+#include <cmath>
+
+#include "autosteer_config.h"
+#include "utils/log.h"
+#include "utils/metrics.h"
+
+namespace guidance_link {
+    // Learned link state, written by on_packet() in the UDP task and read by the control task.
+    // Only touched under mux; readers work on a copy so a timeout never mixes two packets.
+    struct Link {
+        bool has_packet;
+        uint32_t last_us;
+        uint32_t last_ms;
+        float period;     // us
+        float jitter;     // us
+        float loss;
+        uint32_t learned; // Intervals folded into the period estimate
+    };
+    static Link link             = {false, 0, 0, 0.0f, 0.0f, 0.0f, 0};
+    static portMUX_TYPE mux      = portMUX_INITIALIZER_UNLOCKED;
+    static uint32_t packets      = 0;
+    static uint32_t missed       = 0;
+
+    // Run of gaps at the same multiple of the period, under mux like link
+    struct Streak {
+        uint32_t periods;
+        uint32_t count;
+        uint32_t sum;    // us
+        uint32_t missed; // Counted as missed while the run lasted
+    };
+    static Streak streak = {};
+
+    // Inter-arrival statistics for the periodic report, UDP task only
+    static uint32_t interval_min = UINT32_MAX;
+    static uint32_t interval_max = 0;
+    static uint32_t interval_sum = 0;
+    static uint32_t interval_cnt = 0;
+    static uint32_t last_report  = 0;
+
+    static Link snapshot() {
+        portENTER_CRITICAL(&mux);
+        Link copy = link;
+        portEXIT_CRITICAL(&mux);
+        return copy;
+    }
+
+    static void report(uint32_t now_ms) {
+        if (now_ms - last_report < GUIDANCE_LOG_INTERVAL || interval_cnt == 0) {
+            return;
+        }
+        Stats stats = get_stats(now_ms);
+        LOGD(autosteer, "Guidance interval: avg=%.1fms min=%.1fms max=%.1fms jitter=%.1fms loss=%.1f%% timeout=%ums n=%u",
+               interval_sum / 1000.0f / interval_cnt, interval_min / 1000.0f, interval_max / 1000.0f,
+               stats.jitter_ms, stats.loss * 100.0f, stats.timeout_ms, interval_cnt);
+        interval_min = UINT32_MAX;
+        interval_max = 0;
+        interval_sum = 0;
+        interval_cnt = 0;
+        last_report  = now_ms;
+    }
+
+    void reset() {
+        portENTER_CRITICAL(&mux);
+        link.has_packet = false;
+        link.period     = 0.0f;
+        link.jitter     = 0.0f;
+        link.loss       = 0.0f;
+        link.learned    = 0;
+        streak          = {};
+        portEXIT_CRITICAL(&mux);
+    }
+
+    static uint32_t timeout_ms(const Link &l) {
+        if (l.learned < GUIDANCE_LEARN_PACKETS) {
+            return WATCHDOG_TIMEOUT;
+        }
+        float timeout = (GUIDANCE_MISSED_PERIODS * l.period + 2.0f * l.jitter) / 1000.0f;
+        if (timeout < GUIDANCE_TIMEOUT_MIN) timeout = GUIDANCE_TIMEOUT_MIN;
+        if (timeout > GUIDANCE_TIMEOUT_MAX) timeout = GUIDANCE_TIMEOUT_MAX;
+        return static_cast<uint32_t>(timeout);
+    }
+
+    static uint32_t grace_ms(const Link &l) {
+        if (GUIDANCE_POLICY == GUIDANCE_POLICY_DISENGAGE) {
+            return 0;
+        }
+        float nominal = l.learned < GUIDANCE_LEARN_PACKETS ? WATCHDOG_TIMEOUT * 1000.0f : l.period;
+        return static_cast<uint32_t>(GUIDANCE_GRACE_PERIODS * nominal / 1000.0f);
+    }
+
+    // A sender that slowed down (10 Hz to 5 Hz) produces gaps that all round to the same multiple
+    // of the old period. After GUIDANCE_RELEARN_GAPS of them in a row the gap is the new period and
+    // the packets counted as missed were never sent. Called under mux, returns true on a re-learn.
+    static bool relearn(uint32_t raw, uint32_t periods) {
+        bool steady = periods > 1 && std::fabs(raw - periods * link.period) < GUIDANCE_RELEARN_TOLERANCE * link.period;
+        if (!steady) {
+            streak = {};
+            return false;
+        }
+        if (periods != streak.periods) {
+            streak = {periods, 0, 0, 0};
+        }
+        streak.count++;
+        streak.sum += raw;
+        streak.missed += periods - 1;
+        if (streak.count < GUIDANCE_RELEARN_GAPS) {
+            return false;
+        }
+        link.period = static_cast<float>(streak.sum) / streak.count;
+        link.loss   = 0.0f;
+        missed -= streak.missed;
+        streak = {};
+        return true;
+    }
+
+    void on_packet(uint32_t now_us) {
+        uint32_t now_ms = millis();
+        packets++;
+
+        portENTER_CRITICAL(&mux);
+        uint32_t interval = now_us - link.last_us;
+        bool reconnect    = !link.has_packet || interval > GUIDANCE_TIMEOUT_MAX * 1000UL * 4;
+        link.last_us      = now_us;
+        link.last_ms      = now_ms;
+        link.has_packet   = true;
+        uint32_t raw      = interval;
+        bool learn        = !reconnect && interval != 0;
+        if (learn) {
+            if (link.learned == 0) {
+                link.period = interval;
+            } else {
+                // Gaps of several periods are loss, not a new rate
+                uint32_t periods = static_cast<uint32_t>(std::lround(interval / link.period));
+                if (periods > 1) {
+                    missed += periods - 1;
+                    link.loss += ((periods - 1) / static_cast<float>(periods) - link.loss) * GUIDANCE_RATE_FILTER;
+                    interval /= periods;
+                } else {
+                    link.loss += (0.0f - link.loss) * GUIDANCE_RATE_FILTER;
+                }
+                if (relearn(raw, periods)) {
+                    interval = raw;
+                } else {
+                    link.jitter += (std::fabs(interval - link.period) - link.jitter) * GUIDANCE_RATE_FILTER;
+                    link.period += (interval - link.period) * GUIDANCE_RATE_FILTER;
+                }
+            }
+            link.learned++;
+        }
+        portEXIT_CRITICAL(&mux);
+
+        if (!learn) {
+            return;
+        }
+        metrics::observe(metrics::Histogram::steer_interval_ms, raw / 1000);
+        if (interval < interval_min) interval_min = interval;
+        if (interval > interval_max) interval_max = interval;
+        interval_sum += interval;
+        interval_cnt++;
+        report(now_ms);
+    }
+
+    static State state_of(const Link &l, uint32_t now_ms) {
+        if (!l.has_packet) {
+            return State::waiting;
+        }
+        uint32_t age     = now_ms - l.last_ms;
+        uint32_t timeout = timeout_ms(l);
+        if (age < timeout) {
+            return State::fresh;
+        }
+        if (age < timeout + grace_ms(l)) {
+            return State::grace;
+        }
+        return State::lost;
+    }
+
+    State state(uint32_t now_ms) {
+        return state_of(snapshot(), now_ms);
+    }
+
+    bool valid(uint32_t now_ms) {
+        State current = state(now_ms);
+        return current == State::fresh || current == State::grace;
+    }
+
+    float authority(uint32_t now_ms) {
+        Link l = snapshot();
+        switch (state_of(l, now_ms)) {
+            case State::fresh:
+                return 1.0f;
+            case State::grace: {
+                if (GUIDANCE_POLICY != GUIDANCE_POLICY_FADE) {
+                    return 1.0f;
+                }
+                uint32_t into  = now_ms - l.last_ms - timeout_ms(l);
+                uint32_t grace = grace_ms(l);
+                return grace > 0 ? 1.0f - static_cast<float>(into) / grace : 0.0f;
+            }
+            default:
+                return 0.0f;
+        }
+    }
+
+    float period_us() {
+        Link l = snapshot();
+        return l.learned < GUIDANCE_LEARN_PACKETS ? 0.0f : l.period;
+    }
+
+    Stats get_stats(uint32_t now_ms) {
+        Link l = snapshot();
+        Stats stats;
+        stats.state      = state_of(l, now_ms);
+        stats.period_ms  = l.period / 1000.0f;
+        stats.jitter_ms  = l.jitter / 1000.0f;
+        stats.loss       = l.loss;
+        stats.timeout_ms = timeout_ms(l);
+        stats.age_ms     = l.has_packet ? now_ms - l.last_ms : 0;
+        stats.packets    = packets;
+        stats.missed     = missed;
+        return stats;
+    }
+}
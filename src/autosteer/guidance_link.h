@@ -0,0 +1,46 @@
+#ifndef GUIDANCE_LINK_H
+#define GUIDANCE_LINK_H
+
+#include <stdint.h>
+
+// Guidance link monitor. Learns the PGN 254 inter-arrival period, tracks jitter and loss
+// as EWMAs and derives the guidance timeout from GUIDANCE_MISSED_PERIODS of that period.
+namespace guidance_link {
+    enum class State : uint8_t {
+        waiting, // No packet since reset
+        fresh,   // Within the timeout
+        grace,   // Past the timeout, GUIDANCE_POLICY decides what steering does
+        lost
+    };
+
+    struct Stats {
+        State state;
+        float period_ms;     // Learned nominal inter-arrival time
+        float jitter_ms;     // Mean deviation from the period
+        float loss;          // Fraction of expected packets that did not arrive
+        uint32_t timeout_ms; // Current timeout
+        uint32_t age_ms;     // Since the last packet
+        uint32_t packets;
+        uint32_t missed;     // Periods without a packet, estimated from the gaps
+    };
+
+    void reset();
+
+    // Called for every PGN 254, now_us is the arrival time
+    void on_packet(uint32_t now_us);
+
+    State state(uint32_t now_ms);
+
+    // Steering may use the guidance data
+    bool valid(uint32_t now_ms);
+
+    // 1 while fresh; with the fade policy it ramps to 0 across the grace window
+    float authority(uint32_t now_ms);
+
+    // Learned period in microseconds, 0 until enough packets arrived
+    float period_us();
+
+    Stats get_stats(uint32_t now_ms);
+}
+
+#endif //GUIDANCE_LINK_H
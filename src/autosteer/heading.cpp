@@ -0,0 +1,65 @@
+#include "heading.h"
+
+#include <Arduino.h>
+
+#include "autosteer_config.h"
+#include "imu.h"
+
+namespace heading {
+    static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    static Source source       = Source::imu;
+    static float blended       = 0.0f;
+    static float last_imu      = 0.0f;
+    static bool has_imu_sample = false;
+    static uint32_t last_dual_ms = 0;
+
+    static float wrap180(float angle) {
+        while (angle > 180.0f) angle -= 360.0f;
+        while (angle < -180.0f) angle += 360.0f;
+        return angle;
+    }
+
+    static float wrap360(float angle) {
+        while (angle >= 360.0f) angle -= 360.0f;
+        while (angle < 0.0f) angle += 360.0f;
+        return angle;
+    }
+
+    void update_dual(float heading_deg, uint32_t now_ms) {
+        portENTER_CRITICAL(&mux);
+        if (source != Source::dual || !imu::is_available()) {
+            // First epoch after a gap, or nothing to bridge the epochs with
+            blended = wrap360(heading_deg);
+        } else {
+            blended = wrap360(blended + DUAL_HEADING_GAIN * wrap180(heading_deg - blended));
+        }
+        source       = Source::dual;
+        last_dual_ms = now_ms;
+        portEXIT_CRITICAL(&mux);
+    }
+
+    void update_imu(uint32_t now_ms) {
+        float imu_heading = imu::get_heading();
+        portENTER_CRITICAL(&mux);
+        float yaw_change = has_imu_sample ? wrap180(imu_heading - last_imu) : 0.0f;
+        last_imu         = imu_heading;
+        has_imu_sample   = true;
+
+        if (source == Source::dual && now_ms - last_dual_ms > DUAL_HEADING_TIMEOUT) {
+            source = Source::imu;
+        }
+        blended = source == Source::dual ? wrap360(blended + yaw_change) : imu_heading;
+        portEXIT_CRITICAL(&mux);
+    }
+
+    float get() {
+        portENTER_CRITICAL(&mux);
+        float value = blended;
+        portEXIT_CRITICAL(&mux);
+        return value;
+    }
+
+    Source get_source() {
+        return source;
+    }
+}
@@ -0,0 +1,24 @@
+#ifndef HEADING_H
+#define HEADING_H
+
+#include <stdint.h>
+
+// Heading source shared by the steer data and the GNSS sentences. A dual antenna heading is
+// carried between GNSS epochs by the IMU yaw change; without one the IMU heading is used.
+namespace heading {
+    enum class Source : uint8_t {
+        imu,  // IMU only, no valid dual antenna heading
+        dual  // Dual antenna heading blended with the IMU yaw
+    };
+
+    // Valid moving base heading in degrees, called per GNSS epoch
+    void update_dual(float heading_deg, uint32_t now_ms);
+
+    // Called at the IMU rate, propagates the blended heading by the IMU yaw change
+    void update_imu(uint32_t now_ms);
+
+    float get();
+    Source get_source();
+}
+
+#endif //HEADING_H
@@ -9,6 +9,10 @@ namespace imu {
         return true;
     }
 
+    bool is_available() {
+        return hw_interface.heading != nullptr;
+    }
+
     float get_heading() {
         if (!hw_interface.heading) {
             return 0.0f;
@@ -22,5 +26,19 @@ namespace imu {
         }
         return hw_interface.roll();
     }
+
+    float get_pitch() {
+        if (!hw_interface.pitch) {
+            return 0.0f;
+        }
+        return hw_interface.pitch();
+    }
+
+    int64_t get_timestamp() {
+        if (!hw_interface.timestamp) {
+            return 0;
+        }
+        return hw_interface.timestamp();
+    }
 }
 
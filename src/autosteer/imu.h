@@ -6,18 +6,24 @@
 namespace imu {
     // Function pointer types for hardware implementation
     using ReadFunc = float (*)();
+    using StampFunc = int64_t (*)();
 
     // Interface structure for hardware implementation
     struct IMUInterface {
         ReadFunc heading = nullptr;
         ReadFunc roll = nullptr;
+        ReadFunc pitch = nullptr;
+        StampFunc timestamp = nullptr; // timebase::now_gnss() of the latest sample
     };
 
     // Function declarations
     bool init(const IMUInterface hw);
+    bool is_available();
 
     float get_heading();
     float get_roll();
+    float get_pitch();
+    int64_t get_timestamp();
 }
 
 #endif //IMU_H
@@ -18,6 +18,11 @@ struct ip_address {
 #define INCOMING_CRC_START_BYTE 2
 #define OUTGOING_CRC_START_BYTE 2
 
+// Frame layout: header(3) + pgn(1) + length(1) + payload(N) + crc(1)
+#define AOG_PGN_OFFSET 3
+#define AOG_LENGTH_OFFSET 4
+#define AOG_PAYLOAD_OFFSET 5
+
 #define AOG_HEADER_BYTES {0x80, 0x81, 0x7F}
 
 
@@ -34,110 +39,76 @@ const uint8_t PGN_HELLO_MODULE = 0xC8;   // 200 - Hello from AgIO to Module
 const uint8_t PGN_HELLO_REPLY = 0x7E;    // 126 - Hello Reply from Steer Module to AgIO
 const uint8_t PGN_SCAN_REQUEST = 0xCA;   // 202 - Scan request from AgIO
 const uint8_t PGN_SUBNET_REPLY = 0xCB;   // 203 - Subnet reply to AgIO
-//unused:
+const uint8_t PGN_GAIN_SCHEDULE = 0x9F;  // 159 - Gain schedule point (ESP32-AIO-AG extension)
+// Registered, currently ignored:
 const uint8_t PGN_CORRECTED_POSITION = 0x64; // 100 - Corrected position from AOG
 const uint8_t PGN_FROM_IMU = 0xD3; // 211 - IMU data from AOG
 const uint8_t PGN_FROM_MACHINE = 0xEF; // 239 - Machine data from AOG
-const uint8_t PGN_64_SECTIONS = 0xE5;
-
-
-// Packets received from AOG (AgOpenGPS)
-#pragma pack(1)
-struct SteerData {
-    const uint8_t header[3] = AOG_HEADER_BYTES;
-    uint8_t pgn = PGN_STEER_DATA;
-    uint8_t length = PAYLOAD_LENGTH;
-    uint16_t speed;        // Bytes 5-6: Speed (little-endian)
-    uint8_t status;        // Byte 7: Status
-    uint16_t steerAngle;   // Bytes 8-9: Steer angle (little-endian)
-    uint8_t xte;           // Byte 10: Cross-track error
-    uint8_t sectionLo;     // Byte 11: Section control low byte
-    uint8_t sectionHi;     // Byte 12: Section control high byte
-    uint8_t crc;           // Byte 13: CRC
-};
-
-struct SteerSettingsPacket {
-    const uint8_t header[3] = AOG_HEADER_BYTES;
-    uint8_t pgn = PGN_STEER_SETTINGS;
-    uint8_t length = PAYLOAD_LENGTH;
-    SteerSettings settings; // Bytes 5-12: Steer settings
-    uint8_t crc;             // Byte 13: CRC
-};
-
-struct SteerConfigPacket {
-    const uint8_t header[3] = AOG_HEADER_BYTES;
-    uint8_t pgn = PGN_STEER_CONFIG;
-    uint8_t length = PAYLOAD_LENGTH;
-    SteerConfig config; // Bytes 5-12: Steer config
-    uint8_t crc;            // Byte 13: CRC
-};
-
-struct HelloModulePacket {
-    const uint8_t header[3] = AOG_HEADER_BYTES;
-    uint8_t data[6] = {200, 3, 56, 0, 0, 0x47};
-};
-
-struct ScanRequestPacket {
-    const uint8_t header[3] = AOG_HEADER_BYTES;
-    uint8_t data[6] = {202, 3, 202, 202, 5, 0x47};
-};
-const HelloModulePacket helloModulePacket;
-const ScanRequestPacket scanRequestPacket;
-
-// Packets sent to AOG (AgOpenGPS)
-struct AutoSteerData {
-    const uint8_t header[3] = AOG_HEADER_BYTES;
-    uint8_t pgn = PGN_FROM_AUTOSTEER;
-    uint8_t length = PAYLOAD_LENGTH;
-    uint16_t actualSteerAngle; // Bytes 3-4: Actual steer angle * 100 (little-endian)
-    uint16_t imuHeading;       // Bytes 5-6: IMU heading HI/LO (little-endian)
-    uint16_t imuRoll;          // Bytes 7-8: IMU roll HI/LO (little-endian)
-    uint8_t switchByte;        // Byte 9: Switch status
-    uint8_t pwmDisplay;        // Byte 10: PWM display
-    uint8_t crc;               // Byte 13: CRC
+const uint8_t PGN_64_SECTIONS = 0xE5; // 229 - 64 section states from AOG
+
+// Payload lengths of packets received from AOG
+const uint8_t SteerData_payload_len = 8;
+const uint8_t SteerSettings_payload_len = 8;
+const uint8_t SteerConfig_payload_len = 8;
+const uint8_t HelloModule_payload_len = 3;
+const uint8_t ScanRequest_payload_len = 3;
+const uint8_t GainSchedule_payload_len = 9;
+const uint8_t ImuData_payload_len = 8;
+const uint8_t MachineData_payload_len = 8;
+const uint8_t Sections64_payload_len = 10;
+
+
+// Source byte used by the reference steer module for hello and subnet replies
+const uint8_t AOG_SOURCE_STEER_MODULE = 126;
+
+// Packets sent to AOG (AgOpenGPS), serialized field by field with pgn::encode()
+struct AutoSteerDataPgn {
+    static constexpr uint8_t source = 0x7F;
+    static constexpr uint8_t pgn    = PGN_FROM_AUTOSTEER;
+    static constexpr uint8_t length = PAYLOAD_LENGTH;
+    // 5-6   actual steer angle * 100 (int16)
+    // 7-8   IMU heading * 10 (int16)
+    // 9-10  IMU roll * 10 (int16)
+    // 11    switch byte
+    // 12    PWM display
 };
 
-struct AutoSteerData2 {
-    const uint8_t header[3] = AOG_HEADER_BYTES;
-    uint8_t pgn = PGN_FROM_AUTOSTEER2;
-    uint8_t length = PAYLOAD_LENGTH;
-    uint8_t sensorValue;     // Byte 3: Sensor value
-    uint8_t reserved1;       // Byte 4: Reserved
-    uint8_t reserved2;       // Byte 5: Reserved
-    uint8_t reserved3;       // Byte 6: Reserved
-    uint8_t reserved4;       // Byte 7: Reserved
-    uint8_t reserved5;       // Byte 8: Reserved
-    uint8_t reserved6;       // Byte 9: Reserved
-    uint8_t reserved7;       // Byte 10: Reserved
-    uint8_t crc;             // Byte 13: CRC
+struct AutoSteerData2Pgn {
+    static constexpr uint8_t source = 0x7F;
+    static constexpr uint8_t pgn    = PGN_FROM_AUTOSTEER2;
+    static constexpr uint8_t length = PAYLOAD_LENGTH;
+    // 5     sensor value
+    // 6-12  reserved
 };
 
-struct HelloReplyPacket {
-    const uint8_t header[3] = AOG_HEADER_BYTES;
-    uint8_t pgn = PGN_HELLO_REPLY;
-    uint8_t length = 5;
-    uint8_t angleLo;         // Byte 3: Angle Low byte
-    uint8_t angleHi;         // Byte 4: Angle High byte
-    uint8_t countsLo;        // Byte 5: Counts Low byte
-    uint8_t countsHi;        // Byte 6: Counts High byte
-    uint8_t switchByte;      // Byte 7: Switch status
-    uint8_t crc;             // Byte 8: CRC
+struct HelloReplyPgn {
+    static constexpr uint8_t source = AOG_SOURCE_STEER_MODULE;
+    static constexpr uint8_t pgn    = PGN_HELLO_REPLY;
+    static constexpr uint8_t length = 5;
+    // 5-6   actual steer angle * 100 (int16)
+    // 7-8   WAS counts (uint16)
+    // 9     switch byte
 };
 
-struct SubnetReplyPacket {
-    const uint8_t header[3] = AOG_HEADER_BYTES;
-    uint8_t pgn = PGN_SUBNET_REPLY;
-    uint8_t length = 7;
-    uint8_t ipOne;          // Byte 3: IP Address first octet
-    uint8_t ipTwo;          // Byte 4: IP Address second octet
-    uint8_t ipThree;        // Byte 5: IP Address third octet
-    uint8_t moduleId = 126; // Byte 6: Module ID (126 for steer)
-    uint8_t srcOne;         // Byte 7: Source Address first octet
-    uint8_t srcTwo;         // Byte 8: Source Address second octet
-    uint8_t srcThree;       // Byte 9: Source Address third octet
-    uint8_t crc;            // Byte 10: CRC
+struct SubnetReplyPgn {
+    static constexpr uint8_t source = AOG_SOURCE_STEER_MODULE;
+    static constexpr uint8_t pgn    = PGN_SUBNET_REPLY;
+    static constexpr uint8_t length = 7;
+    // 5-7   module IP, first three octets
+    // 8     module ID (126 for steer)
+    // 9-11  AgIO IP, first three octets
 };
 
+// gain schedule point
+// 5        point index
+// 6        point count, 0 disables the schedule
+// 7-8      speed km/h * 10
+// 9        P gain
+// 10       low PWM
+// 11       max PWM
+// 12       min PWM
+// 13       feed-forward PWM per deg/s * 10
+// 14       CRC
 
 // data from AOG
 // corrected position
@@ -161,26 +132,9 @@ struct SubnetReplyPacket {
 // 21-28    Fix2Fix         double
 // 29       CRC
 
-#pragma pack()
-
 const size_t AutoSteerData_len = 14;
 const size_t AutoSteerData2_len = 14;
-const size_t SteerData_len = 14;
-const size_t SteerSettings_len = 14;
-const size_t SteerConfigPacket_len = 14;
-const size_t HelloModulePacket_len = 9;
-const size_t ScanRequestPacket_len = 9;
 const size_t HelloReplyPacket_len = 11;
 const size_t SubnetReplyPacket_len = 13;
 
-static_assert(sizeof(AutoSteerData) == AutoSteerData_len, "AutoSteerData size mismatch");
-static_assert(sizeof(AutoSteerData2) == AutoSteerData2_len, "AutoSteerData2 size mismatch");
-static_assert(sizeof(SteerData) == SteerData_len, "SteerData size mismatch");
-static_assert(sizeof(SteerSettingsPacket) == SteerSettings_len, "SteerSettings size mismatch");
-static_assert(sizeof(SteerConfigPacket) == SteerConfigPacket_len, "SteerConfigPacket size mismatch");
-static_assert(sizeof(HelloModulePacket) == HelloModulePacket_len, "HelloModulePacket size mismatch");
-static_assert(sizeof(ScanRequestPacket) == ScanRequestPacket_len, "ScanRequestPacket size mismatch");
-static_assert(sizeof(HelloReplyPacket) == HelloReplyPacket_len, "HelloReplyPacket size mismatch");
-static_assert(sizeof(SubnetReplyPacket) == SubnetReplyPacket_len, "SubnetReplyPacket size mismatch");
-
 #endif //NETWORKING_H
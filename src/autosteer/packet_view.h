@@ -0,0 +1,111 @@
+#ifndef PACKET_VIEW_H
+#define PACKET_VIEW_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "networking.h"
+
+// Read-only view over a validated AOG frame. Fields are assembled byte by byte,
+// so views are safe on unaligned UDP payloads and independent of host endianness.
+class PacketView {
+public:
+    PacketView(const uint8_t *data, size_t len) : data_(data), len_(len) {}
+
+    uint8_t pgn() const { return data_[AOG_PGN_OFFSET]; }
+    uint8_t length() const { return data_[AOG_LENGTH_OFFSET]; }
+    const uint8_t *data() const { return data_; }
+    size_t size() const { return len_; }
+
+    // Payload accessors, offsets relative to the first payload byte
+    uint8_t u8(size_t offset) const { return payload()[offset]; }
+    uint16_t u16(size_t offset) const {
+        return static_cast<uint16_t>(payload()[offset] | (payload()[offset + 1] << 8));
+    }
+    int16_t i16(size_t offset) const { return static_cast<int16_t>(u16(offset)); }
+    uint32_t u32(size_t offset) const {
+        return static_cast<uint32_t>(u16(offset)) | (static_cast<uint32_t>(u16(offset + 2)) << 16);
+    }
+    double f64(size_t offset) const {
+        uint64_t bits = static_cast<uint64_t>(u32(offset)) | (static_cast<uint64_t>(u32(offset + 4)) << 32);
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+private:
+    const uint8_t *payload() const { return data_ + AOG_PAYLOAD_OFFSET; }
+
+    const uint8_t *data_;
+    size_t len_;
+};
+
+// PGN 254 - Steer Data from AOG
+struct SteerDataView : PacketView {
+    using PacketView::PacketView;
+    float speed() const { return static_cast<float>(u16(0)) * 0.1f; } // km/h
+    uint8_t status() const { return u8(2); }
+    float steerAngle() const { return static_cast<float>(i16(3)) * 0.01f; } // degrees
+    uint8_t xte() const { return u8(5); }
+    uint8_t sectionLo() const { return u8(6); }
+    uint8_t sectionHi() const { return u8(7); }
+};
+
+// PGN 252 - Steer Settings from AOG
+struct SteerSettingsView : PacketView {
+    using PacketView::PacketView;
+    SteerSettings settings() const {
+        SteerSettings settings;
+        settings.gainP             = u8(0);
+        settings.highPWM           = u8(1);
+        settings.lowPWM            = u8(2);
+        settings.minPWM            = u8(3);
+        settings.steerSensorCounts = u8(4);
+        settings.wasOffset         = u16(5);
+        settings.ackermanFix       = u8(7);
+        return settings;
+    }
+};
+
+// PGN 251 - Steer Config from AOG
+struct SteerConfigView : PacketView {
+    using PacketView::PacketView;
+    SteerConfig config() const {
+        SteerConfig config;
+        config.setting0      = u8(0);
+        config.pulseCountMax = u8(1);
+        config.was_speed     = u8(2);
+        config.setting1      = u8(3);
+        config.reserved1     = u8(4);
+        config.reserved2     = u8(5);
+        config.reserved3     = u8(6);
+        config.reserved4     = u8(7);
+        return config;
+    }
+};
+
+// PGN 202 - Scan request from AgIO
+struct ScanRequestView : PacketView {
+    using PacketView::PacketView;
+    bool isSubnetScan() const { return u8(0) == 202 && u8(1) == 202 && u8(2) == 5; }
+};
+
+// PGN 159 - Gain schedule point
+struct GainScheduleView : PacketView {
+    using PacketView::PacketView;
+    uint8_t index() const { return u8(0); }
+    uint8_t count() const { return u8(1); }
+    GainPoint point() const {
+        GainPoint point;
+        point.speed  = u16(2);
+        point.gainP  = u8(4);
+        point.lowPWM = u8(5);
+        point.maxPWM = u8(6);
+        point.minPWM = u8(7);
+        point.ffGain = u8(8);
+        return point;
+    }
+};
+
+#endif //PACKET_VIEW_H
@@ -0,0 +1,54 @@
+// Outbound AOG frames. Kept free of Arduino dependencies so the native tests can link it.
+#include "udp_io.h"
+
+#include "pgn_writer.h"
+
+// Calculate CRC for a given data array - this will be our single unified CRC function
+uint8_t calculateCRC(const uint8_t *data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc += data[i];
+    }
+    return crc;
+}
+
+// Switch byte as in the reference firmware: bits are set when the switch is off
+static uint8_t encodeSwitchByte(bool work_switch, bool steer_switch) {
+    return (work_switch ? 0 : 1) | ((steer_switch ? 0 : 1) << 1);
+}
+
+// Write an AutoSteer data packet (PGN 253)
+size_t writeAutoSteerPacket(uint8_t *buf, size_t capacity, float actualSteerAngle, float heading, float roll, bool work_switch, bool steer_switch, uint8_t pwmDisplay) {
+    return pgn::encode<AutoSteerDataPgn>(buf, capacity,
+                                         pgn::Fixed16{actualSteerAngle, 100.0f},
+                                         pgn::Fixed16{heading, 10.0f},
+                                         pgn::Fixed16{roll, 10.0f},
+                                         pgn::U8{encodeSwitchByte(work_switch, steer_switch)},
+                                         pgn::U8{pwmDisplay});
+}
+
+// Write an AutoSteer2 data packet (PGN 250)
+size_t writeAutoSteer2Packet(uint8_t *buf, size_t capacity, uint8_t sensorValue) {
+    return pgn::encode<AutoSteerData2Pgn>(buf, capacity, pgn::U8{sensorValue}, pgn::Pad<7>{});
+}
+
+// Write a HelloReply packet (PGN 126)
+size_t writeHelloReplyPacket(uint8_t *buf, size_t capacity, float actualSteerAngle, uint16_t sensorCounts, bool work_switch, bool steer_switch) {
+    return pgn::encode<HelloReplyPgn>(buf, capacity,
+                                      pgn::Fixed16{actualSteerAngle, 100.0f},
+                                      pgn::U16{sensorCounts},
+                                      pgn::U8{encodeSwitchByte(work_switch, steer_switch)});
+}
+
+// Write a SubnetReply packet (PGN 203), only the first 3 octets are used in the protocol
+size_t writeSubnetReplyPacket(uint8_t *buf, size_t capacity, const ip_address deviceIP, const ip_address sourceIP) {
+    return pgn::encode<SubnetReplyPgn>(buf, capacity,
+                                       pgn::U8{deviceIP.ip[0]}, pgn::U8{deviceIP.ip[1]}, pgn::U8{deviceIP.ip[2]},
+                                       pgn::U8{AOG_SOURCE_STEER_MODULE},
+                                       pgn::U8{sourceIP.ip[0]}, pgn::U8{sourceIP.ip[1]}, pgn::U8{sourceIP.ip[2]});
+}
+
+static_assert(pgn::frameSize<AutoSteerDataPgn>() == AutoSteerData_len, "AutoSteerData size mismatch");
+static_assert(pgn::frameSize<AutoSteerData2Pgn>() == AutoSteerData2_len, "AutoSteerData2 size mismatch");
+static_assert(pgn::frameSize<HelloReplyPgn>() == HelloReplyPacket_len, "HelloReplyPacket size mismatch");
+static_assert(pgn::frameSize<SubnetReplyPgn>() == SubnetReplyPacket_len, "SubnetReplyPacket size mismatch");
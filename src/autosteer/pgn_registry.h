@@ -0,0 +1,98 @@
+#ifndef PGN_REGISTRY_H
+#define PGN_REGISTRY_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "networking.h"
+#include "packet_view.h"
+
+// Compile-time PGN dispatch table. Each PGN is registered once with its
+// expected payload length and handler; lookup is a single array index.
+namespace pgn {
+constexpr uint8_t ANY_LENGTH = 0xFF; // Variable-size PGNs (e.g. corrected position)
+
+using Handler = void (*)(const PacketView &packet, const ip_address &sourceIP);
+
+struct Entry {
+    uint8_t pgn;
+    uint8_t length;  // Expected payload length or ANY_LENGTH
+    bool checkCrc;   // AgIO sends hello and scan with a fixed CRC byte
+    Handler handler;
+};
+
+enum class Result : uint8_t {
+    ok,
+    too_short,
+    bad_header,
+    unknown_pgn,
+    bad_length,
+    incomplete,
+    bad_crc,
+};
+
+template <size_t N>
+struct Table {
+    Entry entries[N];
+    uint8_t index[256]; // PGN -> entry index + 1, 0 when unregistered
+
+    constexpr const Entry *find(uint8_t pgn) const {
+        return index[pgn] ? &entries[index[pgn] - 1] : nullptr;
+    }
+};
+
+// Not constexpr on purpose: reaching it during constant evaluation fails the build
+inline void duplicate_pgn_registration() {}
+
+template <size_t N>
+constexpr Table<N> makeTable(const Entry (&entries)[N]) {
+    static_assert(N < 255, "Too many PGN registrations");
+    Table<N> table{};
+    for (size_t i = 0; i < N; i++) {
+        if (table.index[entries[i].pgn] != 0) {
+            duplicate_pgn_registration();
+        }
+        table.entries[i]            = entries[i];
+        table.index[entries[i].pgn] = static_cast<uint8_t>(i + 1);
+    }
+    return table;
+}
+
+// Validate header, registered PGN, declared length and CRC without re-scanning the frame.
+// The CRC covers everything from the source byte up to the last payload byte.
+template <size_t N>
+Result validate(const Table<N> &table, const uint8_t *data, size_t len, const Entry *&entry) {
+    entry = nullptr;
+    if (len < AOG_PAYLOAD_OFFSET + 1) {
+        return Result::too_short;
+    }
+    for (size_t i = 0; i < sizeof(AOG_HEADER); i++) {
+        if (data[i] != AOG_HEADER[i]) {
+            return Result::bad_header;
+        }
+    }
+    entry = table.find(data[AOG_PGN_OFFSET]);
+    if (entry == nullptr) {
+        return Result::unknown_pgn;
+    }
+    const uint8_t payloadLength = data[AOG_LENGTH_OFFSET];
+    if (entry->length != ANY_LENGTH && payloadLength != entry->length) {
+        return Result::bad_length;
+    }
+    const size_t crcIndex = AOG_PAYLOAD_OFFSET + payloadLength;
+    if (len < crcIndex + 1) {
+        return Result::incomplete;
+    }
+
+    uint8_t crc = 0;
+    for (size_t i = INCOMING_CRC_START_BYTE; i < crcIndex; i++) {
+        crc += data[i];
+    }
+    if (entry->checkCrc && crc != data[crcIndex]) {
+        return Result::bad_crc;
+    }
+    return Result::ok;
+}
+} // namespace pgn
+
+#endif //PGN_REGISTRY_H
@@ -0,0 +1,106 @@
+#ifndef PGN_WRITER_H
+#define PGN_WRITER_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#include "networking.h"
+
+// Single-pass serializer for outbound AOG PGNs. Fields are written straight
+// into the caller's TX buffer and the CRC is accumulated while writing.
+namespace pgn {
+
+template <typename Spec>
+constexpr size_t frameSize() {
+    return AOG_PAYLOAD_OFFSET + Spec::length + 1;
+}
+
+// Sum CRC over source, PGN, length and payload
+class FrameWriter {
+public:
+    explicit FrameWriter(uint8_t *buf) : buf_(buf) {}
+
+    void put(uint8_t value) {
+        buf_[pos_] = value;
+        if (pos_ >= OUTGOING_CRC_START_BYTE) {
+            crc_ += value;
+        }
+        pos_++;
+    }
+
+    void putCrc() { buf_[pos_++] = crc_; }
+    size_t position() const { return pos_; }
+
+private:
+    uint8_t *buf_;
+    size_t pos_  = 0;
+    uint8_t crc_ = 0;
+};
+
+// Field types. Each knows its encoded size so the layout can be checked at compile time.
+struct U8 {
+    static constexpr size_t size = 1;
+    uint8_t value;
+    void write(FrameWriter &w) const { w.put(value); }
+};
+
+struct U16 {
+    static constexpr size_t size = 2;
+    uint16_t value;
+    void write(FrameWriter &w) const {
+        w.put(static_cast<uint8_t>(value & 0xFF));
+        w.put(static_cast<uint8_t>(value >> 8));
+    }
+};
+
+struct I16 {
+    static constexpr size_t size = 2;
+    int16_t value;
+    void write(FrameWriter &w) const { U16{static_cast<uint16_t>(value)}.write(w); }
+};
+
+// Signed fixed-point value: round(value * scale), saturated to int16
+struct Fixed16 {
+    static constexpr size_t size = 2;
+    float value;
+    float scale;
+    void write(FrameWriter &w) const {
+        float scaled = std::round(value * scale);
+        if (!(scaled >= INT16_MIN)) scaled = INT16_MIN; // Also catches NaN
+        if (scaled > INT16_MAX) scaled = INT16_MAX;
+        I16{static_cast<int16_t>(scaled)}.write(w);
+    }
+};
+
+template <size_t N>
+struct Pad {
+    static constexpr size_t size = N;
+    void write(FrameWriter &w) const {
+        for (size_t i = 0; i < N; i++) {
+            w.put(0);
+        }
+    }
+};
+
+// Encode a complete frame for Spec into buf. Returns the frame size, or 0 if the buffer is too small.
+template <typename Spec, typename... Fields>
+size_t encode(uint8_t *buf, size_t capacity, const Fields &...fields) {
+    static_assert((Fields::size + ... + 0) == Spec::length, "Field layout does not match PGN payload length");
+    if (buf == nullptr || capacity < frameSize<Spec>()) {
+        return 0;
+    }
+
+    FrameWriter frame(buf);
+    frame.put(AOG_HEADER[0]);
+    frame.put(AOG_HEADER[1]);
+    frame.put(Spec::source);
+    frame.put(Spec::pgn);
+    frame.put(Spec::length);
+    (fields.write(frame), ...);
+    frame.putCrc();
+    return frame.position();
+}
+} // namespace pgn
+
+#endif //PGN_WRITER_H
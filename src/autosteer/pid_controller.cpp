@@ -3,31 +3,38 @@
 #include <cmath>
 
 #include "autosteer_config.h"
-#include "settings.h"
 
 // Calculate steering PID
-int calcSteeringPID(float steerAngleError) {
-  //Proportional only
-  auto pValue = Set.gainP * steerAngleError;
-  int pwmDrive = pValue;
+int calcSteeringPID(float steerAngleError, float setPointRate, const gain_schedule::Gains &gains,
+                    PidTerms *terms) {
+  //Proportional plus feed-forward; error is actual - set point, so a rising set point drives negative
+  auto pValue  = gains.gainP * steerAngleError;
+  auto ffValue = -gains.ffGain * setPointRate;
+  int pwmDrive = pValue + ffValue;
 
   float errorAbs = std::fabs(steerAngleError);
   float newMax   = 0;
 
   if (errorAbs < LOW_HIGH_DEGREES)
   {
-    auto  highLowPerDeg = ((float)(Set.maxPWM - Set.lowPWM)) / LOW_HIGH_DEGREES;
-    newMax = (errorAbs * highLowPerDeg) + Set.lowPWM;
+    auto  highLowPerDeg = (gains.maxPWM - gains.lowPWM) / LOW_HIGH_DEGREES;
+    newMax = (errorAbs * highLowPerDeg) + gains.lowPWM;
   }
-  else newMax = Set.maxPWM;
+  else newMax = gains.maxPWM;
 
   //add min throttle factor so no delay from motor resistance.
-  if (pwmDrive < 0) pwmDrive -= Set.minPWM;
-  else if (pwmDrive > 0) pwmDrive += Set.minPWM;
+  if (pwmDrive < 0) pwmDrive -= gains.minPWM;
+  else if (pwmDrive > 0) pwmDrive += gains.minPWM;
 
   //limit the pwm drive
   if (pwmDrive > newMax) pwmDrive = newMax;
   if (pwmDrive < -newMax) pwmDrive = -newMax;
 
+  if (terms) {
+    terms->p     = pValue;
+    terms->ff    = ffValue;
+    terms->limit = newMax;
+  }
+
   return pwmDrive;
 }
\ No newline at end of file
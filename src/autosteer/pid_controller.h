@@ -1,7 +1,17 @@
 #ifndef PID_CONTROLLER_H
 #define PID_CONTROLLER_H
 
-// Calculate steering PID
-int calcSteeringPID(float steerAngleError);
+#include "gain_schedule.h"
 
-#endif // PID_CONTROLLER_H 
\ No newline at end of file
+// Intermediate values of the last calculation, for telemetry
+struct PidTerms {
+    float p;
+    float ff;
+    float limit; // PWM limit after the low/high blend
+};
+
+// Calculate steering PID with a feed-forward term on the set point rate (deg/s)
+int calcSteeringPID(float steerAngleError, float setPointRate, const gain_schedule::Gains &gains,
+                    PidTerms *terms = nullptr);
+
+#endif // PID_CONTROLLER_H
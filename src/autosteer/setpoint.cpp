@@ -0,0 +1,110 @@
+#include "setpoint.h"
+
+#include <Arduino.h>
+#include <cmath>
+
+#include "autosteer_config.h"
+#include "guidance_link.h"
+
+namespace setpoint {
+    // update() runs in the UDP task, get() and reset() in the control task; all state below is
+    // only touched under mux so a cycle never sees half of a new packet
+    static portMUX_TYPE mux    = portMUX_INITIALIZER_UNLOCKED;
+    static bool has_sample     = false;
+    static float target        = 0.0f; // Last received set point
+    static uint32_t target_us  = 0;    // Arrival time of the last packet
+    static float rate          = 0.0f; // deg/s
+    static float ramp_start    = 0.0f; // Output when the last packet arrived
+    static float output        = 0.0f;
+    static uint32_t output_us  = 0;
+
+    void reset() {
+        portENTER_CRITICAL(&mux);
+        has_sample = false;
+        rate       = 0.0f;
+        portEXIT_CRITICAL(&mux);
+    }
+
+    static void apply(float target_, uint32_t now_us) {
+        if (!has_sample) {
+            target     = target_;
+            ramp_start = target_;
+            output     = target_;
+            output_us  = now_us;
+            target_us  = now_us;
+            has_sample = true;
+            return;
+        }
+
+        uint32_t interval = now_us - target_us;
+        if (interval == 0) {
+            target = target_;
+            return;
+        }
+
+        float sample_rate = (target_ - target) * 1e6f / interval;
+        rate += (sample_rate - rate) * SETPOINT_RATE_FILTER;
+
+        target     = target_;
+        target_us  = now_us;
+        ramp_start = output;
+    }
+
+    void update(float target_, uint32_t now_us) {
+        portENTER_CRITICAL(&mux);
+        apply(target_, now_us);
+        portEXIT_CRITICAL(&mux);
+    }
+
+    static float raw_setpoint(uint32_t now_us, float period_us) {
+        uint32_t elapsed = now_us - target_us;
+        switch (SETPOINT_MODE) {
+            case SETPOINT_MODE_INTERPOLATE: {
+                if (period_us <= 0.0f || elapsed >= period_us) {
+                    return target;
+                }
+                return ramp_start + (target - ramp_start) * (elapsed / period_us);
+            }
+            case SETPOINT_MODE_PREDICT: {
+                uint32_t horizon = SETPOINT_PREDICT_HORIZON * 1000UL;
+                if (elapsed > horizon) {
+                    elapsed = horizon;
+                }
+                return target + rate * (elapsed / 1e6f);
+            }
+            default:
+                return target;
+        }
+    }
+
+    float get(uint32_t now_us) {
+        // Outside the critical section, guidance_link has its own lock
+        float period_us = guidance_link::period_us();
+
+        portENTER_CRITICAL(&mux);
+        if (!has_sample) {
+            portEXIT_CRITICAL(&mux);
+            return 0.0f;
+        }
+        float desired = raw_setpoint(now_us, period_us);
+
+        // Bounded slew between control cycles
+        float max_step = SETPOINT_MAX_SLEW * ((now_us - output_us) / 1e6f);
+        float step     = desired - output;
+        if (step > max_step) step = max_step;
+        if (step < -max_step) step = -max_step;
+
+        output += step;
+        output_us = now_us;
+        float result = output;
+        portEXIT_CRITICAL(&mux);
+        return result;
+    }
+
+    float get_rate() {
+        portENTER_CRITICAL(&mux);
+        float value = rate;
+        portEXIT_CRITICAL(&mux);
+        return value;
+    }
+}
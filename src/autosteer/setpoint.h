@@ -0,0 +1,22 @@
+#ifndef SETPOINT_H
+#define SETPOINT_H
+
+#include <stdint.h>
+
+// Conditions the steer angle set point between guidance packets so the
+// control loop sees a smooth signal instead of a 5-10 Hz staircase.
+namespace setpoint {
+    // Forget history, the next update is applied directly
+    void reset();
+
+    // New set point from AOG, now_us is the arrival time
+    void update(float target, uint32_t now_us);
+
+    // Conditioned set point for a control cycle at now_us
+    float get(uint32_t now_us);
+
+    // Estimated set point rate in degrees per second
+    float get_rate();
+}
+
+#endif //SETPOINT_H
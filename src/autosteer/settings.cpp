@@ -8,6 +8,9 @@ Storage Set;
 namespace settings {
 SteerSettings settings;
 SteerConfig config;
+static GainSchedule schedule;         // Read by the control task, only copied under schedule_mux
+static GainSchedule pending_schedule; // Filled point by point over UDP
+static portMUX_TYPE schedule_mux = portMUX_INITIALIZER_UNLOCKED;
 // Static interface pointer
 static SettingsInterface hw_interface;
 
@@ -20,6 +23,8 @@ void parse() {
     Set.steerAngleOffset  = settings.wasOffset; // 10-11
     Set.ackermanFix       = settings.ackermanFix; // 12
 
+    Set.minSpeed          = config.was_speed; // 7
+
     Set.invertWAS         = config.setting0 & 0x01;
     Set.isRelayActiveHigh = (config.setting0 >> 1) & 0x01;
     Set.invertSteer       = (config.setting0 >> 2) & 0x01;
@@ -37,7 +42,6 @@ void parse() {
     //TODO:implement encoDer and pressure sensor
     bool shaftEncoder  = (config.setting0 >> 7) & 0x01;
     auto pulseCountMax = config.pulseCountMax;
-// WAS Speed config_packet.was_speed
     bool pressure_sensor = (config.setting1 >> 1) & 0x01;
     bool current_sensor  = (config.setting1 >> 2) & 0x01;
     //TODO: implement switching IMU axis
@@ -45,37 +49,67 @@ void parse() {
 }
 
 void printSettings() {
-    debug("############# Settings #############");
-    debugf("Gain: %d", Set.gainP);
-    debugf("Max PWM: %d", Set.maxPWM);
-    debugf("Low PWM: %d", Set.lowPWM);
-    debugf("Min PWM: %d", Set.minPWM);
-    debugf("Steer Sensor Counts: %d", Set.steerSensorCounts);
-    debugf("Steer Angle Offset: %d", Set.steerAngleOffset);
-    debugf("Ackerman Fix: %d", Set.ackermanFix);
-    debugf("Invert WAS: %d", Set.invertWAS);
-    debugf("Is Relay Active High: %d", Set.isRelayActiveHigh);
-    debugf("Invert Steer: %d", Set.invertSteer);
-    debugf("Single Input WAS: %d", Set.wasType == WASType::single);
-    debugf("Is Cytron: %d", Set.driverType == DriverType::cytron);
-    debugf("Is Danfoss: %d", Set.driverType == DriverType::danfoss);
-    debugf("Steer Switch: %d", Set.steer_switch_type == steer_switch_type_types::SWITCH);
-    debugf("Steer Button: %d", Set.steer_switch_type == steer_switch_type_types::BUTTON);
-    debugf("Shaft Encoder: %d", Set.wasType == WASType::single);
-    debug("################################");
+    LOGD(settings, "############# Settings #############");
+    LOGD(settings, "Gain: %d", Set.gainP);
+    LOGD(settings, "Max PWM: %d", Set.maxPWM);
+    LOGD(settings, "Low PWM: %d", Set.lowPWM);
+    LOGD(settings, "Min PWM: %d", Set.minPWM);
+    LOGD(settings, "Steer Sensor Counts: %d", Set.steerSensorCounts);
+    LOGD(settings, "Steer Angle Offset: %d", Set.steerAngleOffset);
+    LOGD(settings, "Ackerman Fix: %d", Set.ackermanFix);
+    LOGD(settings, "Invert WAS: %d", Set.invertWAS);
+    LOGD(settings, "Is Relay Active High: %d", Set.isRelayActiveHigh);
+    LOGD(settings, "Invert Steer: %d", Set.invertSteer);
+    LOGD(settings, "Single Input WAS: %d", Set.wasType == WASType::single);
+    LOGD(settings, "Is Cytron: %d", Set.driverType == DriverType::cytron);
+    LOGD(settings, "Is Danfoss: %d", Set.driverType == DriverType::danfoss);
+    LOGD(settings, "Steer Switch: %d", Set.steer_switch_type == steer_switch_type_types::SWITCH);
+    LOGD(settings, "Steer Button: %d", Set.steer_switch_type == steer_switch_type_types::BUTTON);
+    LOGD(settings, "Shaft Encoder: %d", Set.wasType == WASType::single);
+    LOGD(settings, "Min Speed: %d", Set.minSpeed);
+    GainSchedule current = getSchedule();
+    for (uint8_t i = 0; i < current.count; i++) {
+        const GainPoint &p = current.points[i];
+        LOGD(settings, "Gain point %d: %.1fkm/h P=%d low=%d max=%d min=%d ff=%.1f",
+               i, p.speed / 10.0f, p.gainP, p.lowPWM, p.maxPWM, p.minPWM, p.ffGain / 10.0f);
+    }
+    LOGD(settings, "################################");
+}
+
+// PWM limits of a point go straight into the motor output, min and low must not exceed max
+static bool validPoint(const GainPoint &point) {
+    return point.minPWM <= point.maxPWM && point.lowPWM <= point.maxPWM;
+}
+
+static void publishSchedule(const GainSchedule &table) {
+    portENTER_CRITICAL(&schedule_mux);
+    schedule = table;
+    portEXIT_CRITICAL(&schedule_mux);
 }
 
 bool init(const SettingsInterface hw) {
     hw_interface = hw;
     settings     = hw_interface.read_settings();
     config       = hw_interface.read_config();
+    if (hw_interface.read_schedule) {
+        GainSchedule stored = hw_interface.read_schedule();
+        bool valid = stored.count <= GAIN_SCHEDULE_MAX_POINTS;
+        for (uint8_t i = 0; valid && i < stored.count; i++) {
+            valid = validPoint(stored.points[i]) && (i == 0 || stored.points[i].speed > stored.points[i - 1].speed);
+        }
+        if (valid) {
+            publishSchedule(stored);
+        } else {
+            LOGW(settings, "Stored gain schedule is invalid, using the steer settings");
+        }
+    }
     parse();
     printSettings();
     return true;
 }
 
 bool updateSettings(const SteerSettings &settings_) {
-    debug("Updating settings");
+    LOGD(settings, "Updating settings");
     settings = settings_;
     hw_interface.write_settings(settings_);
     parse();
@@ -84,11 +118,48 @@ bool updateSettings(const SteerSettings &settings_) {
 }
 
 bool updateConfig(const SteerConfig &config_) {
-    debug("Updating config");
+    LOGD(settings, "Updating config");
     config = config_;
     hw_interface.write_config(config);
     parse();
     printSettings();
     return true;
 }
+
+// Points must arrive in ascending speed order, index 0 first
+bool updateSchedulePoint(uint8_t index, uint8_t count, const GainPoint &point) {
+    if (count > GAIN_SCHEDULE_MAX_POINTS || (count > 0 && index >= count)) {
+        LOGW(settings, "Invalid gain schedule point %d/%d", index, count);
+        return false;
+    }
+    if (count > 0 && !validPoint(point)) {
+        LOGW(settings, "Gain schedule point %d has min or low PWM above max PWM", index);
+        return false;
+    }
+    if (count > 0 && index > 0 && point.speed <= pending_schedule.points[index - 1].speed) {
+        LOGW(settings, "Gain schedule point %d is not above the previous speed", index);
+        return false;
+    }
+    if (count > 0) {
+        pending_schedule.points[index] = point;
+    }
+    // Swap in and persist once the table is complete
+    if (count == 0 || index == count - 1) {
+        pending_schedule.count = count;
+        publishSchedule(pending_schedule);
+        LOGD(settings, "Updating gain schedule");
+        if (hw_interface.write_schedule) {
+            hw_interface.write_schedule(pending_schedule);
+        }
+        printSettings();
+    }
+    return true;
+}
+
+GainSchedule getSchedule() {
+    portENTER_CRITICAL(&schedule_mux);
+    GainSchedule copy = schedule;
+    portEXIT_CRITICAL(&schedule_mux);
+    return copy;
+}
 }
@@ -27,6 +27,24 @@ struct SteerConfig {
     uint8_t reserved3;              // Byte 11: Reserved
     uint8_t reserved4;              // Byte 12: Reserved
 };
+
+constexpr uint8_t GAIN_SCHEDULE_MAX_POINTS = 6;
+
+// One row of the speed-scheduled gain table
+struct GainPoint {
+    uint16_t speed = 0;   // km/h * 10
+    uint8_t gainP  = 50;
+    uint8_t lowPWM = 30;
+    uint8_t maxPWM = 180;
+    uint8_t minPWM = 25;
+    uint8_t ffGain = 0;   // Feed-forward PWM per deg/s of set point rate * 10
+};
+
+// Speed-scheduled gains, points sorted by speed. count == 0 uses the AOG steer settings.
+struct GainSchedule {
+    uint8_t count = 0;
+    GainPoint points[GAIN_SCHEDULE_MAX_POINTS];
+};
 #pragma pack()
 
 // Storage struct for all settings
@@ -41,6 +59,7 @@ struct Storage {
     uint8_t ackermanFix;
 
     // Steer Configuration
+    uint8_t minSpeed; // km/h, steering disengages below this speed when non-zero
     bool invertWAS;
     bool isRelayActiveHigh;
     bool invertSteer;
@@ -58,6 +77,8 @@ namespace settings {
     using WriteStettingsFunc = void (*)(SteerSettings);
     using ReadConfigFunc = SteerConfig (*)();
     using WriteConfigFunc = void (*)(SteerConfig);
+    using ReadScheduleFunc = GainSchedule (*)();
+    using WriteScheduleFunc = void (*)(const GainSchedule &);
 
     // Interface structure for hardware implementation
     struct SettingsInterface {
@@ -65,12 +86,19 @@ namespace settings {
         WriteStettingsFunc write_settings = nullptr;
         ReadConfigFunc read_config = nullptr;
         WriteConfigFunc write_config = nullptr;
+        ReadScheduleFunc read_schedule = nullptr;
+        WriteScheduleFunc write_schedule = nullptr;
     };
 
     // Function declarations
     bool init(SettingsInterface hw);
     bool updateSettings(const SteerSettings &settings);
     bool updateConfig(const SteerConfig &config);
+
+    // Store one gain schedule point, the table is persisted once the last point of count arrives
+    bool updateSchedulePoint(uint8_t index, uint8_t count, const GainPoint &point);
+    // Consistent copy, safe from any task while a new table is published
+    GainSchedule getSchedule();
 }
 
 #endif //AUTOSTEER_SETTINGS_H
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef STEER_PGNS_H
+#define STEER_PGNS_H
+
+#include "pgn_registry.h"
+
+// PGN registry of the steer port: one line per PGN accepted. The handlers are parameters so
+// udp_io.cpp and the host benchmark build the same table from the same list.
+namespace pgn {
+struct SteerHandlers {
+    Handler steerData;
+    Handler steerSettings;
+    Handler steerConfig;
+    Handler hello;
+    Handler scanRequest;
+    Handler gainSchedule;
+    Handler ignore; // Our own broadcasts and other modules' PGNs seen on the port
+};
+
+constexpr auto makeSteerTable(const SteerHandlers &handlers) {
+    const Entry entries[] = {
+        {PGN_STEER_DATA, SteerData_payload_len, true, handlers.steerData},
+        {PGN_STEER_SETTINGS, SteerSettings_payload_len, true, handlers.steerSettings},
+        {PGN_STEER_CONFIG, SteerConfig_payload_len, true, handlers.steerConfig},
+        {PGN_HELLO_MODULE, HelloModule_payload_len, false, handlers.hello},
+        {PGN_SCAN_REQUEST, ScanRequest_payload_len, false, handlers.scanRequest},
+        {PGN_GAIN_SCHEDULE, GainSchedule_payload_len, true, handlers.gainSchedule},
+        {PGN_FROM_AUTOSTEER, ANY_LENGTH, false, handlers.ignore},
+        {PGN_FROM_AUTOSTEER2, ANY_LENGTH, false, handlers.ignore},
+        {PGN_CORRECTED_POSITION, ANY_LENGTH, true, handlers.ignore},
+        {PGN_FROM_IMU, ImuData_payload_len, true, handlers.ignore},
+        {PGN_FROM_MACHINE, MachineData_payload_len, true, handlers.ignore},
+        {PGN_64_SECTIONS, Sections64_payload_len, true, handlers.ignore},
+    };
+    return makeTable(entries);
+}
+} // namespace pgn
+
+#endif //STEER_PGNS_H
@@ -0,0 +1,167 @@
+#include "telemetry.h"
+
+#include <atomic>
+#include <string.h>
+
+#include "config/defines.h"
+
+namespace telemetry {
+    constexpr size_t DATAGRAM_SIZE = TELEMETRY_DATAGRAM_SIZE;
+    constexpr size_t RECORDS_PER_DATAGRAM = (DATAGRAM_SIZE - HEADER_SIZE) / RECORD_SIZE;
+    static_assert(RECORDS_PER_DATAGRAM > 0, "Telemetry datagram too small for one record");
+
+    static bool (*send_func)(const uint8_t *, size_t) = nullptr;
+    static uint8_t *(*acquire_func)(size_t)           = nullptr;
+
+    // Batch state belongs to the control task. configure() from other tasks only posts a
+    // request that update() applies there, so a record is never half-written when it is sent.
+    constexpr uint32_t REQUEST_PENDING = 1u << 31;
+    constexpr uint32_t REQUEST_ENABLED = 1u << 16;
+    static std::atomic<uint32_t> request{0}; // REQUEST_PENDING | REQUEST_ENABLED | decimation
+
+    static std::atomic<bool> enabled{TELEMETRY_ENABLED};
+    static uint16_t decimation  = TELEMETRY_DECIMATION;
+    static uint16_t cycle       = 0;
+    static uint8_t *batch       = nullptr; // Datagram being filled, owned by the transport
+    static size_t count         = 0;
+    static uint32_t sequence    = 0;
+    static uint16_t pending_drops = 0;
+    static Stats stats          = {};
+
+    static void put_u8(uint8_t *&p, uint8_t value) {
+        *p++ = value;
+    }
+
+    static void put_u16(uint8_t *&p, uint16_t value) {
+        *p++ = value & 0xFF;
+        *p++ = value >> 8;
+    }
+
+    static void put_u32(uint8_t *&p, uint32_t value) {
+        put_u16(p, value & 0xFFFF);
+        put_u16(p, value >> 16);
+    }
+
+    static void put_i64(uint8_t *&p, int64_t value) {
+        uint64_t bits = static_cast<uint64_t>(value);
+        put_u32(p, bits & 0xFFFFFFFF);
+        put_u32(p, bits >> 32);
+    }
+
+    static void put_f32(uint8_t *&p, float value) {
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        put_u32(p, bits);
+    }
+
+    static uint16_t saturate_u16(float value) {
+        return value >= 65535.0f ? 65535 : static_cast<uint16_t>(value);
+    }
+
+    static void write_header(uint8_t *buf) {
+        uint8_t *p = buf;
+        put_u8(p, 'T');
+        put_u8(p, 'L');
+        put_u8(p, VERSION);
+        put_u8(p, RECORD_SIZE);
+        put_u32(p, sequence);
+        put_u16(p, static_cast<uint16_t>(count));
+        put_u16(p, pending_drops);
+    }
+
+    static void write_record(uint8_t *p, const Sample &s) {
+        put_i64(p, s.time_us);
+        put_f32(p, s.setPoint);
+        put_f32(p, s.actual);
+        put_f32(p, s.error);
+        put_f32(p, s.pTerm);
+        put_f32(p, s.ffTerm);
+        put_f32(p, s.pwmLimit);
+        put_f32(p, s.setPointRate);
+        put_f32(p, s.speed);
+        put_f32(p, s.heading);
+        put_f32(p, s.roll);
+        put_u16(p, static_cast<uint16_t>(s.output));
+        put_u16(p, static_cast<uint16_t>(s.wasRaw));
+        put_u8(p, s.pwm);
+        put_u8(p, s.flags);
+        put_u16(p, saturate_u16(s.linkAge));
+        put_u16(p, saturate_u16(s.linkPeriod * 10.0f));
+        put_u16(p, saturate_u16(s.linkJitter * 10.0f));
+        put_u16(p, saturate_u16(s.linkTimeout));
+        put_u8(p, static_cast<uint8_t>(s.linkLoss * 200.0f + 0.5f));
+        put_u8(p, s.linkState);
+    }
+
+    bool init(bool (*send_func_)(const uint8_t *, size_t), uint8_t *(*acquire_func_)(size_t)) {
+        send_func    = send_func_;
+        acquire_func = acquire_func_;
+        return true;
+    }
+
+    void configure(bool enabled_, uint16_t decimation_) {
+        request.store(REQUEST_PENDING | (enabled_ ? REQUEST_ENABLED : 0) | (decimation_ == 0 ? 1 : decimation_));
+    }
+
+    void update() {
+        uint32_t pending = request.exchange(0);
+        if (pending == 0) {
+            return;
+        }
+        bool enable = pending & REQUEST_ENABLED;
+        if (!enable) {
+            flush();
+        }
+        decimation = pending & 0xFFFF;
+        cycle      = 0;
+        enabled.store(enable);
+    }
+
+    bool is_enabled() {
+        uint32_t pending = request.load();
+        return pending ? (pending & REQUEST_ENABLED) != 0 : enabled.load();
+    }
+
+    void flush() {
+        if (batch == nullptr) {
+            return;
+        }
+        write_header(batch);
+        send_func(batch, count > 0 ? HEADER_SIZE + count * RECORD_SIZE : 0);
+        if (count > 0) {
+            stats.records += count;
+            stats.datagrams++;
+            sequence++;
+            pending_drops = 0;
+        }
+        batch = nullptr;
+        count = 0;
+    }
+
+    void record(const Sample &sample) {
+        if (!enabled.load() || send_func == nullptr || acquire_func == nullptr) {
+            return;
+        }
+        if (++cycle < decimation) {
+            return;
+        }
+        cycle = 0;
+
+        if (batch == nullptr) {
+            batch = acquire_func(DATAGRAM_SIZE);
+            if (batch == nullptr) {
+                stats.dropped++;
+                pending_drops++;
+                return;
+            }
+        }
+        write_record(batch + HEADER_SIZE + count * RECORD_SIZE, sample);
+        if (++count == RECORDS_PER_DATAGRAM) {
+            flush();
+        }
+    }
+
+    const Stats &get_stats() {
+        return stats;
+    }
+}
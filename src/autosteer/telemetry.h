@@ -0,0 +1,87 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Binary control loop telemetry. Fixed-layout records are batched into MTU-sized
+// datagrams with a sequence number; tools/telemetry_decode.py turns them into CSV.
+//
+// Datagram header (little-endian):
+//   0  'T' 'L'
+//   2  u8  version
+//   3  u8  record size
+//   4  u32 sequence
+//   8  u16 record count
+//   10 u16 records dropped since the previous datagram
+// Record:
+//   0  i64 time (timebase::now_gnss, us)
+//   8  f32 set point        12 f32 actual angle   16 f32 error
+//   20 f32 P term           24 f32 FF term        28 f32 PWM limit
+//   32 f32 set point rate   36 f32 speed          40 f32 heading   44 f32 roll
+//   48 i16 controller output  50 i16 WAS raw  52 u8 PWM  53 u8 flags
+//   54 u16 guidance age (ms)  56 u16 guidance period (0.1 ms)  58 u16 guidance jitter (0.1 ms)
+//   60 u16 guidance timeout (ms)  62 u8 guidance loss (0.5 %)  63 u8 guidance_link::State
+namespace telemetry {
+    constexpr uint8_t VERSION       = 2;
+    constexpr size_t HEADER_SIZE    = 12;
+    constexpr size_t RECORD_SIZE    = 64;
+
+    // Record flag bits
+    constexpr uint8_t FLAG_ENABLED   = 0x01;
+    constexpr uint8_t FLAG_REVERSED  = 0x02;
+    constexpr uint8_t FLAG_HW_ENABLE = 0x04;
+    constexpr uint8_t FLAG_SW_ENABLE = 0x08;
+    constexpr uint8_t FLAG_SYNCED    = 0x10; // Time is GNSS-disciplined
+
+    struct Sample {
+        int64_t time_us;
+        float setPoint;
+        float actual;
+        float error;
+        float pTerm;
+        float ffTerm;
+        float pwmLimit;
+        float setPointRate;
+        float speed;
+        float heading;
+        float roll;
+        int16_t output;
+        int16_t wasRaw;
+        uint8_t pwm;
+        uint8_t flags;
+        // Guidance link quality, see guidance_link::Stats
+        uint32_t linkAge;
+        float linkPeriod;
+        float linkJitter;
+        uint32_t linkTimeout;
+        float linkLoss;
+        uint8_t linkState;
+    };
+
+    struct Stats {
+        uint32_t records;   // Records written into datagrams
+        uint32_t datagrams;
+        uint32_t dropped;   // Records lost because no TX buffer was free
+    };
+
+    // send_func takes back every buffer acquire_func hands out
+    bool init(bool (*send_func)(const uint8_t *, size_t), uint8_t *(*acquire_func)(size_t));
+
+    // decimation 1 keeps every control cycle, N keeps every Nth. Safe from any task, takes
+    // effect at the next update().
+    void configure(bool enabled, uint16_t decimation);
+    // Requested state, including a configure() not applied yet
+    bool is_enabled();
+
+    // Control task only, once per cycle before record()
+    void update();
+    void record(const Sample &sample);
+
+    // Send a partly filled datagram, control task only
+    void flush();
+
+    const Stats &get_stats();
+}
+
+#endif //TELEMETRY_H
@@ -6,27 +6,39 @@
 #include "networking.h"
 
 // Function declarations
-bool initAutosteerCommunication(bool(*send_func_)(const uint8_t*, size_t), ip_address our_ip_);
-void processReceivedPacket(const uint8_t* data, size_t len, ip_address sourceIP);
+// acquire_func_ optionally provides transport-owned TX buffers. A buffer it returns is always
+// handed back through send_func_, with len 0 if nothing could be written.
+bool initAutosteerCommunication(bool(*send_func_)(const uint8_t*, size_t), ip_address our_ip_,
+                                uint8_t*(*acquire_func_)(size_t) = nullptr);
+// Returns true when the packet was a valid, registered AOG frame
+bool processReceivedPacket(const uint8_t* data, size_t len, ip_address sourceIP);
 
 // Helper functions
 uint8_t calculateCRC(const uint8_t* data, size_t length);
-bool verifyPacketCRC(const uint8_t* data, size_t length);
-AutoSteerData createAutoSteerPacket(float actualSteerAngle, float heading, float roll, bool work_switch, bool steer_switch, uint8_t pwmDisplay);
-AutoSteerData2 createAutoSteer2Packet(uint8_t sensorValue);
-HelloReplyPacket createHelloReplyPacket(float actualSteerAngle, uint16_t sensorCounts, bool work_switch, bool steer_switch);
-SubnetReplyPacket createSubnetReplyPacket(ip_address deviceIP, ip_address sourceIP);
+
+// Packet writers: serialize straight into buf, return the frame length or 0 if capacity is too small
+size_t writeAutoSteerPacket(uint8_t* buf, size_t capacity, float actualSteerAngle, float heading, float roll, bool work_switch, bool steer_switch, uint8_t pwmDisplay);
+size_t writeAutoSteer2Packet(uint8_t* buf, size_t capacity, uint8_t sensorValue);
+size_t writeHelloReplyPacket(uint8_t* buf, size_t capacity, float actualSteerAngle, uint16_t sensorCounts, bool work_switch, bool steer_switch);
+size_t writeSubnetReplyPacket(uint8_t* buf, size_t capacity, ip_address deviceIP, ip_address sourceIP);
 
 // Send data functions
 bool sendAutoSteerData(float actualSteerAngle, float heading, float roll, bool work_switch, bool steer_switch, uint8_t pwmDisplay);
 bool sendAutoSteer2Data(uint8_t sensorValue);
 bool sendHelloReply(float actualSteerAngle, uint16_t sensorCounts, bool work_switch, bool steer_switch);
 bool sendSubnetReply(ip_address deviceIP, ip_address sourceIP);
+// Unsolicited PGN 203 so AgIO sees a new or changed address without scanning
+bool sendSubnetAnnouncement();
+
+// Address reported in subnet replies, updated when the network comes back up
+void setDeviceIP(ip_address deviceIP);
 
 // Status functions
 bool guidancePacketValid();
 bool getSwSwitchStatus();
 float getSteerSetPoint();
+float getGpsSpeed();
+int64_t getSteerDataTime(); // timebase::now_gnss() of the last steer data packet
 
 uint32_t getLastSentInterval();
 void sendSteerData();
@@ -11,6 +11,10 @@ namespace was {
         return true;
     }
 
+    bool is_available() {
+        return hw_interface.readRaw != nullptr;
+    }
+
     int16_t get_raw_steering_position() {
         if (hw_interface.readRaw) {
             return hw_interface.readRaw();
@@ -46,6 +50,13 @@ namespace was {
         return static_cast<uint16_t>(get_raw_steering_position());
     }
 
+    int64_t get_timestamp() {
+        if (hw_interface.timestamp) {
+            return hw_interface.timestamp();
+        }
+        return 0;
+    }
+
     WASType get_type(){
         return Set.wasType;
     }
@@ -11,13 +11,16 @@ enum class WASType : uint8_t {
 namespace was {
 // Function pointer types for hardware implementation
 using ReadRawFunc = int16_t (*)();
+using StampFunc = int64_t (*)();
 
 // Interface structure for hardware implementation
 struct WASInterface {
     ReadRawFunc readRaw = nullptr;
+    StampFunc timestamp = nullptr; // timebase::now_gnss() of the latest conversion
 };
 
 bool init(WASInterface hw);
+bool is_available();
 
 int16_t get_raw_steering_position();
 
@@ -31,6 +34,9 @@ uint8_t get_wheel_angle_sensor_raw();
 // Get wheel angle sensor counts for hello messages
 uint16_t get_wheel_angle_sensor_counts();
 
+// Time of the latest sample, 0 if the hardware does not stamp samples
+int64_t get_timestamp();
+
 WASType get_type();
 }
 
@@ -7,6 +7,10 @@
 
 #define LOGSerial USBSerial
 
+#define LOG_DEFAULT_LEVEL LogLevel::DEBUG // Per category until changed with the "log" diagnostics command
+#define LOG_RATE_LIMIT 5                  // Messages per second per call site, 0 for no limit
+#define LOG_BURST 10                      // Messages a quiet call site may send at once
+
 #define GPSSerial Serial2
 
 #define STATIC_IP_ADDR {192, 168, 178, 126}
@@ -18,14 +22,103 @@
 
 #define GPS_DEFAULT_CONFIGURATION false
 
+#define GPS_OUTPUT_PASSTHROUGH 0 // Forward the receiver output unchanged
+#define GPS_OUTPUT_PANDA 1       // Parse UBX NAV-PVT and send PANDA with IMU heading and roll
+#define GPS_OUTPUT_PAOGI 2       // Parse UBX NAV-PVT and send PAOGI
+#define GPS_OUTPUT_MODE GPS_OUTPUT_PASSTHROUGH
+#define GPS_NAV_RATE_HZ 10
+#define GPS_DUAL_ANTENNA false        // Receiver outputs NAV-RELPOSNED from a moving base setup
+#define DUAL_BASELINE_CM 0            // Expected antenna separation, 0 skips the length check
+#define DUAL_BASELINE_TOLERANCE_CM 10 // Allowed deviation from DUAL_BASELINE_CM
+#define DUAL_HEADING_OFFSET 0.0f      // Added to the baseline heading, 90 for antennas mounted across the vehicle
+#define DUAL_MAX_HEADING_ACCURACY 1.0f // Reject epochs whose heading accuracy is worse (degrees)
+#define GPS_PROBE_TIMEOUT 250  // Wait per baud rate during detection (ms)
+#define GPS_CONFIG_TIMEOUT 500 // Wait for the configuration ACK (ms)
+
 #define BUTTONS_TASK_PRIORITY 6
 #define WAS_TASK_PRIORITY 4
 #define AUTOSTEER_TASK_PRIORITY 5
 #define IMU_TASK_PRIORITY 3
 #define GPS_TASK_PRIORITY (10)
 
+#define SCHEDULER_CYCLIC false    // Run WAS, IMU, buttons, autosteer and GPS from one cyclic executive task
+#define CYCLIC_FRAME_US 1000      // Minor frame, whole FreeRTOS ticks
+#define CYCLIC_TASK_PRIORITY 5    // Autosteer priority; the GPS handler gives up its own higher one
+#define CYCLIC_STACK_SIZE 6144
+
 #define AgOpenGPS_UDP_PORT 9999
 #define STEER_UDP_PORT 8888
 #define GPS_UDP_PORT 2233
+#define TELEMETRY_UDP_PORT 7778
+#define DIAG_UDP_PORT 7779
+
+#define TELEMETRY_ENABLED false
+#define TELEMETRY_DECIMATION 1        // Keep every Nth control cycle, 1 streams at the 1 kHz loop rate
+#define TELEMETRY_DATAGRAM_SIZE 1472 // Records are batched up to this size
+
+#define TRACE_ENABLED false     // Start latency tracing at boot, otherwise "trace start" on the diagnostics port
+#define TRACE_BUFFER_SIZE 2048  // Events kept in RAM, power of two (12 bytes each)
+
+#define STRESS_BASELINE_MS 3000   // Quiet window before the flood, calibrates the idle counters
+#define STRESS_MAX_PERIOD_US 5000 // Longest control loop period that still passes
+#define STRESS_MAX_P99_US 2000    // 99th percentile control loop period that still passes
+
+#define TIMEBASE_HOLDOVER 10000    // Timestamps count as GNSS-synced this long after the last PPS pairing (ms)
+#define TIMEBASE_DRIFT_FILTER 0.1f // EWMA weight of a new drift sample
+#define TIMEBASE_MAX_GAP 10000     // Longest PPS pairing interval used for a drift sample (ms)
+
+#define RTCM_VALIDATE true     // Frame and CRC check corrections, false writes datagrams to the UART unchanged
+#define RTCM_RING_SIZE 4096    // Queued correction bytes, power of two
+#define RTCM_DEDUP_SLOTS 16    // Recent frames remembered for duplicate detection
+#define RTCM_DEDUP_WINDOW 250  // Identical frames from another source within this window are dropped (ms)
+#define RTCM_SOURCES 4         // Senders reassembled in parallel, a further sender takes over the quietest
+#define RTCM_FRAME_TIMEOUT 100 // A partial frame with no more data from its source for this long is dropped (ms)
+
+#define UDP_TX_POOL_SIZE 8
+#define UDP_TX_BUFFER_SIZE 1472 // One Ethernet MTU of UDP payload
+#define UDP_UNICAST_TO_AGIO false // Reply to the AgIO address learned from valid packets instead of broadcasting
+#define AGIO_ADDRESS_TIMEOUT 5000 // Fall back to broadcast when AgIO has been silent this long (ms)
+
+#define UDP_RX_FAST_PATH false  // Hand steer and correction datagrams to the udp_rx task instead of AsyncUDP's
+#define UDP_RX_QUEUE_SIZE 16    // Fast path datagrams waiting for the udp_rx task
+#define UDP_RX_TASK_PRIORITY 7  // Above the control tasks so a set point is never queued behind them
+
+#define HTTP_PORT 80
+#define HTTP_MAX_CLIENTS 2         // Open connections, more are answered with 503
+#define HTTP_TASK_PRIORITY 1       // Below every control task
+#define HTTP_TASK_CORE 0           // Core of the lwIP and Ethernet tasks, control tasks are not pinned
+#define HTTP_POLL_INTERVAL 10      // Accept and read poll period in milliseconds
+#define HTTP_REQUEST_TIMEOUT 2000  // Close connections without a request line after this long (ms)
+#define HTTP_REQUEST_SIZE 1024     // Request header bytes kept, longer headers are cut
+#define HTTP_CHUNK_SIZE 512        // Response buffer, sent as one chunk when full
+
+#define LIVE_MAX_CLIENTS 3         // WebSocket clients on /ws
+#define LIVE_MAX_RATE 200          // Sampling rate of the shared ring in Hz, clients pick 10 up to this
+#define LIVE_DEFAULT_RATE 50
+#define LIVE_RING_SIZE 64          // Samples between the control task and the sender, power of two
+#define LIVE_TASK_PRIORITY 2       // Above HTTP, below every control task
+#define LIVE_POLL_INTERVAL 5       // Sender period in milliseconds
+
+#define OTA_PORT 3232
+#define OTA_SECRET ""              // Shared secret for tools/ota_push.py, updates are refused while empty
+#define OTA_CHUNK_SIZE 4096        // Flash write unit, one sector
+#define OTA_ACK_INTERVAL 65536     // Bytes between PROGRESS replies
+#define OTA_IDLE_TIMEOUT 5000      // Abort a transfer after this long without data (ms)
+#define OTA_TASK_PRIORITY 1        // Below every control task
+#define OTA_HEALTH_TIMEOUT 30000   // A new image must see WAS, IMU and network within this long (ms)
+#define OTA_BOOT_ATTEMPTS 3        // Boots of a new image before it is rolled back unchecked
+
+#define HEAP_GUARD_OFF 0    // Allocations pass through uncounted
+#define HEAP_GUARD_COUNT 1  // Count allocations after boot, per task group
+#define HEAP_GUARD_TRAP 2   // Also abort on an allocation from a control task after boot
+#define HEAP_GUARD_MODE HEAP_GUARD_COUNT
+
+#define BLACKBOX_ENABLED false       // Flash writes stall both cores, measure the control period before enabling
+#define BLACKBOX_RATE 50             // Records per second, 28 bytes each
+#define BLACKBOX_PARTITION "spiffs"  // Data partition of the default partition table, formatted as LittleFS
+#define BLACKBOX_BUFFER_SIZE 2048    // Each of the two RAM buffers, appended to flash when full
+#define BLACKBOX_SEGMENT_SIZE 65536  // Segment file size, the oldest segment goes when space runs out
+#define BLACKBOX_TASK_PRIORITY 1     // Below every control task
+#define BLACKBOX_TASK_CORE 0         // Away from the control loop core
 
 #endif // DEFINES_H
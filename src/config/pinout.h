@@ -7,6 +7,7 @@
 
 #define GPS_RX_PIN 1
 #define GPS_TX_PIN 2
+#define GPS_PPS_PIN -1 // Receiver TIMEPULSE output, -1 when not connected
 
 #define STEER_BTN_PIN 12
 #define WORK_BTN_PIN 13
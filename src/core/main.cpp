@@ -4,39 +4,74 @@
 #include "autosteer/autosteer.h"
 #include "WebServer_ESP32_SC_W6100.h"
 #include "network/udp.h"
+#include "network/udp_tx.h"
+#include "network/udp_rx.h"
+#include "network/http_server.h"
+#include "network/live.h"
+#include "network/ota.h"
+#include "gps/rtcm.h"
+#include "utils/timebase.h"
+#include "utils/blackbox.h"
+#include "utils/heap_guard.h"
 #include "../hardware/i2c_manager.h"
 #include "hardware/hardware.h"
 #include "tasks.h"
 
 void setup() {
+  // A pending image counts its boot before any driver can crash or hang
+  ota::count_boot();
+
   // Initialize basic logging first
   initLogging();
 
   // Log system startup
-  info("System Startup - Version " + String(FIRMWARE_VERSION) + " (" + String(BUILD_DATE) + ")");
+  infof("System Startup - Version %s (%s)", FIRMWARE_VERSION, BUILD_DATE);
   LOGSerial.println("//////////////////////////");
   LOGSerial.println("/////  ESP32-AIO-AG  /////");
   LOGSerial.println("//////////////////////////");
 
 
 
+  // Returns before DHCP completes, the address arrives while the sensors and tasks start
   initializeEthernet();
-  debug("Ethernet initialized");
+  debug("Ethernet started");
   initUDPLogging();
 
   hw::init();
   debug("Hardware initialized");
 
+  ota::init();
+
+  if (BLACKBOX_ENABLED) {
+    blackbox::init();
+  }
+
   create_tasks();
   debug("Tasks created");
 
   initUDP();
   debug("UDP initialized");
 
+  http::init();
+  live::init();
+
   info("System ready");
+  // Runtime buffers are all in place, any allocation from here on is counted
+  heap_guard::mark_ready();
 }
 
 
 void loop() {
+  static uint32_t lastStats = 0;
+  if (millis() - lastStats > 60000) {
+    lastStats = millis();
+    udp_tx::print_stats();
+    udp_rx::print_stats();
+    rtcm::print_stats();
+    timebase::print_status();
+    heap_guard::print_stats();
+  }
+  heap_guard::update();
+  ota::handler();
   delay(1000);
 }
\ No newline at end of file
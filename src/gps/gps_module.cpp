@@ -3,17 +3,22 @@
 #include "config/defines.h"
 #include "../network/udp.h"
 #include "../utils/log.h"
+#include "../utils/timebase.h"
+#include "../utils/metrics.h"
+#include "../autosteer/imu.h"
+#include "../autosteer/heading.h"
+#include "gps_startup.h"
+#include "nmea_builder.h"
+#include "rtcm.h"
+#include "ubx_parser.h"
 #include <SparkFun_u-blox_GNSS_Arduino_Library.h>
 
 namespace gps {
-constexpr size_t test_bauds_len          = 4;
-constexpr int test_bauds[test_bauds_len] = {38400, 115200, 230400,460800};
-constexpr int selected_baud              = 460800;
-
 static bool gpsConnected = false;
 
 // Define the target IP and port for sending GPS data
 static bool (*udp_send_func)(const uint8_t *, size_t) = nullptr;
+static uint8_t *(*udp_acquire_func)(size_t)           = nullptr;
 
 // GNSS module instance
 static SFE_UBLOX_GNSS myGNSS;
@@ -22,21 +27,9 @@ bool configureGPS();
 
 // Initialize GPS module
 bool init() {
-    bool resp = false;
-    debug("Initializing GPS...");
-    for (const int test_baud: test_bauds) {
-        debugf("Testing baud rate: %d", test_baud);
-        GPSSerial.end();
-        GPSSerial.setRxBufferSize(1024 * 5);
-        GPSSerial.begin(test_baud, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
-        delay(200);
-        if ((resp = myGNSS.begin(GPSSerial, defaultMaxWait, false))) {
-            break;
-        }
-    }
-
-    if (!resp) {
-        error("GPS - Not detected");
+    LOGD(gps, "Initializing GPS...");
+    if (!gps_startup::connect(myGNSS)) {
+        LOGE(gps, "GPS - Not detected");
         gpsConnected = false;
         return false;
     }
@@ -48,42 +41,14 @@ bool init() {
 }
 
 bool configureGPS() {
-    bool resp = true;
-    // update uart1 baud rate
-    debugf("Setting UART1 baud rate to %d", selected_baud);
-    myGNSS.setSerialRate(selected_baud, COM_PORT_UART1); // Set the UART port to fast baud rate
-    GPSSerial.end();
-    GPSSerial.setRxBufferSize(1024 * 5);
-    GPSSerial.begin(selected_baud, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
-    resp = myGNSS.begin(GPSSerial, defaultMaxWait, false);
-
-    if (GPS_DEFAULT_CONFIGURATION) {
-        //we could configure the gps module here. Not used for dual antenna setups and custom configurations
-        /*myGNSS.setNavigationFrequency(10);
-
-        bool resp = myGNSS.setUART1Output(COM_TYPE_UBX | COM_TYPE_NMEA);  // Set the UART port to output NMEA
-        if (resp == false) {
-            error("GPS - Failed to set UART1 output.");
-        }
-        // Enable required NMEA messages
-        resp &= myGNSS.enableNMEAMessage(UBX_NMEA_GGA, COM_PORT_UART1);
-        resp &= myGNSS.enableNMEAMessage(UBX_NMEA_GSA, COM_PORT_UART1);
-        resp &= myGNSS.enableNMEAMessage(UBX_NMEA_GSV, COM_PORT_UART1);
-        resp &= myGNSS.enableNMEAMessage(UBX_NMEA_RMC, COM_PORT_UART1);
-        resp &= myGNSS.enableNMEAMessage(UBX_NMEA_GST, COM_PORT_UART1);
-        resp &= myGNSS.enableNMEAMessage(UBX_NMEA_GLL, COM_PORT_UART1);
-        resp &= myGNSS.enableNMEAMessage(UBX_NMEA_VTG, COM_PORT_UART1);
-        if (resp == false) {
-            error("GPS - Failed to enable NMEA.");
-        }
-        */
-    }
+    bool resp = gps_startup::configure(myGNSS);
 
     if (resp == false) {
-        error("GPS - Failed to set GPS mode.");
-    } else {
-        debug("GPS - Module configuration complete");
+        LOGE(gps, "GPS - Failed to set GPS mode.");
+        // Raw forwarding still works with whatever the receiver is sending
+        return GPS_OUTPUT_MODE == GPS_OUTPUT_PASSTHROUGH;
     }
+    LOGD(gps, "GPS - Module configuration complete");
     return resp;
 }
 
@@ -93,13 +58,26 @@ bool forward_udp_to_serial(const uint8_t *data, size_t len) {
         return false;
     }
     // Forward raw data to GPS via serial
-    GPSSerial.write(data, len);
+    metrics::inc(metrics::Counter::gps_bytes_forwarded, GPSSerial.write(data, len));
     return true;
 }
 
-// Forward correction data from UDP to Serial
-bool forward_correction_to_serial(const uint8_t *data, size_t len) {
-    return forward_udp_to_serial(data, len);
+// Queue correction data from UDP, the GNSS task writes it to Serial
+bool forward_correction_to_serial(const uint8_t *data, size_t len, uint32_t source) {
+    if (!RTCM_VALIDATE) {
+        return forward_udp_to_serial(data, len);
+    }
+    if (!gpsConnected) {
+        return false;
+    }
+    rtcm::ingest(data, len, source, millis());
+    return true;
+}
+
+static size_t write_serial(const uint8_t *data, size_t len) {
+    size_t written = GPSSerial.write(data, len);
+    metrics::inc(metrics::Counter::gps_bytes_forwarded, written);
+    return written;
 }
 
 // Set the UDP sender function for GPS data
@@ -109,30 +87,125 @@ void set_udp_sender(bool (*send_func)(const uint8_t *, size_t)) {
 
 // Handle UDP messages received from AgOpenGPS
 void process_udp_message(const uint8_t *data, size_t len, const ip_address &sourceIP) {
-    // Forward the message to the GPS
-    forward_udp_to_serial(data, len);
+    // Forward the corrections to the GPS
+    uint32_t source = (static_cast<uint32_t>(sourceIP.ip[0]) << 24) | (sourceIP.ip[1] << 16) | (sourceIP.ip[2] << 8) |
+                      sourceIP.ip[3];
+    forward_correction_to_serial(data, len, source);
 }
 
 const size_t buffer_size = 256; // Set the buffer size for NMEA messages
 static uint8_t buffer[buffer_size];
-int buffer_pos = 0; // Initialize buffer position
+
+static ubx::Parser ubx_parser;
+static float last_heading     = 0.0f;
+static uint32_t last_epoch_ms = 0;
+
+// Build and send one sentence per NAV-PVT epoch with the IMU sample taken at that epoch
+static void send_epoch(const ubx::NavPvtView &pvt) {
+    nmea::Attitude attitude;
+    nmea::Sentence sentence = GPS_OUTPUT_MODE == GPS_OUTPUT_PAOGI ? nmea::Sentence::paogi : nmea::Sentence::panda;
+    bool dual        = heading::get_source() == heading::Source::dual;
+    attitude.heading = sentence == nmea::Sentence::panda || dual ? heading::get() : pvt.headMot() * 1e-5f;
+    attitude.roll    = imu::get_roll();
+    attitude.pitch   = imu::get_pitch();
+
+    // Yaw rate from the heading change between epochs, wrapped to +-180
+    uint32_t now = millis();
+    float delta  = attitude.heading - last_heading;
+    if (delta > 180.0f) delta -= 360.0f;
+    if (delta < -180.0f) delta += 360.0f;
+    attitude.yawRate = last_epoch_ms != 0 && now != last_epoch_ms ? delta * 1000.0f / (now - last_epoch_ms) : 0.0f;
+    last_heading     = attitude.heading;
+    last_epoch_ms    = now;
+
+    uint8_t *buf = udp_acquire_func ? udp_acquire_func(buffer_size) : nullptr;
+    if (buf == nullptr) {
+        buf = buffer;
+    }
+    size_t len = nmea::write(sentence, reinterpret_cast<char *>(buf), buffer_size, pvt, attitude);
+    if (udp_send_func(buf, len) && pvt.gnssFixOK()) {
+        gps_startup::mark_first_fix();
+    }
+}
+
+static uint32_t relposned_rejected = 0;
+
+// Moving base heading, only fixed solutions with a plausible baseline are used
+static void handle_relposned(const ubx::NavRelPosNedView &relpos) {
+    bool valid = relpos.version() == 1 && relpos.gnssFixOK() && relpos.relPosValid() &&
+                 relpos.relPosHeadingValid() && relpos.carrSoln() == 2 &&
+                 relpos.accHeading() * 1e-5f <= DUAL_MAX_HEADING_ACCURACY;
+    if (valid && DUAL_BASELINE_CM > 0) {
+        valid = abs(relpos.relPosLength() - DUAL_BASELINE_CM) <= DUAL_BASELINE_TOLERANCE_CM;
+    }
+    if (!valid) {
+        relposned_rejected++;
+        return;
+    }
+    heading::update_dual(relpos.relPosHeading() * 1e-5f + DUAL_HEADING_OFFSET, millis());
+}
+
+static void handle_frame(const ubx::FrameView &frame) {
+    if (frame.is(ubx::CLASS_NAV, ubx::ID_NAV_RELPOSNED) && frame.length() == ubx::NAV_RELPOSNED_LENGTH) {
+        handle_relposned(ubx::NavRelPosNedView(frame));
+    } else if (frame.is(ubx::CLASS_NAV, ubx::ID_NAV_PVT) && frame.length() == ubx::NAV_PVT_LENGTH) {
+        ubx::NavPvtView pvt(frame);
+        timebase::on_gnss_epoch(pvt.iTOW());
+        if (GPS_OUTPUT_MODE != GPS_OUTPUT_PASSTHROUGH) {
+            send_epoch(pvt);
+        }
+    }
+}
+
+static void parse_ubx() {
+    while (GPSSerial.available()) {
+        if (ubx_parser.feed(GPSSerial.read())) {
+            handle_frame(ubx_parser.frame());
+        }
+    }
+}
 
 void handler() {
+    if (gpsConnected && RTCM_VALIDATE) {
+        // Only as much as the UART TX FIFO takes without blocking the task
+        rtcm::drain(GPSSerial.availableForWrite(), write_serial);
+    }
+    if (GPS_OUTPUT_MODE != GPS_OUTPUT_PASSTHROUGH) {
+        if (gpsConnected && udp_send_func != nullptr) {
+            parse_ubx();
+        }
+        return;
+    }
     // Check if there's data coming from the serial port
-    if (gpsConnected && udp_send_func != nullptr) {
+    if (gpsConnected && udp_send_func != nullptr && GPSSerial.available()) {
+        // Read straight into a transport buffer when available so the bytes are not copied again
+        uint8_t *buf = udp_acquire_func ? udp_acquire_func(buffer_size) : nullptr;
+        if (buf == nullptr) {
+            buf = buffer;
+        }
+        size_t buffer_pos = 0;
         while (GPSSerial.available() && buffer_pos < buffer_size - 1) {
-            char c               = GPSSerial.read();
-            buffer[buffer_pos++] = c;
+            buf[buffer_pos++] = GPSSerial.read();
+        }
+        if (GPS_DUAL_ANTENNA || GPS_PPS_PIN >= 0) {
+            // Pick the heading and epoch times out of the forwarded stream
+            for (size_t i = 0; i < buffer_pos; i++) {
+                if (ubx_parser.feed(buf[i])) {
+                    handle_frame(ubx_parser.frame());
+                }
+            }
         }
-        if (buffer_pos > 0) {
-            udp_send_func(buffer, buffer_pos);
-            buffer_pos = 0; // Reset buffer after sending
+        // Without parsing the first forwarded bytes stand in for the first fix
+        if (udp_send_func(buf, buffer_pos)) {
+            gps_startup::mark_first_fix();
         }
     }
 }
 
 // Initialize GPS communication with UDP sending function and device IP
-void initGpsCommunication(bool (*send_func)(const uint8_t *, size_t), const ip_address &deviceIP) {
+void initGpsCommunication(bool (*send_func)(const uint8_t *, size_t), const ip_address &deviceIP,
+                          uint8_t *(*acquire_func)(size_t)) {
+    udp_acquire_func = acquire_func;
     gps::set_udp_sender(send_func);
 }
 } // namespace gps
@@ -28,8 +28,8 @@ void handler();
 // Forward NMEA from UDP to Serial
 bool forward_udp_to_serial(const uint8_t *data, size_t len);
 
-// Forward correction data from UDP to Serial
-bool forward_correction_to_serial(const uint8_t *data, size_t len);
+// Forward correction data from UDP to Serial, source (IPv4 address) keeps senders' frames apart
+bool forward_correction_to_serial(const uint8_t *data, size_t len, uint32_t source = 0);
 
 // Handle UDP messages received from AgOpenGPS
 void process_udp_message(const uint8_t *data, size_t len, const ip_address &sourceIP);
@@ -37,8 +37,10 @@ void process_udp_message(const uint8_t *data, size_t len, const ip_address &sour
 // Set the UDP sender function for GPS data
 void set_udp_sender(bool (*send_func)(const uint8_t *, size_t));
 
-// Initialize GPS communication with UDP sending function and device IP
-void initGpsCommunication(bool (*send_func)(const uint8_t *, size_t), const ip_address &deviceIP);
+// Initialize GPS communication with UDP sending function and device IP.
+// acquire_func optionally provides transport-owned TX buffers that send_func takes back.
+void initGpsCommunication(bool (*send_func)(const uint8_t *, size_t), const ip_address &deviceIP,
+                          uint8_t *(*acquire_func)(size_t) = nullptr);
 }
 
 #endif // GPS_MODULE_H
@@ -0,0 +1,159 @@
+#include "gps_startup.h"
+
+#include <Preferences.h>
+
+#include "config/defines.h"
+#include "config/pinout.h"
+#include "../utils/log.h"
+
+namespace gps_startup {
+constexpr int test_bauds[] = {460800, 115200, 38400, 230400};
+constexpr uint32_t selected_baud = 460800;
+
+static Timing timing = {};
+
+static uint32_t read_cached_baud() {
+    Preferences prefs;
+    if (!prefs.begin("gps", true)) {
+        return 0;
+    }
+    uint32_t baud = prefs.getUInt("baud", 0);
+    prefs.end();
+    return baud;
+}
+
+static void store_cached_baud(uint32_t baud) {
+    // Only write on change to keep flash wear off the boot path
+    if (read_cached_baud() == baud) {
+        return;
+    }
+    Preferences prefs;
+    if (prefs.begin("gps", false)) {
+        prefs.putUInt("baud", baud);
+        prefs.end();
+    }
+}
+
+static void open_serial(uint32_t baud) {
+    GPSSerial.end();
+    GPSSerial.setRxBufferSize(1024 * 5);
+    GPSSerial.begin(baud, SERIAL_8N1, GPS_RX_PIN, GPS_TX_PIN);
+}
+
+static bool probe(SFE_UBLOX_GNSS &gnss, uint32_t baud) {
+    open_serial(baud);
+    return gnss.begin(GPSSerial, GPS_PROBE_TIMEOUT, false);
+}
+
+static uint32_t detect(SFE_UBLOX_GNSS &gnss) {
+    uint32_t cached = read_cached_baud();
+    if (cached != 0) {
+        LOGD(gps, "Testing cached baud rate: %u", cached);
+        if (probe(gnss, cached)) {
+            return cached;
+        }
+    }
+    for (const int test_baud: test_bauds) {
+        if (static_cast<uint32_t>(test_baud) == cached) {
+            continue;
+        }
+        LOGD(gps, "Testing baud rate: %d", test_baud);
+        if (probe(gnss, test_baud)) {
+            return test_baud;
+        }
+    }
+    return 0;
+}
+
+bool connect(SFE_UBLOX_GNSS &gnss) {
+    uint32_t start = millis();
+    uint32_t baud  = detect(gnss);
+    timing.detect_ms = millis() - start;
+    if (baud == 0) {
+        return false;
+    }
+
+    start = millis();
+    if (baud != selected_baud) {
+        LOGD(gps, "Setting UART1 baud rate to %u", selected_baud);
+        gnss.setSerialRate(selected_baud, COM_PORT_UART1);
+        if (!probe(gnss, selected_baud)) {
+            // Keep working at the detected rate rather than losing the receiver
+            LOGW(gps, "GPS - Baud switch failed, staying at %u", baud);
+            probe(gnss, baud);
+        } else {
+            baud = selected_baud;
+        }
+    }
+    store_cached_baud(baud);
+    timing.baud_ms = millis() - start;
+    return true;
+}
+
+// Passthrough with a receiver configured by the user: only add NAV-PVT to its output, the
+// PPS timebase needs the epoch time of week. The NMEA the user set up is left alone.
+static bool enable_epochs(SFE_UBLOX_GNSS &gnss) {
+    uint32_t start = millis();
+    bool resp      = gnss.newCfgValset(VAL_LAYER_RAM);
+    resp &= gnss.addCfgValset(UBLOX_CFG_UART1OUTPROT_UBX, 1);
+    resp &= gnss.addCfgValset(UBLOX_CFG_MSGOUT_UBX_NAV_PVT_UART1, 1);
+    resp &= gnss.sendCfgValset(GPS_CONFIG_TIMEOUT);
+    timing.configure_ms = millis() - start;
+    timing.ready_ms     = millis();
+    if (resp == false) {
+        LOGE(gps, "GPS - NAV-PVT for the PPS timebase not acknowledged.");
+    }
+    return resp;
+}
+
+bool configure(SFE_UBLOX_GNSS &gnss) {
+    bool parsed = GPS_OUTPUT_MODE != GPS_OUTPUT_PASSTHROUGH;
+    bool epochs = parsed || GPS_PPS_PIN >= 0; // NAV-PVT feeds timebase::on_gnss_epoch
+    if (!parsed && !GPS_DEFAULT_CONFIGURATION && !GPS_DUAL_ANTENNA) {
+        if (epochs) {
+            return enable_epochs(gnss);
+        }
+        // Passthrough with a receiver configured by the user, leave it alone
+        timing.ready_ms = millis();
+        return true;
+    }
+
+    uint32_t start = millis();
+    // RAM layer only, a power cycle restores the user's saved configuration
+    bool resp = gnss.newCfgValset(VAL_LAYER_RAM);
+    resp &= gnss.addCfgValset(UBLOX_CFG_RATE_MEAS, 1000 / GPS_NAV_RATE_HZ);
+    resp &= gnss.addCfgValset(UBLOX_CFG_UART1OUTPROT_UBX, 1);
+    resp &= gnss.addCfgValset(UBLOX_CFG_UART1OUTPROT_NMEA, parsed ? 0 : 1);
+    resp &= gnss.addCfgValset(UBLOX_CFG_UART1INPROT_RTCM3X, 1);
+    resp &= gnss.addCfgValset(UBLOX_CFG_MSGOUT_UBX_NAV_PVT_UART1, epochs ? 1 : 0);
+    resp &= gnss.addCfgValset(UBLOX_CFG_MSGOUT_UBX_NAV_RELPOSNED_UART1, GPS_DUAL_ANTENNA ? 1 : 0);
+    resp &= gnss.addCfgValset(UBLOX_CFG_MSGOUT_NMEA_ID_GGA_UART1, parsed ? 0 : 1);
+    resp &= gnss.addCfgValset(UBLOX_CFG_MSGOUT_NMEA_ID_VTG_UART1, parsed ? 0 : 1);
+    resp &= gnss.addCfgValset(UBLOX_CFG_MSGOUT_NMEA_ID_RMC_UART1, parsed ? 0 : 1);
+    resp &= gnss.addCfgValset(UBLOX_CFG_MSGOUT_NMEA_ID_GSA_UART1, 0);
+    resp &= gnss.addCfgValset(UBLOX_CFG_MSGOUT_NMEA_ID_GSV_UART1, 0);
+    resp &= gnss.addCfgValset(UBLOX_CFG_MSGOUT_NMEA_ID_GLL_UART1, 0);
+    // sendCfgValset waits for the ACK-ACK of the whole transaction
+    resp &= gnss.sendCfgValset(GPS_CONFIG_TIMEOUT);
+    timing.configure_ms = millis() - start;
+    timing.ready_ms     = millis();
+
+    if (resp == false) {
+        LOGE(gps, "GPS - Configuration transaction not acknowledged.");
+    }
+    return resp;
+}
+
+void mark_first_fix() {
+    if (timing.first_fix_ms != 0) {
+        return;
+    }
+    timing.first_fix_ms = millis();
+    LOGD(gps, "GPS startup: detect=%ums baud=%ums config=%ums ready=%ums first fix=%ums",
+           timing.detect_ms, timing.baud_ms, timing.configure_ms, timing.ready_ms, timing.first_fix_ms);
+}
+
+const Timing &get_timing() {
+    return timing;
+}
+} // namespace gps_startup
@@ -0,0 +1,30 @@
+#ifndef GPS_STARTUP_H
+#define GPS_STARTUP_H
+
+#include <Arduino.h>
+#include <SparkFun_u-blox_GNSS_Arduino_Library.h>
+
+// GNSS bring-up: cached baud detection, one batched CFG-VALSET and per-stage timing
+namespace gps_startup {
+
+struct Timing {
+    uint32_t detect_ms;    // Finding the receiver on the UART
+    uint32_t baud_ms;      // Switching to the target baud rate
+    uint32_t configure_ms; // Batched configuration transaction
+    uint32_t ready_ms;     // millis() when bring-up finished
+    uint32_t first_fix_ms; // millis() when the first fix was forwarded, 0 until then
+};
+
+// Detect the receiver, starting with the baud rate cached in NVS, and move it to the target rate
+bool connect(SFE_UBLOX_GNSS &gnss);
+
+// Send the message set and navigation rate in a single VALSET, true when the receiver ACKed it
+bool configure(SFE_UBLOX_GNSS &gnss);
+
+// Record the first forwarded fix and print the stage timing once
+void mark_first_fix();
+
+const Timing &get_timing();
+} // namespace gps_startup
+
+#endif //GPS_STARTUP_H
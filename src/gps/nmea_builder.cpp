@@ -0,0 +1,84 @@
+#include "nmea_builder.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace nmea {
+
+constexpr float MM_PER_S_TO_KNOTS = 0.00194384f;
+
+// Upper bound of each NAV-PVT lastCorrectionAge bucket in seconds, 0 when unavailable
+static const uint8_t correction_age[] = {0, 1, 2, 5, 10, 15, 20, 30, 45, 60, 90, 120, 120};
+
+uint8_t fixQuality(const ubx::NavPvtView &pvt) {
+    if (!pvt.gnssFixOK()) return 0;
+    if (pvt.carrSoln() == 2) return 4;
+    if (pvt.carrSoln() == 1) return 5;
+    if (pvt.diffSoln()) return 2;
+    return 1;
+}
+
+// ddmm.mmmmmmm from degrees * 1e-7, returns the number of characters written
+static int formatCoordinate(char *buf, size_t cap, int32_t value, int degree_digits) {
+    uint32_t magnitude = static_cast<uint32_t>(std::abs(static_cast<int64_t>(value)));
+    uint32_t degrees   = magnitude / 10000000UL;
+    // Minutes with 7 decimals: fraction of a degree * 60
+    uint64_t minutes = static_cast<uint64_t>(magnitude % 10000000UL) * 60;
+    return snprintf(buf, cap, "%0*u%02u.%07u", degree_digits, static_cast<unsigned>(degrees),
+                    static_cast<unsigned>(minutes / 10000000ULL), static_cast<unsigned>(minutes % 10000000ULL));
+}
+
+size_t write(Sentence sentence, char *buf, size_t cap, const ubx::NavPvtView &pvt, const Attitude &attitude) {
+    char lat[20];
+    char lon[20];
+    formatCoordinate(lat, sizeof(lat), pvt.lat(), 2);
+    formatCoordinate(lon, sizeof(lon), pvt.lon(), 3);
+
+    // Hundredths of a second, nano can be negative when the receiver rounds the second up
+    int32_t centis = pvt.nano() / 10000000L;
+    if (centis < 0) centis = 0;
+
+    uint8_t age_index = pvt.lastCorrectionAge();
+    uint8_t age = age_index < sizeof(correction_age) ? correction_age[age_index] : 0;
+
+    const char *header = sentence == Sentence::panda ? "PANDA" : "PAOGI";
+    int len = snprintf(buf, cap,
+                       "$%s,%02u%02u%02u.%02d,%s,%c,%s,%c,%u,%u,%.1f,%.3f,%u,%.3f,",
+                       header, pvt.hour(), pvt.min(), pvt.sec(), static_cast<int>(centis),
+                       lat, pvt.lat() < 0 ? 'S' : 'N', lon, pvt.lon() < 0 ? 'W' : 'E',
+                       fixQuality(pvt), pvt.numSV(),
+                       pvt.pDOP() * 0.01f, // NAV-PVT only carries position DOP, AgIO displays it as HDOP
+                       pvt.hMSL() * 0.001f, age, pvt.gSpeed() * MM_PER_S_TO_KNOTS);
+    if (len < 0 || static_cast<size_t>(len) >= cap) {
+        return 0;
+    }
+
+    int tail;
+    if (sentence == Sentence::panda) {
+        // PANDA carries the IMU values in tenths of a degree
+        tail = snprintf(buf + len, cap - len, "%d,%d,%d,%d",
+                        static_cast<int>(lroundf(attitude.heading * 10.0f)),
+                        static_cast<int>(lroundf(attitude.roll * 10.0f)),
+                        static_cast<int>(lroundf(attitude.pitch * 10.0f)),
+                        static_cast<int>(lroundf(attitude.yawRate)));
+    } else {
+        tail = snprintf(buf + len, cap - len, "%.2f,%.2f,%.2f,%.2f",
+                        attitude.heading, attitude.roll, attitude.pitch, attitude.yawRate);
+    }
+    if (tail < 0 || static_cast<size_t>(len + tail) >= cap) {
+        return 0;
+    }
+    len += tail;
+
+    uint8_t checksum = 0;
+    for (int i = 1; i < len; i++) {
+        checksum ^= static_cast<uint8_t>(buf[i]);
+    }
+    tail = snprintf(buf + len, cap - len, "*%02X\r\n", checksum);
+    if (tail < 0 || static_cast<size_t>(len + tail) >= cap) {
+        return 0;
+    }
+    return len + tail;
+}
+} // namespace nmea
@@ -0,0 +1,31 @@
+#ifndef NMEA_BUILDER_H
+#define NMEA_BUILDER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "ubx_parser.h"
+
+// AgOpenGPS combined sentences built from one NAV-PVT epoch and the IMU sample taken with it
+namespace nmea {
+
+struct Attitude {
+    float heading; // degrees, IMU heading for PANDA, antenna heading for PAOGI
+    float roll;    // degrees
+    float pitch;   // degrees
+    float yawRate; // degrees/s
+};
+
+enum class Sentence : uint8_t {
+    panda, // Single antenna with IMU heading and roll
+    paogi  // Dual antenna heading
+};
+
+// AgOpenGPS fix quality: 0 none, 1 GPS, 2 DGPS, 4 RTK fixed, 5 RTK float
+uint8_t fixQuality(const ubx::NavPvtView &pvt);
+
+// Write the sentence including checksum and CRLF, returns its length or 0 if cap is too small
+size_t write(Sentence sentence, char *buf, size_t cap, const ubx::NavPvtView &pvt, const Attitude &attitude);
+} // namespace nmea
+
+#endif //NMEA_BUILDER_H
@@ -0,0 +1,266 @@
+#include "rtcm.h"
+
+#include <atomic>
+#include <cstring>
+
+#include "config/defines.h"
+#include "../utils/log.h"
+
+namespace rtcm {
+
+// CRC-24Q, polynomial 0x1864CFB
+struct CrcTable {
+    uint32_t value[256];
+    constexpr CrcTable() : value() {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i << 16;
+            for (int bit = 0; bit < 8; bit++) {
+                crc <<= 1;
+                if (crc & 0x1000000) crc ^= 0x1864CFB;
+            }
+            value[i] = crc & 0xFFFFFF;
+        }
+    }
+};
+static constexpr CrcTable crc_table;
+
+uint32_t crc24q(const uint8_t *data, size_t len) {
+    uint32_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc = ((crc << 8) ^ crc_table.value[((crc >> 16) ^ data[i]) & 0xFF]) & 0xFFFFFF;
+    }
+    return crc;
+}
+
+static Stats stats = {};
+
+// Frame reassembly per source address, only touched by the UDP receive callback
+struct Parser {
+    uint32_t source;
+    uint32_t last_ms; // 0 marks a free parser
+    uint8_t frame[MAX_FRAME];
+    size_t pos;
+    size_t len;
+};
+static Parser parsers[RTCM_SOURCES] = {};
+
+// Recently queued frames, identified by their CRC and length, and where they came from
+struct RecentFrame {
+    uint32_t crc;
+    uint16_t length;
+    uint32_t source;
+    uint32_t time_ms;
+};
+static RecentFrame recent[RTCM_DEDUP_SLOTS] = {};
+static size_t recent_next = 0;
+
+// Single producer (UDP callback), single consumer (GNSS task) byte ring
+static_assert((RTCM_RING_SIZE & (RTCM_RING_SIZE - 1)) == 0, "RTCM ring size must be a power of two");
+static_assert(RTCM_RING_SIZE >= MAX_FRAME, "RTCM ring must hold a full frame");
+static uint8_t ring[RTCM_RING_SIZE];
+static std::atomic<size_t> ring_head{0}; // Next write position, advanced by the producer
+static std::atomic<size_t> ring_tail{0}; // Next read position, advanced by the consumer
+
+size_t queued() {
+    return ring_head.load(std::memory_order_acquire) - ring_tail.load(std::memory_order_acquire);
+}
+
+static bool push(const uint8_t *data, size_t len) {
+    size_t head = ring_head.load(std::memory_order_relaxed);
+    size_t tail = ring_tail.load(std::memory_order_acquire);
+    if (RTCM_RING_SIZE - (head - tail) < len) {
+        return false;
+    }
+    size_t offset = head % RTCM_RING_SIZE;
+    size_t first  = len < RTCM_RING_SIZE - offset ? len : RTCM_RING_SIZE - offset;
+    memcpy(ring + offset, data, first);
+    memcpy(ring, data + first, len - first);
+    ring_head.store(head + len, std::memory_order_release);
+
+    size_t fill = head + len - tail;
+    if (fill > stats.queue_peak) stats.queue_peak = fill;
+    return true;
+}
+
+static bool is_duplicate(uint32_t crc, uint16_t length, uint32_t source, uint32_t now_ms) {
+    for (const auto &entry: recent) {
+        if (entry.time_ms != 0 && entry.crc == crc && entry.length == length && entry.source != source &&
+            now_ms - entry.time_ms < RTCM_DEDUP_WINDOW) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void remember(uint32_t crc, uint16_t length, uint32_t source, uint32_t now_ms) {
+    recent[recent_next] = {crc, length, source, now_ms == 0 ? 1 : now_ms}; // 0 marks an empty slot
+    recent_next         = (recent_next + 1) % RTCM_DEDUP_SLOTS;
+}
+
+static void count_type(uint16_t type) {
+    for (auto &slot: stats.types) {
+        if (slot.type == type || slot.count == 0) {
+            slot.type = type;
+            slot.count++;
+            return;
+        }
+    }
+}
+
+// Returns false when the candidate is not an intact frame, the caller resyncs inside it
+static bool accept_frame(const Parser &parser, uint32_t now_ms) {
+    const uint8_t *frame = parser.frame;
+    size_t frame_len     = parser.len;
+    size_t payload_len   = frame_len - HEADER_LENGTH - CRC_LENGTH;
+    uint32_t crc       = crc24q(frame, frame_len - CRC_LENGTH);
+    uint32_t expected  = (static_cast<uint32_t>(frame[frame_len - 3]) << 16) |
+                        (static_cast<uint32_t>(frame[frame_len - 2]) << 8) | frame[frame_len - 1];
+    if (crc != expected) {
+        stats.bad_crc++;
+        return false;
+    }
+    if (is_duplicate(crc, static_cast<uint16_t>(payload_len), parser.source, now_ms)) {
+        stats.duplicates++;
+        return true;
+    }
+    if (!push(frame, frame_len)) {
+        stats.overflow++;
+        return true;
+    }
+    remember(crc, static_cast<uint16_t>(payload_len), parser.source, now_ms);
+    if (payload_len >= 2) {
+        count_type(static_cast<uint16_t>((frame[3] << 4) | (frame[4] >> 4)));
+    }
+    stats.frames++;
+    stats.bytes += frame_len;
+    stats.last_frame_ms = now_ms;
+    return true;
+}
+
+// Drops the head of a rejected candidate up to the next preamble inside it. A lost or damaged
+// datagram then only costs the frame it hit, not the one that starts in the bytes after it.
+static void skip_to_preamble(Parser &parser) {
+    const void *next = memchr(parser.frame + 1, PREAMBLE, parser.pos - 1);
+    size_t skip      = next ? static_cast<const uint8_t *>(next) - parser.frame : parser.pos;
+    memmove(parser.frame, parser.frame + skip, parser.pos - skip);
+    parser.pos -= skip;
+}
+
+// Checks the candidate after bytes were added or skipped. Leaves it empty or as the start of a
+// plausible frame, accepting every whole frame found on the way.
+static void settle(Parser &parser, uint32_t now_ms) {
+    while (parser.pos > 0) {
+        if (parser.pos >= 2 && (parser.frame[1] & 0xFC) != 0) {
+            // Six reserved bits must be zero
+            stats.bad_length++;
+            skip_to_preamble(parser);
+            continue;
+        }
+        if (parser.pos < HEADER_LENGTH) {
+            return;
+        }
+        parser.len = HEADER_LENGTH + (((parser.frame[1] & 0x03) << 8) | parser.frame[2]) + CRC_LENGTH;
+        if (parser.pos < parser.len) {
+            return;
+        }
+        if (!accept_frame(parser, now_ms)) {
+            skip_to_preamble(parser);
+            continue;
+        }
+        parser.pos -= parser.len;
+        memmove(parser.frame, parser.frame + parser.len, parser.pos);
+        if (parser.pos > 0 && parser.frame[0] != PREAMBLE) {
+            stats.garbage++;
+            skip_to_preamble(parser);
+        }
+    }
+}
+
+
+
+// Parser of source, or the free or least recently used one taken over for it
+static Parser &parser_for(uint32_t source, uint32_t now_ms) {
+    Parser *oldest = &parsers[0];
+    for (auto &parser: parsers) {
+        if (parser.last_ms != 0 && parser.source == source) {
+            return parser;
+        }
+        if (parser.last_ms == 0 || (oldest->last_ms != 0 && now_ms - parser.last_ms > now_ms - oldest->last_ms)) {
+            oldest = &parser;
+        }
+    }
+    if (oldest->last_ms != 0 && oldest->pos != 0) {
+        stats.source_evictions++;
+    }
+    oldest->source = source;
+    oldest->pos    = 0;
+    return *oldest;
+}
+
+void ingest(const uint8_t *data, size_t len, uint32_t source, uint32_t now_ms) {
+    Parser &parser = parser_for(source, now_ms);
+    if (parser.pos != 0 && now_ms - parser.last_ms > RTCM_FRAME_TIMEOUT) {
+        // The rest of this frame is not coming, never join it onto newer bytes
+        stats.stale_partials++;
+        parser.pos = 0;
+    }
+    parser.last_ms = now_ms == 0 ? 1 : now_ms; // 0 marks a free parser
+    for (size_t i = 0; i < len; i++) {
+        uint8_t byte = data[i];
+        if (parser.pos == 0 && byte != PREAMBLE) {
+            stats.garbage++;
+            continue;
+        }
+        parser.frame[parser.pos++] = byte;
+        settle(parser, now_ms);
+    }
+}
+
+size_t drain(size_t budget, size_t (*write)(const uint8_t *, size_t)) {
+    size_t tail    = ring_tail.load(std::memory_order_relaxed);
+    size_t pending = ring_head.load(std::memory_order_acquire) - tail;
+    if (pending == 0) {
+        return 0;
+    }
+    if (budget < pending) {
+        // UART TX FIFO is backing up
+        stats.uart_stalls++;
+    }
+    size_t len = pending < budget ? pending : budget;
+
+    // At most two contiguous chunks around the wrap
+    size_t offset  = tail % RTCM_RING_SIZE;
+    size_t first   = len < RTCM_RING_SIZE - offset ? len : RTCM_RING_SIZE - offset;
+    size_t written = write(ring + offset, first);
+    if (written == first && len > first) {
+        written += write(ring, len - first);
+    }
+    ring_tail.store(tail + written, std::memory_order_release);
+    return written;
+}
+
+const Stats &get_stats() {
+    return stats;
+}
+
+void print_stats() {
+    static uint32_t last_print = 0;
+    static uint32_t last_bytes = 0;
+    uint32_t now      = millis();
+    uint32_t interval = now - last_print;
+    float rate        = interval > 0 ? (stats.bytes - last_bytes) * 1000.0f / interval : 0.0f;
+    last_print        = now;
+    last_bytes        = stats.bytes;
+
+    LOGD(gps, "RTCM: frames=%u rate=%.0fB/s age=%ums crc=%u length=%u dup=%u overflow=%u garbage=%u stalls=%u "
+              "evictions=%u stale=%u peak=%u",
+           stats.frames, rate, stats.last_frame_ms ? now - stats.last_frame_ms : 0, stats.bad_crc,
+           stats.bad_length, stats.duplicates, stats.overflow, stats.garbage, stats.uart_stalls,
+           stats.source_evictions, stats.stale_partials, static_cast<unsigned>(stats.queue_peak));
+    for (const auto &slot: stats.types) {
+        if (slot.count != 0) {
+            LOGD(gps, "RTCM %u: %u", slot.type, slot.count);
+        }
+    }
+}
+} // namespace rtcm
@@ -0,0 +1,55 @@
+#ifndef RTCM_H
+#define RTCM_H
+
+#include <cstddef>
+#include <cstdint>
+
+// RTCM3 correction ingest. Datagrams are split into frames per source address, checked for
+// preamble, length and CRC-24Q, de-duplicated across sources and queued whole for the GNSS task
+// to write to the UART. A frame is only a duplicate of an identical frame from another source
+// within RTCM_DEDUP_WINDOW; repeats from the same source (static station messages every epoch)
+// always pass. A frame that fails its checks is rescanned for the next preamble, and a partial
+// frame older than RTCM_FRAME_TIMEOUT is dropped rather than joined onto the next datagram.
+namespace rtcm {
+constexpr uint8_t PREAMBLE         = 0xD3;
+constexpr size_t HEADER_LENGTH     = 3;
+constexpr size_t CRC_LENGTH        = 3;
+constexpr size_t MAX_PAYLOAD       = 1023;
+constexpr size_t MAX_FRAME         = HEADER_LENGTH + MAX_PAYLOAD + CRC_LENGTH;
+constexpr size_t MESSAGE_TYPE_SLOTS = 16;
+
+struct MessageCount {
+    uint16_t type;
+    uint32_t count;
+};
+
+struct Stats {
+    uint32_t frames;        // Valid frames queued
+    uint32_t bytes;         // Bytes of valid frames queued
+    uint32_t bad_crc;
+    uint32_t bad_length;    // Reserved bits set in the length field
+    uint32_t duplicates;    // Same frame already queued from another source
+    uint32_t overflow;      // Frames dropped because the ring was full
+    uint32_t garbage;       // Bytes outside any frame
+    uint32_t source_evictions; // Partial frames lost to a sender beyond RTCM_SOURCES
+    uint32_t stale_partials; // Partial frames dropped after RTCM_FRAME_TIMEOUT without more data
+    uint32_t uart_stalls;   // Drain calls that could not empty the ring
+    uint32_t last_frame_ms; // Arrival of the newest valid frame
+    size_t queue_peak;      // Highest ring fill in bytes
+    MessageCount types[MESSAGE_TYPE_SLOTS];
+};
+
+uint32_t crc24q(const uint8_t *data, size_t len);
+
+// Called from the UDP receive callback, a frame may span several datagrams of the same source
+void ingest(const uint8_t *data, size_t len, uint32_t source, uint32_t now_ms);
+
+// Called from the GNSS task, writes at most budget queued bytes and returns how many were written
+size_t drain(size_t budget, size_t (*write)(const uint8_t *, size_t));
+
+size_t queued();
+const Stats &get_stats();
+void print_stats();
+} // namespace rtcm
+
+#endif //RTCM_H
@@ -0,0 +1,70 @@
+#include "ubx_parser.h"
+
+namespace ubx {
+
+bool Parser::feed(uint8_t byte) {
+    switch (state_) {
+        case State::sync1:
+            if (byte == SYNC_1) state_ = State::sync2;
+            return false;
+
+        case State::sync2:
+            state_ = byte == SYNC_2 ? State::cls : byte == SYNC_1 ? State::sync2 : State::sync1;
+            return false;
+
+        case State::cls:
+            ck_a_ = 0;
+            ck_b_ = 0;
+            checksum(byte);
+            cls_   = byte;
+            state_ = State::id;
+            return false;
+
+        case State::id:
+            checksum(byte);
+            id_    = byte;
+            state_ = State::len1;
+            return false;
+
+        case State::len1:
+            checksum(byte);
+            length_ = byte;
+            state_  = State::len2;
+            return false;
+
+        case State::len2:
+            checksum(byte);
+            length_ |= static_cast<uint16_t>(byte) << 8;
+            pos_  = 0;
+            skip_ = length_ > MAX_PAYLOAD;
+            if (skip_) oversize_++;
+            state_ = length_ == 0 ? State::ck_a : State::payload;
+            return false;
+
+        case State::payload:
+            checksum(byte);
+            if (!skip_) payload_[pos_] = byte;
+            if (++pos_ >= length_) state_ = State::ck_a;
+            return false;
+
+        case State::ck_a:
+            rx_ck_a_ = byte;
+            state_   = State::ck_b;
+            return false;
+
+        case State::ck_b:
+            state_ = State::sync1;
+            if (rx_ck_a_ != ck_a_ || byte != ck_b_) {
+                checksum_errors_++;
+                return false;
+            }
+            if (skip_) {
+                return false;
+            }
+            frames_++;
+            return true;
+    }
+    return false;
+}
+
+} // namespace ubx
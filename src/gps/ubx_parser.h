@@ -0,0 +1,131 @@
+#ifndef UBX_PARSER_H
+#define UBX_PARSER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace ubx {
+constexpr uint8_t SYNC_1 = 0xB5;
+constexpr uint8_t SYNC_2 = 0x62;
+
+constexpr uint8_t CLASS_NAV      = 0x01;
+constexpr uint8_t ID_NAV_PVT     = 0x07;
+constexpr size_t NAV_PVT_LENGTH  = 92;
+constexpr uint8_t ID_NAV_RELPOSNED     = 0x3C;
+constexpr size_t NAV_RELPOSNED_LENGTH  = 64; // Version 1, F9 receivers
+
+// Largest payload kept; longer frames are skipped without buffering
+constexpr size_t MAX_PAYLOAD = 100;
+
+// Read-only view over a checked frame payload, fields are little-endian and may be unaligned
+class FrameView {
+public:
+    FrameView(uint8_t cls, uint8_t id, const uint8_t *payload, size_t len)
+        : cls_(cls), id_(id), payload_(payload), len_(len) {}
+
+    uint8_t cls() const { return cls_; }
+    uint8_t id() const { return id_; }
+    size_t length() const { return len_; }
+    bool is(uint8_t cls, uint8_t id) const { return cls_ == cls && id_ == id; }
+
+    uint8_t u8(size_t offset) const { return payload_[offset]; }
+    int8_t i8(size_t offset) const { return static_cast<int8_t>(payload_[offset]); }
+    uint16_t u16(size_t offset) const {
+        return static_cast<uint16_t>(payload_[offset] | (payload_[offset + 1] << 8));
+    }
+    int16_t i16(size_t offset) const { return static_cast<int16_t>(u16(offset)); }
+    uint32_t u32(size_t offset) const {
+        return static_cast<uint32_t>(u16(offset)) | (static_cast<uint32_t>(u16(offset + 2)) << 16);
+    }
+    int32_t i32(size_t offset) const { return static_cast<int32_t>(u32(offset)); }
+
+private:
+    uint8_t cls_;
+    uint8_t id_;
+    const uint8_t *payload_;
+    size_t len_;
+};
+
+// UBX-NAV-PVT, offsets from the u-blox interface description
+struct NavPvtView : FrameView {
+    explicit NavPvtView(const FrameView &frame) : FrameView(frame) {}
+    uint32_t iTOW() const { return u32(0); }       // ms
+    uint16_t year() const { return u16(4); }
+    uint8_t month() const { return u8(6); }
+    uint8_t day() const { return u8(7); }
+    uint8_t hour() const { return u8(8); }
+    uint8_t min() const { return u8(9); }
+    uint8_t sec() const { return u8(10); }
+    uint8_t valid() const { return u8(11); }
+    int32_t nano() const { return i32(16); }        // ns
+    uint8_t fixType() const { return u8(20); }
+    uint8_t flags() const { return u8(21); }
+    bool gnssFixOK() const { return flags() & 0x01; }
+    bool diffSoln() const { return flags() & 0x02; }
+    uint8_t carrSoln() const { return flags() >> 6; } // 0 none, 1 float, 2 fixed
+    uint8_t numSV() const { return u8(23); }
+    int32_t lon() const { return i32(24); }         // deg * 1e-7
+    int32_t lat() const { return i32(28); }         // deg * 1e-7
+    int32_t hMSL() const { return i32(36); }        // mm
+    int32_t gSpeed() const { return i32(60); }      // mm/s
+    int32_t headMot() const { return i32(64); }     // deg * 1e-5
+    uint16_t pDOP() const { return u16(76); }       // * 0.01
+    uint8_t lastCorrectionAge() const { return (u8(78) >> 1) & 0x0F; }
+};
+
+// UBX-NAV-RELPOSNED version 1, vector from the moving base to the rover antenna
+struct NavRelPosNedView : FrameView {
+    explicit NavRelPosNedView(const FrameView &frame) : FrameView(frame) {}
+    uint8_t version() const { return u8(0); }
+    uint32_t iTOW() const { return u32(4); }          // ms
+    int32_t relPosN() const { return i32(8); }        // cm
+    int32_t relPosE() const { return i32(12); }       // cm
+    int32_t relPosD() const { return i32(16); }       // cm
+    int32_t relPosLength() const { return i32(20); }  // cm
+    int32_t relPosHeading() const { return i32(24); } // deg * 1e-5
+    uint32_t accHeading() const { return u32(52); }   // deg * 1e-5
+    uint32_t flags() const { return u32(60); }
+    bool gnssFixOK() const { return flags() & 0x001; }
+    bool relPosValid() const { return flags() & 0x004; }
+    uint8_t carrSoln() const { return (flags() >> 3) & 0x03; } // 0 none, 1 float, 2 fixed
+    bool relPosHeadingValid() const { return flags() & 0x100; }
+};
+
+// Byte-wise UBX frame parser. feed() returns true when a frame with a valid checksum is complete;
+// frame() then views the payload in place until the next byte is fed.
+class Parser {
+public:
+    bool feed(uint8_t byte);
+    FrameView frame() const { return FrameView(cls_, id_, payload_, length_); }
+
+    uint32_t frames() const { return frames_; }
+    uint32_t checksum_errors() const { return checksum_errors_; }
+    uint32_t oversize() const { return oversize_; }
+
+private:
+    enum class State : uint8_t { sync1, sync2, cls, id, len1, len2, payload, ck_a, ck_b };
+
+    void checksum(uint8_t byte) {
+        ck_a_ += byte;
+        ck_b_ += ck_a_;
+    }
+
+    State state_ = State::sync1;
+    uint8_t cls_ = 0;
+    uint8_t id_  = 0;
+    uint16_t length_ = 0;
+    uint16_t pos_    = 0;
+    uint8_t ck_a_ = 0;
+    uint8_t ck_b_ = 0;
+    uint8_t rx_ck_a_ = 0;
+    bool skip_       = false; // Payload longer than MAX_PAYLOAD, checked but not stored
+    uint8_t payload_[MAX_PAYLOAD];
+
+    uint32_t frames_          = 0;
+    uint32_t checksum_errors_ = 0;
+    uint32_t oversize_        = 0;
+};
+} // namespace ubx
+
+#endif //UBX_PARSER_H
@@ -8,6 +8,7 @@
 #include "gps/gps_module.h"
 #include "settings/settings_hw.h"
 #include "utils/log.h"
+#include "utils/timebase.h"
 
 namespace hw{
 
@@ -18,6 +19,7 @@ bool init(){
     BNO08XIMU::init(); // Init BNO first since they use the same i2c.
     ADS1115WAS::init();
     PWMMotor::init();
+    timebase::init();
     gps::init();
     debug("Hardware initialization done!");
     return true;
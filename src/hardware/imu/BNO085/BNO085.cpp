@@ -1,5 +1,6 @@
 #include "BNO085.h"
 #include "utils/log.h"
+#include "utils/metrics.h"
 #include "hardware/i2c_manager.h"
 
 BNO085 bno08x;
@@ -10,15 +11,15 @@ BNO085::BNO085() : _dataReady(false) {
 bool BNO085::begin(TwoWire *wirePort) {
     // Initialize the BNO085 sensor
     if (!_bno.begin_I2C(BNO085_I2C_ADDR, wirePort)) {
-        error("Failed to find BNO08x sensor");
+        LOGE(imu, "Failed to find BNO08x sensor");
         return false;
     }
     
-    debug("BNO08x sensor found");
+    LOGD(imu, "BNO08x sensor found");
     
     // Display sensor information
     for (int n = 0; n < _bno.prodIds.numEntries; n++) {
-        debugf("Part %d: Version %d.%d.%d Build %d",
+        LOGD(imu, "Part %d: Version %d.%d.%d Build %d",
             _bno.prodIds.entry[n].swPartNumber,
             _bno.prodIds.entry[n].swVersionMajor,
             _bno.prodIds.entry[n].swVersionMinor,
@@ -28,7 +29,7 @@ bool BNO085::begin(TwoWire *wirePort) {
     
     // Set up the sensor reports
     if (!setReports()) {
-        error("Failed to set BNO08x reports");
+        LOGE(imu, "Failed to set BNO08x reports");
         return false;
     }
     
@@ -38,7 +39,7 @@ bool BNO085::begin(TwoWire *wirePort) {
 bool BNO085::setReports() {
     // Enable rotation vector reports - this is the one we want for heading/roll/pitch
     if (!_bno.enableReport(SH2_ROTATION_VECTOR)) {
-        error("Could not enable rotation vector report");
+        LOGE(imu, "Could not enable rotation vector report");
         return false;
     }
     
@@ -95,7 +96,8 @@ void BNO085::update() {
     _dataReady = _bno.getSensorEvent(&_sensorValue);
     
     if (_bno.wasReset()) {
-        debug("BNO08x was reset, re-configuring reports");
+        metrics::inc(metrics::Counter::imu_resets);
+        LOGD(imu, "BNO08x was reset, re-configuring reports");
         setReports();
     }
 }
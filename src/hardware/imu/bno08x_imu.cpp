@@ -4,6 +4,7 @@
 #include "../../config/defines.h"
 #include "../../hardware/i2c_manager.h"
 #include "../../utils/log.h"
+#include "../../utils/timebase.h"
 
 namespace hw {
 
@@ -11,10 +12,11 @@ BNO085 BNO08XIMU::bno08x;
 float BNO08XIMU::heading = 0.0f;
 float BNO08XIMU::roll = 0.0f;
 float BNO08XIMU::pitch = 0.0f;
+int64_t BNO08XIMU::sample_time = 0;
 bool initialized = false;
 
 bool BNO08XIMU::init() {
-    debug("Initializing BNO08X IMU");
+    LOGD(imu, "Initializing BNO08X IMU");
     I2C_MUTEX_LOCK();
     Wire.end();
     Wire.setPins(I2C_SDA_PIN, I2C_SCL_PIN);
@@ -27,25 +29,27 @@ bool BNO08XIMU::init() {
     
     for (int i = 0; i < maxRetries; i++) {
         if (bno08x.begin()) {
-            debug("BNO08X initialized successfully");
+            LOGD(imu, "BNO08X initialized successfully");
             I2C_MUTEX_UNLOCK();
             initialized = true;
 
             imu::IMUInterface interface;
             interface.heading = getHeading;
             interface.roll = getRoll;
+            interface.pitch = getPitch;
+            interface.timestamp = getTimestamp;
             imu::init(interface);
             return true;
         }
         
-        warningf("Failed to initialize BNO08X (attempt %d/%d)", i + 1, maxRetries);
+        LOGW(imu, "Failed to initialize BNO08X (attempt %d/%d)", i + 1, maxRetries);
         if (i < maxRetries - 1) {
-            debugf("Retrying in %d ms...", retryDelayMs);
+            LOGD(imu, "Retrying in %d ms...", retryDelayMs);
             delay(retryDelayMs);
         }
     }
     
-    errorf("BNO08X initialization failed after %d attempts", maxRetries);
+    LOGE(imu, "BNO08X initialization failed after %d attempts", maxRetries);
     I2C_MUTEX_UNLOCK();
     return false;
 }
@@ -58,6 +62,7 @@ void BNO08XIMU::handler(){
     heading = bno08x.getHeading();
     roll = bno08x.getRoll();
     pitch = bno08x.getPitch();
+    sample_time = timebase::now_gnss();
     bno08x.update();
     I2C_MUTEX_UNLOCK();
 }
@@ -70,4 +75,12 @@ float BNO08XIMU::getRoll(){
     return roll;
 }
 
+float BNO08XIMU::getPitch(){
+    return pitch;
+}
+
+int64_t BNO08XIMU::getTimestamp(){
+    return sample_time;
+}
+
 } // namespace hw
\ No newline at end of file
@@ -15,10 +15,13 @@ public:
 private:
     static float getHeading();
     static float getRoll();
+    static float getPitch();
+    static int64_t getTimestamp();
     static BNO085 bno08x;
     static float heading;
     static float roll;
     static float pitch;
+    static int64_t sample_time;
 };
 
 } // namespace hw
@@ -1,24 +1,38 @@
 #include "settings_hw.h"
 #include "autosteer/settings.h"
 #include "utils/log.h"
+#include "utils/metrics.h"
 #include <EEPROM.h>
 
 namespace hw {
 
 bool Settings::initialized = false;
 
+static bool commit() {
+    metrics::inc(metrics::Counter::eeprom_commits);
+    bool ok = EEPROM.commit();
+    if (!ok) {
+        metrics::inc(metrics::Counter::eeprom_commit_failures);
+    }
+    return ok;
+}
+
 const uint8_t magic_start = 0xAB;
 const int settings_address = 0x01;
 const int config_address = sizeof(SteerSettings) + settings_address;
-constexpr int eeprom_size = sizeof(SteerSettings) + sizeof(SteerConfig) + 1;
-static_assert(eeprom_size >= (1 + sizeof(SteerSettings) + sizeof(SteerConfig)), "EEPROM size is too small for settings and config");
+// The gain schedule was added later and carries its own magic byte so existing boards keep their settings
+const uint8_t magic_schedule = 0xAC;
+const int schedule_magic_address = config_address + sizeof(SteerConfig);
+const int schedule_address = schedule_magic_address + 1;
+constexpr int eeprom_size = sizeof(SteerSettings) + sizeof(SteerConfig) + sizeof(GainSchedule) + 2;
+static_assert(eeprom_size >= (2 + sizeof(SteerSettings) + sizeof(SteerConfig) + sizeof(GainSchedule)), "EEPROM size is too small for settings, config and gain schedule");
 
 SteerSettings Settings::readSteerSettings() {
     if (!initialized) return SteerSettings();
     SteerSettings settings;
     auto count = EEPROM.readBytes(settings_address, (uint8_t *)&settings, sizeof(SteerSettings));
     if (count != sizeof(SteerSettings)) {
-        error("EEPROM read failed");
+        LOGE(settings, "EEPROM read failed");
         return SteerSettings();
     }
     return settings;
@@ -29,26 +43,47 @@ SteerConfig Settings::readSteerConfig() {
     SteerConfig config;
     auto count = EEPROM.readBytes(config_address, (uint8_t *)&config, sizeof(SteerConfig));
     if (count != sizeof(SteerConfig)) {
-        error("EEPROM read failed");
+        LOGE(settings, "EEPROM read failed");
         return SteerConfig();
     }
     return config;
 }
 
+GainSchedule Settings::readGainSchedule() {
+    if (!initialized) return GainSchedule();
+    if (EEPROM.read(schedule_magic_address) != magic_schedule) {
+        return GainSchedule();
+    }
+    GainSchedule schedule;
+    auto count = EEPROM.readBytes(schedule_address, (uint8_t *)&schedule, sizeof(GainSchedule));
+    if (count != sizeof(GainSchedule) || schedule.count > GAIN_SCHEDULE_MAX_POINTS) {
+        LOGE(settings, "EEPROM gain schedule invalid");
+        return GainSchedule();
+    }
+    return schedule;
+}
+
  void Settings::writeSteerSettings(const SteerSettings settings) {
     if (!initialized) return;
     EEPROM.put(settings_address, settings);
-    bool resp = EEPROM.commit();
-    if (!resp) {
-        error("EEPROM commit failed");
+    if (!commit()) {
+        LOGE(settings, "EEPROM commit failed");
     }
 }
 void Settings::writeSteerConfig(const SteerConfig config) {
     if (!initialized) return;
     EEPROM.put(config_address, config);
-    bool resp = EEPROM.commit();
-    if (!resp) {
-        error("EEPROM commit failed");
+    if (!commit()) {
+        LOGE(settings, "EEPROM commit failed");
+    }
+}
+
+void Settings::writeGainSchedule(const GainSchedule &schedule) {
+    if (!initialized) return;
+    EEPROM.write(schedule_magic_address, magic_schedule);
+    EEPROM.put(schedule_address, schedule);
+    if (!commit()) {
+        LOGE(settings, "EEPROM commit failed");
     }
 }
 
@@ -58,19 +93,19 @@ bool Settings::init() {
     // Initialize EEPROM
     bool resp = EEPROM.begin(eeprom_size);
     if (!resp) {
-        error("EEPROM initialization failed");
+        LOGE(settings, "EEPROM initialization failed");
         return false;
     }
 
     // read first byte to check if EEPROM is empty
     uint8_t magic = EEPROM.read(0);
     if (magic != magic_start) {
-        warning("EEPROM is empty, writing default settings");
+        LOGW(settings, "EEPROM is empty, writing default settings");
         // EEPROM is empty, write default settings
         EEPROM.write(0, magic_start);
         writeSteerSettings(SteerSettings());
         writeSteerConfig(SteerConfig());
-        EEPROM.commit();
+        commit();
     }
 
     // Initialize the settings interface
@@ -79,10 +114,12 @@ bool Settings::init() {
     interface.write_settings = writeSteerSettings;
     interface.read_config = readSteerConfig;
     interface.write_config = writeSteerConfig;
+    interface.read_schedule = readGainSchedule;
+    interface.write_schedule = writeGainSchedule;
     initialized = true;
     settings::init(interface);
 
-    debugf("Settings initialized");
+    LOGD(settings, "Settings initialized");
     return true;
 }
 
@@ -14,6 +14,8 @@ public:
         static SteerConfig readSteerConfig();
         static void writeSteerSettings(SteerSettings settings);
         static void writeSteerConfig(SteerConfig config);
+        static GainSchedule readGainSchedule();
+        static void writeGainSchedule(const GainSchedule &schedule);
         static bool init();
 private:
     static bool initialized;
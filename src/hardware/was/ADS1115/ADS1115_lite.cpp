@@ -8,6 +8,7 @@
 
 #include "ADS1115_lite.h"
 #include "Arduino.h"
+#include "utils/metrics.h"
 
 
 
@@ -42,7 +43,9 @@ void ADS1115_lite::startConversion() const {
   Wire.write(ADS1115_REG_CONFIG);
   Wire.write((uint8_t)(config >> 8));
   Wire.write((uint8_t)(config & 0xFF));
-  Wire.endTransmission();
+  if (Wire.endTransmission() != 0) {
+    metrics::inc(metrics::Counter::i2c_errors);
+  }
 }
 
 bool ADS1115_lite::conversionReady() const {
@@ -56,7 +59,10 @@ bool ADS1115_lite::conversionReady() const {
 int16_t ADS1115_lite::readConversion() const {
   Wire.beginTransmission(_i2cAddress);
   Wire.write(ADS1115_REG_CONVERSION);
-  Wire.endTransmission();
-  Wire.requestFrom(_i2cAddress, (uint8_t)2);
+  bool ok = Wire.endTransmission() == 0;
+  ok &= Wire.requestFrom(_i2cAddress, (uint8_t)2) == 2;
+  if (!ok) {
+    metrics::inc(metrics::Counter::i2c_errors);
+  }
   return (Wire.read() << 8) | Wire.read();
 }
\ No newline at end of file
@@ -3,25 +3,27 @@
 #include "../../config/defines.h"
 #include "../../hardware/i2c_manager.h"
 #include "../../utils/log.h"
+#include "../../utils/timebase.h"
 #include "autosteer/was.h"
 
 namespace hw {
 
 ADS1115_lite ADS1115WAS::ads1115;
 int16_t ADS1115WAS::actual_steer_pos_raw = 0;
+int64_t ADS1115WAS::sample_time = 0;
 bool ADS1115WAS::first_read = true;
 
 bool ADS1115WAS::init() {
-    debug("Initializing ADS1115 WAS");
+    LOGD(was, "Initializing ADS1115 WAS");
     I2C_MUTEX_LOCK();
     Wire.end();
     Wire.setPins(I2C_SDA_PIN, I2C_SCL_PIN);
     Wire.begin();
 
     if (ads1115.isConnected()) {
-        debug("WAS ADC Connection OK");
+        LOGD(was, "WAS ADC Connection OK");
     } else {
-        error("WAS ADC Connection FAILED!");
+        LOGE(was, "WAS ADC Connection FAILED!");
         I2C_MUTEX_UNLOCK();
         return false;
     }
@@ -40,6 +42,7 @@ bool ADS1115WAS::init() {
 
     was::WASInterface interface;
     interface.readRaw = readRaw;
+    interface.timestamp = getTimestamp;
     was::init(interface);
     return true;
 }
@@ -56,6 +59,7 @@ void ADS1115WAS::handler() {
             I2C_MUTEX_LOCK();
             // First read the result of the previous conversion
             actual_steer_pos_raw = ads1115.readConversion();
+            sample_time = timebase::now_gnss();
 
             // Then start the next conversion
             ads1115.setMux(ADS1115_MUX_SINGLE_0);
@@ -67,6 +71,7 @@ void ADS1115WAS::handler() {
             I2C_MUTEX_LOCK();
             // First read the result of the previous conversion
             actual_steer_pos_raw = ads1115.readConversion();
+            sample_time = timebase::now_gnss();
 
             // Then start the next conversion
             ads1115.setMux(ADS1115_MUX_DIFF_0_1);
@@ -75,9 +80,13 @@ void ADS1115WAS::handler() {
             break;
 
         default:
-            warning("WAS type not supported");
+            LOGW(was, "WAS type not supported");
             break;
     }
 }
 
+int64_t ADS1115WAS::getTimestamp() {
+    return sample_time;
+}
+
 } // namespace hw
\ No newline at end of file
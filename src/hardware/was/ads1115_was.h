@@ -12,10 +12,12 @@ public:
     static bool init();
     static int16_t readRaw();
     static void handler();
+    static int64_t getTimestamp();
 
 private:
     static ADS1115_lite ads1115;
     static int16_t actual_steer_pos_raw;
+    static int64_t sample_time;
     static bool first_read;
 };
 } // namespace hw
@@ -0,0 +1,303 @@
+#include "diag.h"
+
+#include <AsyncUDP.h>
+#include <stdarg.h>
+
+#include "config/defines.h"
+#include "autosteer/telemetry.h"
+#include "utils/blackbox.h"
+#include "utils/heap_guard.h"
+#include "utils/log.h"
+#include "utils/metrics.h"
+#include "utils/trace.h"
+#include "utils/stress.h"
+#include "tasks.h"
+#include "udp_rx.h"
+#include "ota.h"
+
+namespace diag {
+using Handler = void (*)(const char *args, const Reply &reply);
+
+struct Command {
+    const char *name;
+    const char *usage;
+    Handler handler;
+};
+
+static AsyncUDP diag_udp;
+
+bool send(const Reply &reply, const uint8_t *data, size_t len) {
+    return diag_udp.writeTo(data, len, reply.address, reply.port) == len;
+}
+
+bool sendf(const Reply &reply, const char *format, ...) {
+    char text[512];
+    va_list args;
+    va_start(args, format);
+    int len = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (len < 0) {
+        return false;
+    }
+    return send(reply, reinterpret_cast<const uint8_t *>(text), min(static_cast<size_t>(len), sizeof(text) - 1));
+}
+
+// Trace dump datagrams: 'T' 'R', u8 version, u8 event size, u16 sequence, u16 event count, events
+constexpr size_t TRACE_HEADER_SIZE = 8;
+constexpr size_t TRACE_DATAGRAM    = 1472;
+constexpr size_t TRACE_PER_DATAGRAM = (TRACE_DATAGRAM - TRACE_HEADER_SIZE) / trace::EVENT_SIZE;
+
+struct TraceDump {
+    const Reply *reply;
+    uint8_t buf[TRACE_DATAGRAM];
+    uint16_t sequence;
+    uint16_t count;
+};
+
+static void flush_trace(TraceDump &dump) {
+    if (dump.count == 0) {
+        return;
+    }
+    dump.buf[0] = 'T';
+    dump.buf[1] = 'R';
+    dump.buf[2] = 1;
+    dump.buf[3] = trace::EVENT_SIZE;
+    dump.buf[4] = dump.sequence & 0xFF;
+    dump.buf[5] = dump.sequence >> 8;
+    dump.buf[6] = dump.count & 0xFF;
+    dump.buf[7] = dump.count >> 8;
+    send(*dump.reply, dump.buf, TRACE_HEADER_SIZE + dump.count * trace::EVENT_SIZE);
+    dump.sequence++;
+    dump.count = 0;
+}
+
+static void add_trace_event(const trace::Event &event, void *context) {
+    TraceDump &dump = *static_cast<TraceDump *>(context);
+    trace::encode(event, dump.buf + TRACE_HEADER_SIZE + dump.count * trace::EVENT_SIZE);
+    if (++dump.count == TRACE_PER_DATAGRAM) {
+        flush_trace(dump);
+    }
+}
+
+static void cmd_trace(const char *args, const Reply &reply) {
+    if (strcmp(args, "start") == 0) {
+        trace::start();
+        sendf(reply, "trace: started");
+    } else if (strcmp(args, "stop") == 0) {
+        trace::stop();
+        sendf(reply, "trace: stopped");
+    } else if (strcmp(args, "dump") == 0) {
+        static TraceDump dump; // Too large for the UDP task stack
+        dump.reply    = &reply;
+        dump.sequence = 0;
+        dump.count    = 0;
+        size_t events = trace::dump(add_trace_event, &dump);
+        flush_trace(dump);
+        sendf(reply, "trace: %u events", static_cast<unsigned>(events));
+    } else {
+        sendf(reply, "trace: %s", trace::is_running() ? "running" : "stopped");
+    }
+}
+
+static void cmd_telemetry(const char *args, const Reply &reply) {
+    if (strncmp(args, "on", 2) == 0) {
+        int decimation = atoi(args + 2);
+        telemetry::configure(true, decimation > 0 ? decimation : TELEMETRY_DECIMATION);
+    } else if (strcmp(args, "off") == 0) {
+        telemetry::configure(false, TELEMETRY_DECIMATION);
+    }
+    const telemetry::Stats &stats = telemetry::get_stats();
+    sendf(reply, "telemetry: %s records=%u datagrams=%u dropped=%u", telemetry::is_enabled() ? "on" : "off",
+          stats.records, stats.datagrams, stats.dropped);
+}
+
+static void cmd_stress(const char *args, const Reply &reply) {
+    if (strncmp(args, "start", 5) == 0) {
+        int seconds = atoi(args + 5);
+        stress::start((seconds > 0 ? seconds : 30) * 1000UL);
+        sendf(reply, "stress: baseline_ms=%u", STRESS_BASELINE_MS);
+        return;
+    }
+    if (strcmp(args, "stop") == 0) {
+        stress::stop();
+    }
+    // key=value lines for tools/udp_flood.py
+    const char *phases[] = {"idle", "baseline", "load", "done"};
+    stress::Report report = stress::get_report();
+    ScheduleStats sched   = get_schedule_stats();
+    sendf(reply, "stress: phase=%s passed=%d cycles=%u period_mean_us=%.1f period_max_us=%u period_p99_us=%u "
+                 "jitter_us=%.1f rx_autosteer=%u rx_gps=%u cpu0=%.3f cpu1=%.3f idle0=%u idle1=%u "
+                 "limit_max_us=%u limit_p99_us=%u sched=%s stack=%u heap_free=%u heap_min=%u overruns=%u slips=%u",
+          phases[static_cast<int>(report.phase)], report.passed, report.cycles, report.period_mean_us,
+          report.period_max_us, report.period_p99_us, report.jitter_us, report.rx[0], report.rx[1],
+          report.cpu_load[0], report.cpu_load[1], report.idle_rate[0], report.idle_rate[1], STRESS_MAX_PERIOD_US,
+          STRESS_MAX_P99_US, sched.cyclic ? "cyclic" : "tasks", sched.stack_bytes, ESP.getFreeHeap(),
+          ESP.getMinFreeHeap(), sched.overruns, sched.slips);
+}
+
+static void cmd_sched(const char *args, const Reply &reply) {
+    ScheduleStats sched = get_schedule_stats();
+    sendf(reply, "sched: mode=%s frame_us=%u major_frames=%u frames=%u overruns=%u slips=%u max_frame_us=%u stack=%u",
+          sched.cyclic ? "cyclic" : "tasks", CYCLIC_FRAME_US, sched.major_frames, sched.frames, sched.overruns,
+          sched.slips, sched.max_frame_us, sched.stack_bytes);
+    if (strcmp(args, "frames") == 0 && sched.cyclic) {
+        for (uint32_t frame = 0; frame < sched.major_frames; frame++) {
+            FrameStats stats = get_frame_stats(frame);
+            if (stats.overruns > 0) {
+                sendf(reply, "sched: frame=%u runs=%u overruns=%u max_us=%u", frame, stats.runs, stats.overruns,
+                      stats.max_us);
+            }
+        }
+    }
+}
+
+static void cmd_rx(const char *args, const Reply &reply) {
+    if (strcmp(args, "reset") == 0) {
+        udp_rx::reset_stats();
+    }
+    udp_rx::Stats stats = udp_rx::get_stats();
+    sendf(reply, "rx: path=%s packets=%u dropped=%u unmatched=%u latency_n=%u latency_mean_us=%u "
+                 "latency_p50_us=%u latency_p99_us=%u latency_max_us=%u",
+          udp_rx::fast_path() ? "fast" : "asyncudp", stats.packets, stats.dropped, stats.unmatched,
+          stats.latency_cnt, stats.latency_cnt ? static_cast<uint32_t>(stats.latency_sum_us / stats.latency_cnt) : 0,
+          udp_rx::latency_percentile(stats, 0.5f), udp_rx::latency_percentile(stats, 0.99f), stats.latency_max_us);
+}
+
+static void cmd_ota(const char *args, const Reply &reply) {
+    // key=value line for tools/ota_push.py --wait
+    const char *states[] = {"idle", "receiving", "failed", "rebooting"};
+    ota::Status status = ota::get_status();
+    sendf(reply, "ota: state=%s received=%u size=%u running=%s pending=%d boots=%u rolled_back=%d version=%s error=%s",
+          states[static_cast<int>(status.state)], status.received, status.size, status.running, status.pending,
+          status.boot_attempts, status.rolled_back, FIRMWARE_VERSION, status.error[0] ? status.error : "-");
+}
+
+static void cmd_blackbox(const char *args, const Reply &reply) {
+    blackbox::Stats stats = blackbox::get_stats();
+    sendf(reply, "blackbox: running=%d segment=%u segments=%u records=%u dropped=%u buffers=%u write_errors=%u "
+                 "max_write_us=%u used_kib=%u total_kib=%u",
+          blackbox::is_running(), stats.segment, stats.segments, stats.records, stats.dropped, stats.buffers,
+          stats.write_errors, stats.max_write_us, static_cast<unsigned>(stats.used_bytes / 1024),
+          static_cast<unsigned>(stats.total_bytes / 1024));
+}
+
+static void cmd_log(const char *args, const Reply &reply) {
+    // log [<category>|all <level>] | log rate <category>|all <per second>
+    char first[16] = "", second[16] = "", third[16] = "";
+    int words = sscanf(args, "%15s %15s %15s", first, second, third);
+    bool rate = words == 3 && strcmp(first, "rate") == 0;
+    const char *target = rate ? second : first;
+    const char *value  = rate ? third : second;
+    if (words >= 2) {
+        LogCategory category = LogCategory::general;
+        LogLevel level       = LogLevel::DEBUG;
+        bool all = strcmp(target, "all") == 0;
+        if (!all && !parseLogCategory(target, category)) {
+            sendf(reply, "log: unknown category %s", target);
+            return;
+        }
+        if (!rate && !parseLogLevel(value, level)) {
+            sendf(reply, "log: unknown level %s", value);
+            return;
+        }
+        for (size_t i = 0; i < static_cast<size_t>(LogCategory::count); i++) {
+            auto current = static_cast<LogCategory>(i);
+            if (!all && current != category) continue;
+            if (rate) {
+                setLogRate(current, static_cast<uint16_t>(atoi(value)));
+            } else {
+                setLogLevel(current, level);
+            }
+        }
+        if (!saveLogConfig()) {
+            sendf(reply, "log: not saved");
+        }
+    }
+    for (size_t i = 0; i < static_cast<size_t>(LogCategory::count); i++) {
+        auto category = static_cast<LogCategory>(i);
+        sendf(reply, "log: %s level=%s rate=%u suppressed=%u", logCategoryName(category),
+              logLevelName(getLogLevel(category)), getLogRate(category), getLogSuppressed(category));
+    }
+}
+
+static void cmd_metrics(const char *args, const Reply &reply) {
+    static uint8_t buf[1472]; // Keeps the snapshot off the UDP task stack
+    size_t len = metrics::encode(buf, sizeof(buf));
+    if (len == 0) {
+        sendf(reply, "metrics: snapshot too large");
+        return;
+    }
+    send(reply, buf, len);
+}
+
+static void cmd_heap(const char *args, const Reply &reply) {
+    const char *modes[]     = {"off", "count", "trap"};
+    heap_guard::Stats stats = heap_guard::get_stats();
+    sendf(reply, "heap: guard=%s ready=%d free=%u min_free=%u largest_block=%u boot_allocations=%u allocations=%u "
+                 "allocated_bytes=%u rate=%.1f control_allocations=%u last_task=%s last_caller=0x%08x",
+          modes[HEAP_GUARD_MODE], stats.ready, stats.free_bytes, stats.min_free_bytes, stats.largest_block,
+          stats.boot_allocations, stats.allocations, stats.allocated_bytes, stats.rate, stats.watched_allocations,
+          stats.last_task[0] ? stats.last_task : "-", stats.last_caller);
+}
+
+static void cmd_help(const char *args, const Reply &reply);
+
+static const Command commands[] = {
+    {"help", "", cmd_help},
+    {"trace", "start|stop|dump", cmd_trace},
+    {"telemetry", "on [decimation]|off", cmd_telemetry},
+    {"stress", "start [seconds]|stop|report", cmd_stress},
+    {"rx", "[reset]", cmd_rx},
+    {"sched", "[frames]", cmd_sched},
+    {"ota", "", cmd_ota},
+    {"blackbox", "", cmd_blackbox},
+    {"log", "[<category>|all debug|info|warning|error|off] | rate <category>|all <per second>", cmd_log},
+    {"metrics", "", cmd_metrics},
+    {"heap", "", cmd_heap},
+};
+
+static void cmd_help(const char *args, const Reply &reply) {
+    for (const auto &command: commands) {
+        sendf(reply, "%s %s", command.name, command.usage);
+    }
+}
+
+static void dispatch(char *line, const Reply &reply) {
+    // Split off the command word, args keep the rest of the line
+    char *args = line;
+    while (*args && *args != ' ') args++;
+    if (*args) *args++ = '\0';
+    while (*args == ' ') args++;
+
+    for (const auto &command: commands) {
+        if (strcmp(line, command.name) == 0) {
+            command.handler(args, reply);
+            return;
+        }
+    }
+    sendf(reply, "error: unknown command '%s'", line);
+}
+
+bool rebind() {
+    return diag_udp.listen(DIAG_UDP_PORT);
+}
+
+bool init() {
+    if (!rebind()) {
+        error("Diagnostics port listen failed");
+        return false;
+    }
+    debugf("Diagnostics commands on UDP port %d", DIAG_UDP_PORT);
+    diag_udp.onPacket([](AsyncUDPPacket packet) {
+        char line[128];
+        size_t len = min(packet.length(), sizeof(line) - 1);
+        memcpy(line, packet.data(), len);
+        while (len > 0 && (line[len - 1] == '\n' || line[len - 1] == '\r' || line[len - 1] == ' ')) len--;
+        line[len] = '\0';
+
+        Reply reply = {packet.remoteIP(), packet.remotePort()};
+        dispatch(line, reply);
+    });
+    return true;
+}
+} // namespace diag
@@ -0,0 +1,24 @@
+#ifndef DIAG_H
+#define DIAG_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+
+// Diagnostics command port. Each datagram carries one text command ("help" lists them);
+// replies, text or binary, go back to the sender's address and port.
+namespace diag {
+
+struct Reply {
+    IPAddress address;
+    uint16_t port;
+};
+
+bool init();
+// Rebind the command socket after a network reconnect
+bool rebind();
+
+bool send(const Reply &reply, const uint8_t *data, size_t len);
+bool sendf(const Reply &reply, const char *format, ...);
+} // namespace diag
+
+#endif //DIAG_H
@@ -1,5 +1,7 @@
 #include "ethernet.h"
 
+#include <atomic>
+
 #include "config/pinout.h"
 #include "config/defines.h"
 #include "utils/log.h"
@@ -11,6 +13,11 @@ IPAddress gateway(STATIC_GW_ADDR);
 IPAddress subnet(STATIC_SN_ADDR);
 IPAddress dns(STATIC_DNS_ADDR);
 
+static std::atomic<LinkState> linkState{LinkState::stopped};
+static void (*networkUpCallback)(const IPAddress &ip) = nullptr;
+static void (*networkDownCallback)()                   = nullptr;
+static uint32_t linkChanges                            = 0;
+
 void getMacAddress(uint8_t* mac) {
     uint64_t chipmacid = ESP.getEfuseMac();
     mac[5] = (chipmacid >> 40) & 0xFF;
@@ -21,34 +28,94 @@ void getMacAddress(uint8_t* mac) {
     mac[0] = chipmacid & 0xFF;
 }
 
+static void setLinkState(LinkState state) {
+    LinkState previous = linkState.exchange(state);
+    if (previous == state) {
+        return;
+    }
+    linkChanges++;
+    if (state == LinkState::ip_acquired) {
+        LOGI(net, "Network up - IP: %s", ETH.localIP().toString().c_str());
+        if (networkUpCallback) {
+            networkUpCallback(ETH.localIP());
+        }
+    } else if (previous == LinkState::ip_acquired) {
+        LOGW(net, "Network down (link changes: %u)", linkChanges);
+        if (networkDownCallback) {
+            networkDownCallback();
+        }
+    }
+}
+
+// Runs in the Arduino network event task, never in a control task
+void EthEvent(WiFiEvent_t event) {
+    switch (event) {
+        case ARDUINO_EVENT_ETH_START:
+            setLinkState(LinkState::started);
+            break;
+        case ARDUINO_EVENT_ETH_CONNECTED:
+            LOGD(net, "Ethernet link up, %u Mbps %s duplex", ETH.linkSpeed(), ETH.fullDuplex() ? "full" : "half");
+            // A static address is usable as soon as the link is
+            setLinkState(!USE_DHCP && ETH.localIP() != INADDR_NONE ? LinkState::ip_acquired : LinkState::link_up);
+            break;
+        case ARDUINO_EVENT_ETH_GOT_IP:
+            setLinkState(LinkState::ip_acquired);
+            break;
+        case ARDUINO_EVENT_ETH_DISCONNECTED:
+            setLinkState(LinkState::started);
+            break;
+        case ARDUINO_EVENT_ETH_STOP:
+            setLinkState(LinkState::stopped);
+            break;
+        default:
+            break;
+    }
+}
+
 bool initializeEthernet() {
-    debug("Initializing Ethernet...");
+    LOGD(net, "Initializing Ethernet...");
     ESP32_W6100_onEvent();
+    WiFi.onEvent(EthEvent);
     
     // Get the ESP32's MAC address
     uint8_t mac[6];
     getMacAddress(mac);
     
-    debugf("MAC: %02X:%02X:%02X:%02X:%02X:%02X", 
+    LOGD(net, "MAC: %02X:%02X:%02X:%02X:%02X:%02X", 
         mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
     
-    ETH.begin(W6100_MISO_GPIO, W6100_MOSI_GPIO, W6100_SCK_GPIO, W6100_CS_GPIO, W6100_INT_GPIO, SPI_CLOCK_MHZ, ETH_SPI_HOST, mac);
+    if (!ETH.begin(W6100_MISO_GPIO, W6100_MOSI_GPIO, W6100_SCK_GPIO, W6100_CS_GPIO, W6100_INT_GPIO, SPI_CLOCK_MHZ, ETH_SPI_HOST, mac)) {
+        LOGE(net, "Failed to start the W6100");
+        return false;
+    }
 
     if (USE_DHCP) {
-        // Wait for connection
-        debug("Waiting for DHCP connection...");
-        while (ETH.localIP() == INADDR_NONE) {
-            delay(500);
-        }
+        LOGD(net, "DHCP requested, continuing while the address is acquired");
     } else {
         ETH.config(staticIP, gateway, subnet, dns);
     }
+    return true;
+}
 
-    if (ETH.localIP() == INADDR_NONE) {
-        errorf("Failed to configure network - IP: %s", ETH.localIP().toString().c_str());
-        return false;
+LinkState getLinkState() {
+    return linkState.load();
+}
+
+bool networkReady() {
+    return linkState.load() == LinkState::ip_acquired;
+}
+
+IPAddress getLocalIP() {
+    return ETH.localIP();
+}
+
+void onNetworkUp(void (*callback)(const IPAddress &ip)) {
+    networkUpCallback = callback;
+    if (callback && networkReady()) {
+        callback(ETH.localIP());
     }
+}
 
-    debugf("Network configured - IP: %s", ETH.localIP().toString().c_str());
-    return true;
+void onNetworkDown(void (*callback)()) {
+    networkDownCallback = callback;
 }
@@ -3,6 +3,26 @@
 #include <Arduino.h>
 #include <WebServer_ESP32_SC_W6100.hpp>
 
+enum class LinkState : uint8_t {
+    stopped,     // Driver not started
+    started,     // Driver running, no cable or link partner
+    link_up,     // Link established, waiting for an address
+    ip_acquired  // Address assigned, sockets usable
+};
+
 // Function declarations
 void EthEvent(WiFiEvent_t event);
-bool initializeEthernet(); 
\ No newline at end of file
+
+// Starts the W6100 and returns without waiting for DHCP; link and address
+// changes are tracked from the network events.
+bool initializeEthernet();
+
+LinkState getLinkState();
+bool networkReady();
+IPAddress getLocalIP();
+
+// Called from the network event task on every transition to ip_acquired, including
+// reconnects. Registering while the address is already assigned calls it right away.
+void onNetworkUp(void (*callback)(const IPAddress &ip));
+// Called on the transition away from ip_acquired
+void onNetworkDown(void (*callback)());
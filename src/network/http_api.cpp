@@ -0,0 +1,270 @@
+#include "http_api.h"
+
+#include <cmath>
+#include <esp_heap_caps.h>
+
+#include "autosteer/autosteer.h"
+#include "autosteer/buttons.h"
+#include "autosteer/guidance_link.h"
+#include "autosteer/heading.h"
+#include "autosteer/imu.h"
+#include "autosteer/settings.h"
+#include "autosteer/telemetry.h"
+#include "autosteer/udp_io.h"
+#include "autosteer/was.h"
+#include "gps/rtcm.h"
+#include "utils/blackbox.h"
+#include "utils/log.h"
+#include "utils/metrics.h"
+#include "utils/timebase.h"
+#include "ethernet.h"
+#include "udp_rx.h"
+#include "udp_tx.h"
+#include "live.h"
+#include "live_page.h"
+
+namespace http::api {
+
+static const char *boolean(bool value) {
+    return value ? "true" : "false";
+}
+
+// JSON has no NaN or infinity, a sensor that is not reading goes out as null
+struct Number {
+    char text[48];
+};
+
+static Number number(float value, int decimals) {
+    Number number;
+    if (std::isfinite(value)) {
+        snprintf(number.text, sizeof(number.text), "%.*f", decimals, value);
+    } else {
+        strcpy(number.text, "null");
+    }
+    return number;
+}
+
+void index(const char *query, Response &response) {
+    response.begin(200, "text/html");
+    response.print("<!DOCTYPE html><html><head><title>" FIRMWARE_VERSION "</title></head><body><h1>Steer module</h1><ul>"
+                   "<li><a href=\"/api/log\">log</a></li>"
+                   "<li><a href=\"/api/settings\">settings</a></li>"
+                   "<li><a href=\"/api/sensors\">sensors</a></li>"
+                   "<li><a href=\"/api/tasks\">tasks</a></li>"
+                   "<li><a href=\"/api/network\">network</a></li>"
+                   "<li><a href=\"/api/blackbox\">black box</a></li>"
+                   "<li><a href=\"/metrics\">metrics</a></li>"
+                   "<li><a href=\"/live\">live plot</a></li>"
+                   "</ul></body></html>\n");
+    response.end();
+}
+
+void log(const char *query, Response &response) {
+    response.begin(200, "application/json");
+    response.printf("{\"timestamp\":%u,\"log\":[", static_cast<unsigned>(millis()));
+    bool first = true;
+    char entry[LOG_ENTRY_SIZE]; // Entries are escaped and clipped to this size when logged
+    for (int i = 0; i < LOG_SIZE; i++) {
+        size_t len = copyLogEntry(i, entry, sizeof(entry));
+        if (len == 0) {
+            continue;
+        }
+        if (!first) response.print(",");
+        response.write(entry, len);
+        first = false;
+    }
+    response.print("]}\n");
+    response.end();
+}
+
+void settings(const char *query, Response &response) {
+    response.begin(200, "application/json");
+    response.printf("{\"gainP\":%u,\"minPWM\":%u,\"lowPWM\":%u,\"maxPWM\":%u,\"steerSensorCounts\":%d,"
+                    "\"steerAngleOffset\":%d,\"ackermanFix\":%u,",
+                    Set.gainP, Set.minPWM, Set.lowPWM, Set.maxPWM, Set.steerSensorCounts, Set.steerAngleOffset,
+                    Set.ackermanFix);
+    response.printf("\"minSpeed\":%u,\"invertWAS\":%s,\"isRelayActiveHigh\":%s,\"invertSteer\":%s,"
+                    "\"wasType\":%d,\"driverType\":%d,\"steerSwitchType\":%d,\"gainSchedule\":[",
+                    Set.minSpeed, boolean(Set.invertWAS), boolean(Set.isRelayActiveHigh), boolean(Set.invertSteer),
+                    static_cast<int>(Set.wasType), static_cast<int>(Set.driverType),
+                    static_cast<int>(Set.steer_switch_type));
+    const GainSchedule schedule = settings::getSchedule();
+    for (uint8_t i = 0; i < schedule.count; i++) {
+        const GainPoint &point = schedule.points[i];
+        response.printf("%s{\"speed\":%.1f,\"gainP\":%u,\"lowPWM\":%u,\"maxPWM\":%u,\"minPWM\":%u,\"ffGain\":%.1f}",
+                        i ? "," : "", point.speed / 10.0f, point.gainP, point.lowPWM, point.maxPWM, point.minPWM,
+                        point.ffGain / 10.0f);
+    }
+    response.print("]}\n");
+    response.end();
+}
+
+void sensors(const char *query, Response &response) {
+    uint32_t now_ms                = millis();
+    autosteer::State state         = autosteer::getState();
+    guidance_link::Stats link      = guidance_link::get_stats(now_ms);
+    timebase::Status time          = timebase::get_status();
+    const char *link_states[]      = {"waiting", "fresh", "grace", "lost"};
+
+    response.begin(200, "application/json");
+    response.printf("{\"time_ms\":%u,\"steer\":{\"setPoint\":%s,\"actual\":%s,\"error\":%s,\"output\":%d,"
+                    "\"pwm\":%u,\"reversed\":%s,",
+                    now_ms, number(state.setPoint, 2).text, number(state.actual, 2).text, number(state.error, 2).text,
+                    state.output, state.pwm, boolean(state.reversed));
+    response.printf("\"enabled\":%s,\"hwEnable\":%s,\"swEnable\":%s,\"age_ms\":%u},",
+                    boolean(state.enabled), boolean(state.hwEnable), boolean(state.swEnable), now_ms - state.time_ms);
+    response.printf("\"was\":{\"angle\":%s,\"raw\":%d,\"counts\":%u},",
+                    number(was::get_steering_angle(), 2).text, was::get_raw_steering_position(),
+                    was::get_wheel_angle_sensor_counts());
+    response.printf("\"imu\":{\"available\":%s,\"heading\":%s,\"roll\":%s,\"pitch\":%s},",
+                    boolean(imu::is_available()), number(imu::get_heading(), 2).text, number(imu::get_roll(), 2).text,
+                    number(imu::get_pitch(), 2).text);
+    response.printf("\"heading\":{\"value\":%s,\"source\":\"%s\"},",
+                    number(heading::get(), 2).text, heading::get_source() == heading::Source::dual ? "dual" : "imu");
+    response.printf("\"switches\":{\"steer\":%s,\"work\":%s},\"speed\":%s,",
+                    boolean(buttons::steerBntEnabled()), boolean(buttons::workBntEnabled()),
+                    number(getGpsSpeed(), 1).text);
+    response.printf("\"guidance\":{\"state\":\"%s\",\"age_ms\":%u,\"period_ms\":%s,\"jitter_ms\":%s,",
+                    link_states[static_cast<int>(link.state)], link.age_ms, number(link.period_ms, 1).text,
+                    number(link.jitter_ms, 1).text);
+    response.printf("\"loss\":%s,\"timeout_ms\":%u,\"packets\":%u,\"missed\":%u},", number(link.loss, 3).text,
+                    link.timeout_ms, link.packets, link.missed);
+    response.printf("\"timebase\":{\"synced\":%s,\"offset_us\":%lld,\"drift_ppm\":%s,\"pps_edges\":%u}}\n",
+                    boolean(time.synced), static_cast<long long>(time.offset_us), number(time.drift_ppm, 2).text,
+                    time.pps_edges);
+    response.end();
+}
+
+void tasks(const char *query, Response &response) {
+    response.begin(200, "application/json");
+    response.printf("{\"uptime_ms\":%u,\"heap\":{\"free\":%u,\"min_free\":%u,\"largest_block\":%u},\"tasks\":[",
+                    static_cast<unsigned>(millis()), heap_caps_get_free_size(MALLOC_CAP_8BIT),
+                    heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT), heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+#if configUSE_TRACE_FACILITY
+    // Static so the snapshot does not sit on the HTTP task stack
+    static TaskStatus_t status[24];
+    uint32_t total_runtime = 0;
+    UBaseType_t count      = uxTaskGetSystemState(status, sizeof(status) / sizeof(status[0]), &total_runtime);
+    const char *states[]   = {"running", "ready", "blocked", "suspended", "deleted", "invalid"};
+    for (UBaseType_t i = 0; i < count; i++) {
+        const TaskStatus_t &task = status[i];
+        response.printf("%s{\"name\":", i ? "," : "");
+        response.string(task.pcTaskName);
+        response.printf(",\"priority\":%u,\"state\":\"%s\",\"stack_free\":%u", task.uxCurrentPriority,
+                        states[min(static_cast<int>(task.eCurrentState), 5)], task.usStackHighWaterMark);
+#if configTASKLIST_INCLUDE_COREID
+        response.printf(",\"core\":%d", task.xCoreID == tskNO_AFFINITY ? -1 : static_cast<int>(task.xCoreID));
+#endif
+#if configGENERATE_RUN_TIME_STATS
+        // Both cores accumulate runtime, so a fully loaded core is half the total
+        response.printf(",\"cpu\":%.3f", total_runtime ? 2.0f * task.ulRunTimeCounter / total_runtime : 0.0f);
+#endif
+        response.print("}");
+    }
+#endif
+    response.print("]}\n");
+    response.end();
+}
+
+void network(const char *query, Response &response) {
+    const char *link_states[] = {"stopped", "started", "link_up", "ip_acquired"};
+    response.begin(200, "application/json");
+    response.printf("{\"link\":\"%s\",\"ip\":\"%s\",\"udp_tx\":{",
+                    link_states[static_cast<int>(getLinkState())], getLocalIP().toString().c_str());
+
+    const char *ports[]        = {"autosteer", "gps", "telemetry", "log"};
+    const udp_tx::Stats &tx    = udp_tx::get_stats();
+    for (size_t i = 0; i < static_cast<size_t>(udp_tx::Port::count); i++) {
+        const udp_tx::PortStats &port = tx.ports[i];
+        response.printf("%s\"%s\":{\"packets\":%u,\"bytes\":%u,\"errors\":%u,\"pool_empty\":%u,\"copied\":%u}",
+                        i ? "," : "", ports[i], port.packets, port.bytes, port.errors, port.pool_empty, port.copied);
+    }
+
+    udp_rx::Stats rx = udp_rx::get_stats();
+    response.printf("},\"udp_rx\":{\"path\":\"%s\",\"packets\":%u,\"dropped\":%u,\"latency_p99_us\":%u,"
+                    "\"latency_max_us\":%u},",
+                    udp_rx::fast_path() ? "fast" : "asyncudp", rx.packets, rx.dropped,
+                    udp_rx::latency_percentile(rx, 0.99f), rx.latency_max_us);
+
+    const rtcm::Stats &corrections = rtcm::get_stats();
+    response.printf("\"rtcm\":{\"frames\":%u,\"bytes\":%u,\"bad_crc\":%u,\"duplicates\":%u,\"overflow\":%u,"
+                    "\"queued\":%u},",
+                    corrections.frames, corrections.bytes, corrections.bad_crc, corrections.duplicates,
+                    corrections.overflow, static_cast<unsigned>(rtcm::queued()));
+
+    const telemetry::Stats &records = telemetry::get_stats();
+    response.printf("\"telemetry\":{\"enabled\":%s,\"records\":%u,\"datagrams\":%u,\"dropped\":%u},",
+                    boolean(telemetry::is_enabled()), records.records, records.datagrams, records.dropped);
+
+    live::Stats stream = live::get_stats();
+    response.printf("\"live\":{\"clients\":%u,\"samples\":%u,\"frames\":%u,\"dropped\":%u,\"ring_overruns\":%u},",
+                    stream.clients, stream.samples, stream.frames, stream.dropped, stream.ring_overruns);
+
+    const Stats &server = get_stats();
+    response.printf("\"http\":{\"requests\":%u,\"rejected\":%u,\"timeouts\":%u,\"not_found\":%u,"
+                    "\"write_errors\":%u}}\n",
+                    server.requests, server.rejected, server.timeouts, server.not_found, server.write_errors);
+    response.end();
+}
+struct Listing {
+    Response &response;
+    bool first;
+};
+
+static void segment_entry(uint32_t sequence, size_t size, void *context) {
+    auto *listing = static_cast<Listing *>(context);
+    listing->response.printf("%s{\"sequence\":%u,\"size\":%u}", listing->first ? "" : ",", sequence,
+                             static_cast<unsigned>(size));
+    listing->first = false;
+}
+
+void blackbox_index(const char *query, Response &response) {
+    blackbox::Stats stats = blackbox::get_stats();
+    response.begin(200, "application/json");
+    response.printf("{\"running\":%s,\"rate_hz\":%u,\"record_size\":%u,\"segment\":%u,\"records\":%u,"
+                    "\"dropped\":%u,\"buffers\":%u,\"write_errors\":%u,\"max_write_us\":%u,\"used_bytes\":%u,"
+                    "\"total_bytes\":%u,\"segments\":[",
+                    boolean(blackbox::is_running()), BLACKBOX_RATE, static_cast<unsigned>(blackbox::RECORD_SIZE),
+                    stats.segment, stats.records, stats.dropped, stats.buffers, stats.write_errors, stats.max_write_us,
+                    static_cast<unsigned>(stats.used_bytes), static_cast<unsigned>(stats.total_bytes));
+    Listing listing{response, true};
+    blackbox::list(segment_entry, &listing);
+    response.print("]}\n");
+    response.end();
+}
+
+void blackbox_segment(const char *query, Response &response) {
+    const char *arg = strstr(query, "sequence=");
+    File file       = arg ? blackbox::open_segment(strtoul(arg + 9, nullptr, 10)) : File();
+    if (!file) {
+        response.begin(404, "text/plain");
+        response.print("no such segment\n");
+        response.end();
+        return;
+    }
+    response.begin(200, "application/octet-stream");
+    char buf[256];
+    size_t n;
+    while (!response.failed() && (n = file.read(reinterpret_cast<uint8_t *>(buf), sizeof(buf))) > 0) {
+        response.write(buf, n);
+    }
+    file.close();
+    response.end();
+}
+
+static void text_sink(const char *text, size_t len, void *context) {
+    static_cast<Response *>(context)->write(text, len);
+}
+
+void prometheus(const char *query, Response &response) {
+    response.begin(200, "text/plain; version=0.0.4");
+    metrics::write_text(text_sink, &response);
+    response.end();
+}
+
+void live(const char *query, Response &response) {
+    response.begin(200, "text/html");
+    response.write(LIVE_PAGE, sizeof(LIVE_PAGE) - 1);
+    response.end();
+}
+} // namespace http::api
@@ -0,0 +1,23 @@
+#ifndef HTTP_API_H
+#define HTTP_API_H
+
+#include "http_server.h"
+
+// JSON endpoints of the HTTP diagnostics server
+namespace http::api {
+void index(const char *query, Response &response);
+void log(const char *query, Response &response);
+void settings(const char *query, Response &response);
+void sensors(const char *query, Response &response);
+void tasks(const char *query, Response &response);
+void network(const char *query, Response &response);
+// Black box segment list, and one segment as stored (sequence=<n>)
+void blackbox_index(const char *query, Response &response);
+void blackbox_segment(const char *query, Response &response);
+// Metrics registry in Prometheus text format
+void prometheus(const char *query, Response &response);
+// Live plot page for the /ws stream
+void live(const char *query, Response &response);
+} // namespace http::api
+
+#endif //HTTP_API_H
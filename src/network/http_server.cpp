@@ -0,0 +1,275 @@
+#include "http_server.h"
+
+#include <WiFiServer.h>
+#include <stdarg.h>
+
+#include "ethernet.h"
+#include "http_api.h"
+#include "live.h"
+#include "utils/log.h"
+
+namespace http {
+
+struct Route {
+    const char *path;
+    Handler handler;
+};
+
+static const Route routes[] = {
+    {"/", api::index},
+    {"/api/log", api::log},
+    {"/api/settings", api::settings},
+    {"/api/sensors", api::sensors},
+    {"/api/tasks", api::tasks},
+    {"/api/network", api::network},
+    {"/api/blackbox", api::blackbox_index},
+    {"/api/blackbox/segment", api::blackbox_segment},
+    {"/metrics", api::prometheus},
+    {"/live", api::live},
+};
+
+// One accepted connection collecting its request header
+struct Slot {
+    WiFiClient client;
+    bool active;
+    uint32_t accepted_ms;
+    char request[HTTP_REQUEST_SIZE];
+    size_t len;
+};
+
+static WiFiServer server(HTTP_PORT);
+static Slot slots[HTTP_MAX_CLIENTS];
+static Stats stats = {};
+
+void Response::begin(int status, const char *content_type) {
+    const char *reason = status == 200   ? "OK"
+                         : status == 400 ? "Bad Request"
+                         : status == 404 ? "Not Found"
+                         : status == 405 ? "Method Not Allowed"
+                                         : "Service Unavailable";
+    char header[160];
+    int n = snprintf(header, sizeof(header),
+                     "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nTransfer-Encoding: chunked\r\n"
+                     "Cache-Control: no-store\r\nConnection: close\r\n\r\n",
+                     status, reason, content_type);
+    if (client.write(reinterpret_cast<const uint8_t *>(header), n) != static_cast<size_t>(n)) {
+        failed_ = true;
+    }
+}
+
+void Response::flush() {
+    if (len == 0 || failed_) {
+        len = 0;
+        return;
+    }
+    char size[12];
+    int n = snprintf(size, sizeof(size), "%X\r\n", static_cast<unsigned>(len));
+    bool ok = client.write(reinterpret_cast<const uint8_t *>(size), n) == static_cast<size_t>(n);
+    ok &= client.write(reinterpret_cast<const uint8_t *>(buf), len) == len;
+    ok &= client.write(reinterpret_cast<const uint8_t *>("\r\n"), 2) == 2;
+    failed_ = !ok;
+    len     = 0;
+}
+
+void Response::write(const char *data, size_t count) {
+    while (count > 0 && !failed_) {
+        size_t part = min(count, sizeof(buf) - len);
+        memcpy(buf + len, data, part);
+        len += part;
+        data += part;
+        count -= part;
+        if (len == sizeof(buf)) {
+            flush();
+        }
+    }
+}
+
+void Response::print(const char *text) {
+    write(text, strlen(text));
+}
+
+// Formats straight into the chunk buffer. Text that does not fit behind what is already
+// buffered goes out after a flush, so only a single call longer than a chunk is clipped.
+void Response::printf(const char *format, ...) {
+    for (int attempt = 0; attempt < 2 && !failed_; attempt++) {
+        size_t room = sizeof(buf) - len;
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(buf + len, room, format, args);
+        va_end(args);
+        if (n < 0) {
+            return;
+        }
+        if (static_cast<size_t>(n) < room) {
+            len += n;
+            return;
+        }
+        if (len == 0) {
+            len = sizeof(buf) - 1;
+            flush();
+            return;
+        }
+        flush();
+    }
+}
+
+void Response::string(const char *text) {
+    write("\"", 1);
+    for (const char *p = text; *p; p++) {
+        char c = *p;
+        if (c == '"' || c == '\\') {
+            char escaped[2] = {'\\', c};
+            write(escaped, 2);
+        } else if (static_cast<uint8_t>(c) < 0x20) {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            write(escaped, 6);
+        } else {
+            write(&c, 1);
+        }
+    }
+    write("\"", 1);
+}
+
+void Response::end() {
+    flush();
+    if (!failed_) {
+        client.write(reinterpret_cast<const uint8_t *>("0\r\n\r\n"), 5);
+    }
+}
+
+static void error_response(WiFiClient &client, int status) {
+    Response response(client);
+    response.begin(status, "text/plain");
+    response.print(status == 400   ? "bad request\n"
+                   : status == 404 ? "not found\n"
+                   : status == 405 ? "method not allowed\n"
+                                   : "busy\n");
+    response.end();
+}
+
+// Returns true when the connection was handed over and must stay open
+static bool serve(Slot &slot, const char *headers) {
+    // Request line: METHOD SP target SP version
+    char *method = slot.request;
+    char *target = strchr(method, ' ');
+    if (target == nullptr) {
+        return false;
+    }
+    *target++ = '\0';
+    char *end = strchr(target, ' ');
+    if (end) *end = '\0';
+    char *query = strchr(target, '?');
+    if (query) *query++ = '\0';
+
+    stats.requests++;
+    if (strcmp(method, "GET") != 0) {
+        error_response(slot.client, 405);
+        return false;
+    }
+    if (strcmp(target, "/ws") == 0) {
+        int status = live::upgrade(slot.client, headers, query ? query : "");
+        if (status == 101) {
+            return true;
+        }
+        error_response(slot.client, status);
+        return false;
+    }
+    for (const auto &route: routes) {
+        if (strcmp(target, route.path) == 0) {
+            Response response(slot.client);
+            route.handler(query ? query : "", response);
+            if (response.failed()) {
+                stats.write_errors++;
+            }
+            return false;
+        }
+    }
+    stats.not_found++;
+    error_response(slot.client, 404);
+    return false;
+}
+
+static void drop(Slot &slot) {
+    slot.client.stop();
+    slot.active = false;
+}
+
+static void accept_client() {
+    WiFiClient incoming = server.available();
+    if (!incoming) {
+        return;
+    }
+    for (auto &slot: slots) {
+        if (!slot.active) {
+            slot.client      = incoming;
+            slot.active      = true;
+            slot.accepted_ms = millis();
+            slot.len         = 0;
+            slot.client.setTimeout(HTTP_REQUEST_TIMEOUT / 1000);
+            return;
+        }
+    }
+    stats.rejected++;
+    error_response(incoming, 503);
+    incoming.stop();
+}
+
+static void poll_client(Slot &slot) {
+    while (slot.client.available() && slot.len < sizeof(slot.request) - 1) {
+        slot.request[slot.len++] = static_cast<char>(slot.client.read());
+    }
+    slot.request[slot.len] = '\0';
+
+    // Wait for the whole header, the WebSocket upgrade needs its key
+    char *line_end = strstr(slot.request, "\r\n");
+    if (line_end != nullptr && strstr(line_end, "\r\n\r\n") != nullptr) {
+        *line_end = '\0';
+        if (serve(slot, line_end + 2)) {
+            slot.client = WiFiClient(); // Now owned by live, release without closing
+            slot.active = false;
+        } else {
+            drop(slot);
+        }
+    } else if (!slot.client.connected() || millis() - slot.accepted_ms > HTTP_REQUEST_TIMEOUT ||
+               slot.len == sizeof(slot.request) - 1) {
+        stats.timeouts++;
+        drop(slot);
+    }
+}
+
+[[noreturn]] static void http_task(void *pv_parameters) {
+    bool listening = false;
+    for (;;) {
+        if (!listening && networkReady()) {
+            server.begin();
+            listening = true;
+            debugf("HTTP diagnostics on port %d", HTTP_PORT);
+        }
+        if (listening) {
+            accept_client();
+            for (auto &slot: slots) {
+                if (slot.active) {
+                    poll_client(slot);
+                }
+            }
+        }
+        vTaskDelay(pdMS_TO_TICKS(HTTP_POLL_INTERVAL));
+    }
+}
+
+bool init() {
+    TaskHandle_t handle = nullptr;
+    BaseType_t created  = xTaskCreatePinnedToCore(http_task, "http_task", 6144, nullptr, HTTP_TASK_PRIORITY, &handle,
+                                                  HTTP_TASK_CORE);
+    if (created != pdPASS || handle == nullptr) {
+        error("Failed to create HTTP task");
+        return false;
+    }
+    return true;
+}
+
+const Stats &get_stats() {
+    return stats;
+}
+} // namespace http
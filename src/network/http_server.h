@@ -0,0 +1,54 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+#include "config/defines.h"
+
+// Read-only HTTP diagnostics on the W6100 interface. Runs in its own low priority task on
+// the network core; responses are streamed as chunked JSON from a fixed buffer.
+namespace http {
+
+// Chunked response writer. Text accumulates in a fixed buffer that goes out as one chunk
+// whenever it fills, so no response is ever held in memory as a whole.
+class Response {
+public:
+    explicit Response(WiFiClient &client) : client(client) {}
+
+    // Status line and headers, the body follows chunked
+    void begin(int status, const char *content_type);
+    void write(const char *data, size_t len);
+    void print(const char *text);
+    void printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    // Quoted and escaped JSON string
+    void string(const char *text);
+    // Flush and send the terminating chunk
+    void end();
+    bool failed() const { return failed_; }
+
+private:
+    void flush();
+
+    WiFiClient &client;
+    char buf[HTTP_CHUNK_SIZE];
+    size_t len   = 0;
+    bool failed_ = false;
+};
+
+using Handler = void (*)(const char *query, Response &response);
+
+struct Stats {
+    uint32_t requests;
+    uint32_t rejected;  // Refused because HTTP_MAX_CLIENTS connections were open
+    uint32_t timeouts;  // Closed before a complete request arrived
+    uint32_t not_found;
+    uint32_t write_errors;
+};
+
+bool init();
+
+const Stats &get_stats();
+} // namespace http
+
+#endif //HTTP_SERVER_H
@@ -0,0 +1,370 @@
+#include "live.h"
+
+#include <atomic>
+#include <errno.h>
+#include <lwip/sockets.h>
+#include <mbedtls/base64.h>
+#include <mbedtls/sha1.h>
+#include <mbedtls/version.h>
+
+#include "config/defines.h"
+#include "utils/log.h"
+
+namespace live {
+static_assert((LIVE_RING_SIZE & (LIVE_RING_SIZE - 1)) == 0, "LIVE_RING_SIZE must be a power of two");
+
+constexpr size_t FRAME_SIZE   = 160; // Largest encoded frame, header included
+constexpr size_t RX_SIZE      = 128; // Client messages are short text commands
+constexpr uint32_t PERIOD_US  = 1000000UL / LIVE_MAX_RATE;
+constexpr const char *WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+constexpr uint16_t CLOSE_PROTOCOL_ERROR = 1002;
+
+// Ring slot guarded by its sequence number, the reader discards slots rewritten under it
+struct Entry {
+    std::atomic<uint32_t> seq;
+    Sample sample;
+};
+
+struct Client {
+    WiFiClient client;
+    bool active;
+    uint16_t decimation;
+    uint8_t pending[FRAME_SIZE]; // Rest of a partly sent frame
+    size_t pending_len;
+    uint8_t rx[RX_SIZE];
+    size_t rx_len;
+};
+
+static Entry ring[LIVE_RING_SIZE];
+static std::atomic<uint32_t> head{0};
+static uint32_t last_sample_us = 0;
+
+static Client clients[LIVE_MAX_CLIENTS];
+static std::atomic<uint8_t> client_count{0};
+static SemaphoreHandle_t clients_mutex = nullptr;
+static StaticSemaphore_t clients_mutex_storage;
+
+static Stats stats = {};
+
+bool is_active() {
+    return client_count.load(std::memory_order_relaxed) > 0;
+}
+
+void record(const Sample &sample, uint32_t now_us) {
+    if (now_us - last_sample_us < PERIOD_US) {
+        return;
+    }
+    last_sample_us = now_us;
+
+    uint32_t seq = head.load(std::memory_order_relaxed);
+    Entry &entry = ring[seq & (LIVE_RING_SIZE - 1)];
+    entry.seq.store(UINT32_MAX, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    entry.sample = sample;
+    entry.seq.store(seq, std::memory_order_release);
+    head.store(seq + 1, std::memory_order_release);
+    stats.samples++;
+}
+
+static bool read_sample(uint32_t seq, Sample &sample) {
+    const Entry &entry = ring[seq & (LIVE_RING_SIZE - 1)];
+    if (entry.seq.load(std::memory_order_acquire) != seq) {
+        return false;
+    }
+    sample = entry.sample;
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return entry.seq.load(std::memory_order_relaxed) == seq;
+}
+
+static uint16_t decimation_for(int rate) {
+    if (rate < 10) rate = 10;
+    if (rate > LIVE_MAX_RATE) rate = LIVE_MAX_RATE;
+    return static_cast<uint16_t>(LIVE_MAX_RATE / rate);
+}
+
+// Server frames are never masked
+static size_t frame_header(uint8_t *buf, uint8_t opcode, size_t len) {
+    buf[0] = 0x80 | opcode;
+    if (len < 126) {
+        buf[1] = static_cast<uint8_t>(len);
+        return 2;
+    }
+    buf[1] = 126;
+    buf[2] = len >> 8;
+    buf[3] = len & 0xFF;
+    return 4;
+}
+
+static size_t encode(const Sample &s, uint8_t *frame) {
+    char text[FRAME_SIZE - 4];
+    int len = snprintf(text, sizeof(text),
+                       "{\"t\":%u,\"sp\":%.2f,\"a\":%.2f,\"pwm\":%u,\"h\":%.1f,\"r\":%.1f,\"sw\":%u,\"age\":%u}",
+                       s.time_ms, s.setPoint, s.actual, s.pwm, s.heading, s.roll, s.switches, s.guidanceAge_ms);
+    len         = min(len, static_cast<int>(sizeof(text) - 1));
+    size_t offset = frame_header(frame, 0x1, len);
+    memcpy(frame + offset, text, len);
+    return offset + len;
+}
+
+static void drop(Client &c) {
+    if (!c.active) {
+        return;
+    }
+    c.client.stop();
+    c.active = false;
+    client_count--;
+}
+
+// Finish a partly sent frame first; a client whose socket is still full loses this one
+static void send_frame(Client &c, const uint8_t *frame, size_t len) {
+    int fd = c.client.fd();
+    if (c.pending_len > 0) {
+        int sent = ::send(fd, c.pending, c.pending_len, MSG_DONTWAIT);
+        if (sent > 0) {
+            memmove(c.pending, c.pending + sent, c.pending_len - sent);
+            c.pending_len -= sent;
+        } else if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+            drop(c);
+            return;
+        }
+        if (c.pending_len > 0) {
+            stats.dropped++;
+            return;
+        }
+    }
+    int sent = ::send(fd, frame, len, MSG_DONTWAIT);
+    if (sent < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            stats.dropped++;
+        } else {
+            drop(c);
+        }
+        return;
+    }
+    if (static_cast<size_t>(sent) < len) {
+        memcpy(c.pending, frame + sent, len - sent);
+        c.pending_len = len - sent;
+    }
+    stats.frames++;
+}
+
+// Close frame with a status code, then hang up without waiting for the client's reply
+static void send_close(Client &c, uint16_t status) {
+    uint8_t frame[4];
+    size_t offset     = frame_header(frame, 0x8, 2);
+    frame[offset]     = status >> 8;
+    frame[offset + 1] = status & 0xFF;
+    send_frame(c, frame, offset + 2);
+    drop(c);
+}
+
+static void handle_message(Client &c, uint8_t opcode, const uint8_t *payload, size_t len) {
+    uint8_t frame[FRAME_SIZE];
+    switch (opcode) {
+        case 0x1: { // "rate <Hz>"
+            char text[RX_SIZE];
+            memcpy(text, payload, len);
+            text[len] = '\0';
+            if (strncmp(text, "rate", 4) == 0) {
+                c.decimation = decimation_for(atoi(text + 4));
+            }
+            break;
+        }
+        case 0x8: // Close, echo it and hang up
+            send_frame(c, frame, frame_header(frame, 0x8, 0));
+            drop(c);
+            break;
+        case 0x9: { // Ping
+            size_t offset = frame_header(frame, 0xA, len);
+            memcpy(frame + offset, payload, len);
+            send_frame(c, frame, offset + len);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void read_client(Client &c) {
+    int received = ::recv(c.client.fd(), c.rx + c.rx_len, sizeof(c.rx) - c.rx_len, MSG_DONTWAIT);
+    if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK)) {
+        drop(c);
+        return;
+    }
+    if (received > 0) {
+        c.rx_len += received;
+    }
+
+    // Client frames must be masked (RFC 6455 5.1); only short ones are accepted
+    while (c.active && c.rx_len >= 2) {
+        uint8_t opcode = c.rx[0] & 0x0F;
+        size_t len     = c.rx[1] & 0x7F;
+        size_t header  = 2 + 4; // Mask key follows the length
+        if (!(c.rx[1] & 0x80)) {
+            send_close(c, CLOSE_PROTOCOL_ERROR);
+            return;
+        }
+        if (len >= 126 || header + len > sizeof(c.rx)) {
+            drop(c);
+            return;
+        }
+        if (c.rx_len < header + len) {
+            break;
+        }
+        uint8_t *payload = c.rx + header;
+        for (size_t i = 0; i < len; i++) {
+            payload[i] ^= c.rx[2 + (i & 3)];
+        }
+        handle_message(c, opcode, payload, len);
+        memmove(c.rx, c.rx + header + len, c.rx_len - header - len);
+        c.rx_len -= header + len;
+    }
+}
+
+[[noreturn]] static void live_task(void *pv_parameters) {
+    uint32_t tail = head.load(std::memory_order_acquire);
+    uint8_t frame[FRAME_SIZE];
+    for (;;) {
+        xSemaphoreTake(clients_mutex, portMAX_DELAY);
+        for (auto &c: clients) {
+            if (c.active) read_client(c);
+        }
+
+        uint32_t newest = head.load(std::memory_order_acquire);
+        if (newest - tail > LIVE_RING_SIZE) {
+            stats.ring_overruns += newest - tail - LIVE_RING_SIZE;
+            tail = newest - LIVE_RING_SIZE;
+        }
+        for (; tail != newest; tail++) {
+            Sample sample;
+            if (!read_sample(tail, sample)) {
+                stats.ring_overruns++;
+                continue;
+            }
+            // Encoded once, whoever wants this sample gets the same bytes
+            size_t len = 0;
+            for (auto &c: clients) {
+                if (!c.active || tail % c.decimation != 0) {
+                    continue;
+                }
+                if (len == 0) {
+                    len = encode(sample, frame);
+                }
+                send_frame(c, frame, len);
+            }
+        }
+        xSemaphoreGive(clients_mutex);
+        vTaskDelay(pdMS_TO_TICKS(LIVE_POLL_INTERVAL));
+    }
+}
+
+bool init() {
+    clients_mutex = xSemaphoreCreateMutexStatic(&clients_mutex_storage);
+    TaskHandle_t handle = nullptr;
+    BaseType_t created  = xTaskCreatePinnedToCore(live_task, "live_task", 4096, nullptr, LIVE_TASK_PRIORITY, &handle,
+                                                  HTTP_TASK_CORE);
+    if (created != pdPASS || handle == nullptr) {
+        error("Failed to create live task");
+        return false;
+    }
+    return true;
+}
+
+// Value of a header line, case-insensitive name match
+static bool find_header(const char *headers, const char *name, char *value, size_t capacity) {
+    size_t name_len = strlen(name);
+    for (const char *line = headers; line && *line; line = strstr(line, "\r\n")) {
+        while (*line == '\r' || *line == '\n') line++;
+        if (strncasecmp(line, name, name_len) != 0 || line[name_len] != ':') {
+            continue;
+        }
+        const char *start = line + name_len + 1;
+        while (*start == ' ') start++;
+        const char *end = strstr(start, "\r\n");
+        size_t len      = end ? end - start : strlen(start);
+        if (len >= capacity) {
+            return false;
+        }
+        memcpy(value, start, len);
+        value[len] = '\0';
+        return true;
+    }
+    return false;
+}
+
+// Comma-separated header value holds token, case-insensitive ("keep-alive, Upgrade")
+static bool has_token(const char *value, const char *token) {
+    size_t token_len = strlen(token);
+    while (*value) {
+        while (*value == ' ' || *value == ',') value++;
+        const char *end = value;
+        while (*end && *end != ' ' && *end != ',') end++;
+        if (static_cast<size_t>(end - value) == token_len && strncasecmp(value, token, token_len) == 0) {
+            return true;
+        }
+        value = end;
+    }
+    return false;
+}
+
+int upgrade(WiFiClient &client, const char *headers, const char *query) {
+    char key[64];
+    char upgrade_to[32];
+    char connection[64];
+    if (!find_header(headers, "Upgrade", upgrade_to, sizeof(upgrade_to)) || strcasecmp(upgrade_to, "websocket") != 0 ||
+        !find_header(headers, "Connection", connection, sizeof(connection)) || !has_token(connection, "Upgrade") ||
+        !find_header(headers, "Sec-WebSocket-Key", key, sizeof(key))) {
+        return 400;
+    }
+    if (clients_mutex == nullptr) {
+        return 503;
+    }
+
+    // Accept key: base64(SHA-1(key + GUID))
+    char input[sizeof(key) + 36];
+    snprintf(input, sizeof(input), "%s%s", key, WS_GUID);
+    uint8_t digest[20];
+#if MBEDTLS_VERSION_MAJOR >= 3
+    mbedtls_sha1(reinterpret_cast<const uint8_t *>(input), strlen(input), digest);
+#else
+    mbedtls_sha1_ret(reinterpret_cast<const uint8_t *>(input), strlen(input), digest);
+#endif
+    uint8_t accept[32];
+    size_t accept_len = 0;
+    mbedtls_base64_encode(accept, sizeof(accept), &accept_len, digest, sizeof(digest));
+
+    const char *rate = strstr(query, "rate=");
+    bool accepted    = false;
+    xSemaphoreTake(clients_mutex, portMAX_DELAY);
+    for (auto &c: clients) {
+        if (c.active) {
+            continue;
+        }
+        char response[160];
+        int n = snprintf(response, sizeof(response),
+                         "HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                         "Sec-WebSocket-Accept: %.*s\r\n\r\n",
+                         static_cast<int>(accept_len), accept);
+        if (client.write(reinterpret_cast<const uint8_t *>(response), n) != static_cast<size_t>(n)) {
+            break;
+        }
+        c.client      = client;
+        c.decimation  = decimation_for(rate ? atoi(rate + 5) : LIVE_DEFAULT_RATE);
+        c.pending_len = 0;
+        c.rx_len      = 0;
+        c.active      = true;
+        client_count++;
+        accepted = true;
+        debugf("Live client %s at %d Hz", client.remoteIP().toString().c_str(), LIVE_MAX_RATE / c.decimation);
+        break;
+    }
+    xSemaphoreGive(clients_mutex);
+    return accepted ? 101 : 503;
+}
+
+Stats get_stats() {
+    Stats copy   = stats;
+    copy.clients = client_count.load();
+    return copy;
+}
+} // namespace live
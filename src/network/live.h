@@ -0,0 +1,51 @@
+#ifndef LIVE_H
+#define LIVE_H
+
+#include <Arduino.h>
+#include <WiFiClient.h>
+
+// Live steering state over WebSocket (/ws). The control loop samples into a shared ring at
+// LIVE_MAX_RATE; a sender task encodes each sample once and hands it to every client whose
+// rate wants it. Clients that cannot keep up lose samples, the producer never waits.
+namespace live {
+
+struct Sample {
+    uint32_t time_ms;
+    float setPoint;
+    float actual;
+    float heading;
+    float roll;
+    uint8_t pwm;
+    uint8_t switches; // SWITCH_* bits
+    uint16_t guidanceAge_ms;
+};
+
+constexpr uint8_t SWITCH_STEER   = 0x01;
+constexpr uint8_t SWITCH_WORK    = 0x02;
+constexpr uint8_t SWITCH_ENABLED = 0x04;
+
+struct Stats {
+    uint32_t samples; // Written by the producer
+    uint32_t frames;  // Frames sent, all clients
+    uint32_t dropped; // Frames a client missed because its socket was full
+    uint32_t ring_overruns;
+    uint8_t clients;
+};
+
+bool init();
+
+// True while a client is connected, the producer skips sampling otherwise
+bool is_active();
+
+// Called every control cycle, keeps one sample per 1/LIVE_MAX_RATE
+void record(const Sample &sample, uint32_t now_us);
+
+// Complete a WebSocket handshake for an HTTP request on /ws. Returns 101 when the client was
+// taken over, otherwise the status to answer with: 400 for a malformed handshake, 503 when full.
+// query may hold rate=<Hz>.
+int upgrade(WiFiClient &client, const char *headers, const char *query);
+
+Stats get_stats();
+} // namespace live
+
+#endif //LIVE_H
@@ -0,0 +1,55 @@
+#ifndef LIVE_PAGE_H
+#define LIVE_PAGE_H
+
+// Live plot for the /ws stream, served from flash by /live
+static const char LIVE_PAGE[] = R"HTML(<!DOCTYPE html>
+<html><head><meta charset="utf-8"><meta name="viewport" content="width=device-width">
+<title>Steer live</title>
+<style>
+body{font:14px sans-serif;margin:8px;background:#111;color:#ddd}
+canvas{width:100%;height:60vh;background:#000}
+#v span{display:inline-block;min-width:9em}
+.sp{color:#4af}.a{color:#fa4}.pwm{color:#6c6}
+</style></head><body>
+<div>Rate <select id="rate"><option>10</option><option>20</option><option selected>50</option>
+<option>100</option><option>200</option></select> Hz, window <select id="win"><option>5</option>
+<option selected>10</option><option>30</option></select> s <span id="st">connecting</span></div>
+<canvas id="c"></canvas>
+<div id="v"><span class="sp" id="sp"></span><span class="a" id="a"></span><span class="pwm" id="pwm"></span>
+<span id="h"></span><span id="r"></span><span id="sw"></span><span id="age"></span></div>
+<script>
+const c=document.getElementById('c'),g=c.getContext('2d'),$=i=>document.getElementById(i);
+let d=[],ws;
+function connect(){
+ ws=new WebSocket('ws://'+location.host+'/ws?rate='+$('rate').value);
+ ws.onopen=()=>$('st').textContent='live';
+ ws.onclose=()=>{$('st').textContent='reconnecting';setTimeout(connect,1000)};
+ ws.onmessage=e=>{const s=JSON.parse(e.data);d.push(s);show(s)};
+}
+$('rate').onchange=()=>{if(ws.readyState==1)ws.send('rate '+$('rate').value)};
+function show(s){
+ $('sp').textContent='set '+s.sp.toFixed(2)+'°';$('a').textContent='actual '+s.a.toFixed(2)+'°';
+ $('pwm').textContent='pwm '+s.pwm;$('h').textContent='heading '+s.h.toFixed(1)+'°';
+ $('r').textContent='roll '+s.r.toFixed(1)+'°';
+ $('sw').textContent=(s.sw&4?'ENGAGED':'off')+(s.sw&1?' steer':'')+(s.sw&2?' work':'');
+ $('age').textContent='guidance '+s.age+' ms';
+}
+function draw(){
+ const w=c.width=c.clientWidth,h=c.height=c.clientHeight,span=$('win').value*1000;
+ if(d.length){
+  const t1=d[d.length-1].t,t0=t1-span;d=d.filter(s=>s.t>=t0);
+  let m=5;for(const s of d)m=Math.max(m,Math.abs(s.sp),Math.abs(s.a));
+  const x=t=>(t-t0)/span*w,y=v=>h/2-v/m*h*0.45,yp=p=>h-p/255*h*0.3;
+  g.strokeStyle='#333';g.beginPath();g.moveTo(0,h/2);g.lineTo(w,h/2);g.stroke();
+  g.fillStyle='#888';g.fillText('±'+m.toFixed(1)+'°',4,12);
+  for(const [k,col,f] of [['pwm','#6c6',yp],['sp','#4af',y],['a','#fa4',y]]){
+   g.strokeStyle=col;g.beginPath();d.forEach((s,i)=>i?g.lineTo(x(s.t),f(s[k])):g.moveTo(x(s.t),f(s[k])));g.stroke();
+  }
+ }
+ requestAnimationFrame(draw);
+}
+connect();draw();
+</script></body></html>
+)HTML";
+
+#endif //LIVE_PAGE_H
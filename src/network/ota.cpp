@@ -0,0 +1,343 @@
+#include "ota.h"
+
+#include <Preferences.h>
+#include <WiFiServer.h>
+#include <esp_ota_ops.h>
+#include <esp_random.h>
+#include <mbedtls/md.h>
+#include <mbedtls/sha256.h>
+#include <mbedtls/version.h>
+
+#include "config/defines.h"
+#include "autosteer/autosteer.h"
+#include "autosteer/imu.h"
+#include "autosteer/was.h"
+#include "utils/log.h"
+#include "ethernet.h"
+
+namespace ota {
+
+static WiFiServer server(OTA_PORT);
+static uint8_t chunk[OTA_CHUNK_SIZE];
+
+static volatile State state      = State::idle;
+static volatile uint32_t received = 0;
+static uint32_t image_size       = 0;
+static const char *last_error    = "";
+
+// Boot bookkeeping in NVS: a pending image, its boot count and where to roll back to
+static bool pending          = false;
+static uint8_t boot_attempts = 0;
+static bool rolled_back      = false;
+static bool need_imu         = true; // The previous image had an IMU, the new one has to find it too
+static uint32_t boot_ms      = 0;
+
+static void store_pending(bool pending_, const char *previous, uint8_t attempts) {
+    Preferences prefs;
+    if (!prefs.begin("ota", false)) {
+        return;
+    }
+    prefs.putBool("pending", pending_);
+    prefs.putUChar("attempts", attempts);
+    if (previous) {
+        prefs.putString("previous", previous);
+        prefs.putBool("need_imu", imu::is_available());
+    }
+    prefs.end();
+}
+
+static void store_rolled_back(bool value) {
+    Preferences prefs;
+    if (prefs.begin("ota", false)) {
+        prefs.putBool("rolled_back", value);
+        prefs.end();
+    }
+}
+
+[[noreturn]] static void roll_back(const char *reason) {
+    errorf("OTA image failed (%s), rolling back", reason);
+    Preferences prefs;
+    char previous[17] = "";
+    if (prefs.begin("ota", true)) {
+        prefs.getString("previous", previous, sizeof(previous));
+        prefs.end();
+    }
+    const esp_partition_t *partition =
+            esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_ANY, previous);
+    bool restored = partition != nullptr && esp_ota_set_boot_partition(partition) == ESP_OK;
+    if (!restored) {
+        error("OTA rollback partition not bootable, keeping the new image");
+    }
+    store_pending(false, nullptr, 0);
+    store_rolled_back(restored);
+    delay(500);
+    esp_restart();
+    for (;;) {}
+}
+
+static void sha256(mbedtls_sha256_context &ctx, const uint8_t *data, size_t len) {
+#if MBEDTLS_VERSION_MAJOR >= 3
+    mbedtls_sha256_update(&ctx, data, len);
+#else
+    mbedtls_sha256_update_ret(&ctx, data, len);
+#endif
+}
+
+static bool fail(WiFiClient &client, const char *reason) {
+    last_error = reason;
+    state      = State::failed;
+    client.printf("ERROR %s\n", reason);
+    // A running image that has not passed its own checks yet stays inhibited
+    autosteer::setInhibited(pending);
+    errorf("OTA failed: %s", reason);
+    return false;
+}
+
+static bool parse_hex(const char *hex, uint8_t *out, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        unsigned byte;
+        if (sscanf(hex + 2 * i, "%2x", &byte) != 1) {
+            return false;
+        }
+        out[i] = byte;
+    }
+    return true;
+}
+
+// HMAC-SHA256 with OTA_SECRET over "<challenge> <size> <sha256 hex>"
+static bool authenticate(const char *challenge, unsigned size, const char *hex, const uint8_t *mac) {
+    char message[112];
+    int len = snprintf(message, sizeof(message), "%s %u %s", challenge, size, hex);
+    uint8_t expected[32];
+    const mbedtls_md_info_t *info = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    if (info == nullptr || mbedtls_md_hmac(info, reinterpret_cast<const uint8_t *>(OTA_SECRET), strlen(OTA_SECRET),
+                                           reinterpret_cast<const uint8_t *>(message), len, expected) != 0) {
+        return false;
+    }
+    // Constant time, a mismatch must not tell how many bytes were right
+    uint8_t diff = 0;
+    for (size_t i = 0; i < sizeof(expected); i++) {
+        diff |= expected[i] ^ mac[i];
+    }
+    return diff == 0;
+}
+
+static bool receive(WiFiClient &client) {
+    // Fresh challenge per connection, a recorded upload cannot be replayed
+    uint8_t nonce[16];
+    esp_fill_random(nonce, sizeof(nonce));
+    char challenge[2 * sizeof(nonce) + 1];
+    for (size_t i = 0; i < sizeof(nonce); i++) {
+        snprintf(challenge + 2 * i, 3, "%02x", nonce[i]);
+    }
+    client.printf("CHALLENGE %s\n", challenge);
+
+    char header[192];
+    size_t n  = client.readBytesUntil('\n', header, sizeof(header) - 1);
+    header[n] = '\0';
+    unsigned size    = 0;
+    char hex[65]     = "";
+    char mac_hex[65] = "";
+    uint8_t expected[32];
+    uint8_t mac[32];
+    if (sscanf(header, "OTA %u %64s %64s", &size, hex, mac_hex) != 3 || strlen(hex) != 64 ||
+        !parse_hex(hex, expected, 32) || strlen(mac_hex) != 64 || !parse_hex(mac_hex, mac, 32)) {
+        return fail(client, "bad header");
+    }
+    // Before anything is erased or steering is touched
+    if (!authenticate(challenge, size, hex, mac)) {
+        return fail(client, "not authorized");
+    }
+
+    const esp_partition_t *target = esp_ota_get_next_update_partition(nullptr);
+    if (target == nullptr || size == 0 || size > target->size) {
+        return fail(client, "image does not fit");
+    }
+
+    // Steering stays off from here until the new image has booted or the update failed
+    autosteer::setInhibited(true);
+    state      = State::receiving;
+    received   = 0;
+    image_size = size;
+    infof("OTA: %u bytes into %s", size, target->label);
+
+    esp_ota_handle_t handle = 0;
+#ifdef OTA_WITH_SEQUENTIAL_WRITES
+    // Erase sector by sector as data arrives instead of the whole image up front
+    esp_err_t err = esp_ota_begin(target, OTA_WITH_SEQUENTIAL_WRITES, &handle);
+#else
+    esp_err_t err = esp_ota_begin(target, size, &handle);
+#endif
+    if (err != ESP_OK) {
+        return fail(client, "begin failed");
+    }
+    client.print("READY\n");
+
+    mbedtls_sha256_context ctx;
+    mbedtls_sha256_init(&ctx);
+#if MBEDTLS_VERSION_MAJOR >= 3
+    mbedtls_sha256_starts(&ctx, 0);
+#else
+    mbedtls_sha256_starts_ret(&ctx, 0);
+#endif
+
+    uint32_t next_ack  = OTA_ACK_INTERVAL;
+    uint32_t last_data = millis();
+    while (received < size) {
+        size_t want = min(static_cast<size_t>(size - received), sizeof(chunk));
+        size_t fill = 0;
+        while (fill < want && client.connected() && millis() - last_data < OTA_IDLE_TIMEOUT) {
+            int got = client.read(chunk + fill, want - fill);
+            if (got > 0) {
+                fill += got;
+                last_data = millis();
+            } else {
+                vTaskDelay(pdMS_TO_TICKS(1));
+            }
+        }
+        if (fill < want) {
+            esp_ota_abort(handle);
+            mbedtls_sha256_free(&ctx);
+            return fail(client, "connection lost");
+        }
+        if (esp_ota_write(handle, chunk, fill) != ESP_OK) {
+            esp_ota_abort(handle);
+            mbedtls_sha256_free(&ctx);
+            return fail(client, "flash write failed");
+        }
+        sha256(ctx, chunk, fill);
+        received += fill;
+        if (received >= next_ack || received == size) {
+            client.printf("PROGRESS %u\n", received);
+            next_ack += OTA_ACK_INTERVAL;
+        }
+        // Flash writes stall both caches, give the control tasks a full tick between chunks
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+
+    uint8_t digest[32];
+#if MBEDTLS_VERSION_MAJOR >= 3
+    mbedtls_sha256_finish(&ctx, digest);
+#else
+    mbedtls_sha256_finish_ret(&ctx, digest);
+#endif
+    mbedtls_sha256_free(&ctx);
+    if (memcmp(digest, expected, sizeof(digest)) != 0) {
+        esp_ota_abort(handle);
+        return fail(client, "sha256 mismatch");
+    }
+    if (esp_ota_end(handle) != ESP_OK) {
+        return fail(client, "image invalid");
+    }
+    if (esp_ota_set_boot_partition(target) != ESP_OK) {
+        return fail(client, "set boot partition failed");
+    }
+
+    store_pending(true, esp_ota_get_running_partition()->label, 0);
+    store_rolled_back(false);
+    state = State::rebooting;
+    client.print("OK\n");
+    client.flush();
+    infof("OTA: image verified, rebooting into %s", target->label);
+    return true;
+}
+
+[[noreturn]] static void ota_task(void *pv_parameters) {
+    bool listening = false;
+    for (;;) {
+        if (!listening && networkReady() && OTA_SECRET[0] != '\0') {
+            server.begin();
+            listening = true;
+            debugf("OTA updates on port %d", OTA_PORT);
+        }
+        WiFiClient client = listening ? server.available() : WiFiClient();
+        if (client) {
+            client.setTimeout(OTA_IDLE_TIMEOUT / 1000);
+            if (receive(client)) {
+                delay(500);
+                client.stop();
+                esp_restart();
+            }
+            client.stop();
+        }
+        vTaskDelay(pdMS_TO_TICKS(100));
+    }
+}
+
+void count_boot() {
+    boot_ms = millis();
+    Preferences prefs;
+    if (prefs.begin("ota", true)) {
+        pending       = prefs.getBool("pending", false);
+        boot_attempts = prefs.getUChar("attempts", 0);
+        rolled_back   = prefs.getBool("rolled_back", false);
+        need_imu      = prefs.getBool("need_imu", true);
+        prefs.end();
+    }
+    if (pending) {
+        // Counted before any driver starts, so a crash or hang in init also ends in a rollback
+        boot_attempts++;
+        store_pending(true, nullptr, boot_attempts);
+        if (boot_attempts > OTA_BOOT_ATTEMPTS) {
+            roll_back("too many boots");
+        }
+        // Steering waits for the checks
+        autosteer::setInhibited(true);
+    }
+}
+
+bool init() {
+    if (pending) {
+        infof("OTA: new image, boot %u of %u", boot_attempts, OTA_BOOT_ATTEMPTS);
+    }
+    if (OTA_SECRET[0] == '\0') {
+        warning("OTA: no OTA_SECRET set, network updates disabled");
+    }
+
+    TaskHandle_t handle = nullptr;
+    BaseType_t created  = xTaskCreatePinnedToCore(ota_task, "ota_task", 6144, nullptr, OTA_TASK_PRIORITY, &handle,
+                                                  HTTP_TASK_CORE);
+    if (created != pdPASS || handle == nullptr) {
+        error("Failed to create OTA task");
+        return false;
+    }
+    return true;
+}
+
+void handler() {
+    if (!pending) {
+        return;
+    }
+    bool was_ok     = was::is_available() && was::get_timestamp() != 0;
+    bool imu_ok     = !need_imu || imu::is_available();
+    bool network_ok = networkReady();
+    if (was_ok && imu_ok && network_ok) {
+        pending = false;
+        store_pending(false, nullptr, 0);
+        esp_ota_mark_app_valid_cancel_rollback(); // Only matters with bootloader rollback enabled
+        autosteer::setInhibited(false);
+        infof("OTA: new image healthy after %u ms", millis() - boot_ms);
+        return;
+    }
+    if (millis() - boot_ms > OTA_HEALTH_TIMEOUT) {
+        roll_back(!was_ok ? "WAS" : !imu_ok ? "IMU" : "network");
+    }
+}
+
+bool in_progress() {
+    return state == State::receiving || state == State::rebooting;
+}
+
+Status get_status() {
+    Status status;
+    status.state         = state;
+    status.received      = received;
+    status.size          = image_size;
+    status.pending       = pending;
+    status.boot_attempts = boot_attempts;
+    status.rolled_back   = rolled_back;
+    status.running       = esp_ota_get_running_partition()->label;
+    status.error         = last_error;
+    return status;
+}
+} // namespace ota
@@ -0,0 +1,52 @@
+#ifndef OTA_H
+#define OTA_H
+
+#include <Arduino.h>
+
+// Firmware update over Ethernet. tools/ota_push.py streams the image over TCP into the
+// inactive OTA partition; a new image has to pass its boot health checks (WAS, IMU,
+// network) within OTA_HEALTH_TIMEOUT or the previous image is booted again.
+//
+// Protocol on OTA_PORT, one update per connection:
+//   device: "CHALLENGE <32 hex digits>\n"
+//   host:   "OTA <size> <sha256 hex> <hmac hex>\n", then <size> image bytes. The HMAC-SHA256
+//           with OTA_SECRET covers "<challenge> <size> <sha256 hex>", and the image has to
+//           match that SHA-256, so only holders of the secret can install an image.
+//   device: "READY\n", "PROGRESS <bytes>\n" every OTA_ACK_INTERVAL bytes,
+//           then "OK\n" before rebooting, or "ERROR <reason>\n" at any point
+// The IMU is only part of the health checks when the image that installed the update had one.
+namespace ota {
+
+enum class State : uint8_t {
+    idle,
+    receiving,
+    failed,
+    rebooting
+};
+
+struct Status {
+    State state;
+    uint32_t received;
+    uint32_t size;
+    bool pending;          // Running image has not passed its health checks yet
+    uint8_t boot_attempts; // Boots of the pending image so far
+    bool rolled_back;      // The last update was rolled back
+    const char *running;   // Label of the running partition
+    const char *error;     // Reason of the last failure, "" if none
+};
+
+// Counts the boot of a pending image, first thing in setup() before any driver init
+void count_boot();
+
+// Starts the update server
+bool init();
+
+// Called from the main loop, judges a pending image
+void handler();
+
+bool in_progress();
+
+Status get_status();
+} // namespace ota
+
+#endif //OTA_H
@@ -1,24 +1,30 @@
 #include "udp.h"
+#include "udp_tx.h"
+#include "udp_rx.h"
 #include "../autosteer/udp_io.h"
 #include "../gps/gps_module.h"
+#include "../autosteer/telemetry.h"
 
 #include <AsyncUDP.h>
-#include <WiFi.h>
 
 #include "config/defines.h"
 #include "utils/log.h"
+#include "utils/trace.h"
+#include "utils/stress.h"
+#include "diag.h"
+#include "ethernet.h"
 #include "w6100/esp32_sc_w6100.h"
 
-AsyncUDP autosteer_udp;
-AsyncUDP gps_udp;
+udp_tx::PooledAsyncUDP autosteer_udp;
+udp_tx::PooledAsyncUDP gps_udp;
+udp_tx::PooledAsyncUDP telemetry_udp;
 
 // Function to convert IPAddress to ip_address
 ip_address ipAddressToIpAddress(const IPAddress& addr);
 
-// Get the device's IP address
+// Get the device's IP address on the W6100 interface
 ip_address getIP() {
-    IPAddress localIP = WiFi.localIP();
-    return ipAddressToIpAddress(localIP);
+    return ipAddressToIpAddress(getLocalIP());
 }
 
 // Function to convert IPAddress to ip_address
@@ -31,58 +37,95 @@ ip_address ipAddressToIpAddress(const IPAddress& addr) {
     return result;
 }
 
-// Send UDP packet to a broadcast address
-bool broadcastUDPPacket(AsyncUDP& udp, uint16_t remotePort, const uint8_t* data, size_t len) {
-    if (!udp.connected()) {
-        return false;
-    }
-    
-    // Create an AsyncUDPMessage and copy the data into it
-    AsyncUDPMessage message;
-    message.write(data, len);
-
-    // Send the message to the broadcast address
-    return udp.writeTo(data, len, ETH.broadcastIP(), remotePort) > 0;
-}
-
 // UDP packet sending function for autosteer
 static bool sendUDPPacketFromAutosteer(const uint8_t* data, size_t len) {
-    return broadcastUDPPacket(autosteer_udp, AgOpenGPS_UDP_PORT, data, len);
+    return udp_tx::send(autosteer_udp, udp_tx::Port::autosteer, AgOpenGPS_UDP_PORT, data, len);
 }
 
 // UDP packet sending function for GPS
 static bool sendUDPPacketFromGPS(const uint8_t* data, size_t len) {
-    return broadcastUDPPacket(gps_udp, AgOpenGPS_UDP_PORT, data, len);
+    return udp_tx::send(gps_udp, udp_tx::Port::gps, AgOpenGPS_UDP_PORT, data, len);
+}
+
+static bool sendTelemetryPacket(const uint8_t* data, size_t len) {
+    return udp_tx::send(telemetry_udp, udp_tx::Port::telemetry, TELEMETRY_UDP_PORT, data, len);
+}
+
+static void onAutosteerPacket(const uint8_t* data, size_t len, const IPAddress& remote) {
+    trace::record(trace::Point::packet_rx, trace::next_id());
+    stress::count_rx(stress::Port::autosteer);
+    // Convert IPAddress to ip_address for autosteer
+    ip_address sourceIP = ipAddressToIpAddress(remote);
+    if (processReceivedPacket(data, len, sourceIP)) {
+        udp_tx::learn_agio_address(remote);
+    }
+}
+
+static void onGpsPacket(const uint8_t* data, size_t len, const IPAddress& remote) {
+    stress::count_rx(stress::Port::gps);
+    // Convert IPAddress to ip_address for GPS
+    ip_address sourceIP = ipAddressToIpAddress(remote);
+    gps::process_udp_message(data, len, sourceIP);
 }
 
 bool init_autosteer_udp() {
     autosteer_udp.listen(STEER_UDP_PORT);
-    debugf("Listening for autosteer UDP on port %d", STEER_UDP_PORT);
-    initAutosteerCommunication(sendUDPPacketFromAutosteer, getIP());
+    LOGD(net, "Listening for autosteer UDP on port %d", STEER_UDP_PORT);
+    initAutosteerCommunication(sendUDPPacketFromAutosteer, getIP(), udp_tx::acquire);
     autosteer_udp.onPacket([](AsyncUDPPacket packet) {
-        // Convert IPAddress to ip_address for autosteer
-        ip_address sourceIP = ipAddressToIpAddress(packet.remoteIP());
-        processReceivedPacket(packet.data(), packet.length(), sourceIP);
+        udp_rx::dispatched(packet.data());
+        onAutosteerPacket(packet.data(), packet.length(), packet.remoteIP());
         });
-    return true;
+    return udp_rx::hook(autosteer_udp, onAutosteerPacket);
 }
 
 bool init_gps_udp() {
     gps_udp.listen(GPS_UDP_PORT);
-    debugf("Listening for GPS UDP on port %d", GPS_UDP_PORT);
-    gps::initGpsCommunication(sendUDPPacketFromGPS, getIP());
+    LOGD(net, "Listening for GPS UDP on port %d", GPS_UDP_PORT);
+    gps::initGpsCommunication(sendUDPPacketFromGPS, getIP(), udp_tx::acquire);
     gps_udp.onPacket([](AsyncUDPPacket packet) {
-            // Convert IPAddress to ip_address for GPS
-            ip_address sourceIP = ipAddressToIpAddress(packet.remoteIP());
-            gps::process_udp_message(packet.data(), packet.length(), sourceIP);
+            udp_rx::dispatched(packet.data());
+            onGpsPacket(packet.data(), packet.length(), packet.remoteIP());
         });
-    return true;
+    return udp_rx::hook(gps_udp, onGpsPacket);
+}
+
+bool init_telemetry_udp() {
+    telemetry_udp.listen(TELEMETRY_UDP_PORT);
+    LOGD(net, "Telemetry on UDP port %d", TELEMETRY_UDP_PORT);
+    return telemetry::init(sendTelemetryPacket, udp_tx::acquire);
+}
+
+// Runs in the network event task after every (re)connect
+static void onNetworkUpUDP(const IPAddress &ip) {
+    bool bound = autosteer_udp.listen(STEER_UDP_PORT);
+    bound &= gps_udp.listen(GPS_UDP_PORT);
+    bound &= telemetry_udp.listen(TELEMETRY_UDP_PORT);
+    bound &= diag::rebind();
+    bound &= udp_rx::hook(autosteer_udp, onAutosteerPacket);
+    bound &= udp_rx::hook(gps_udp, onGpsPacket);
+    if (!bound) {
+        LOGE(net, "UDP rebind after reconnect failed");
+    }
+    setDeviceIP(ipAddressToIpAddress(ip));
+    sendSubnetAnnouncement();
+    LOGD(net, "UDP sockets bound, subnet announced for %s", ip.toString().c_str());
+}
+
+static void onNetworkDownUDP() {
+    udp_tx::forget_agio_address();
 }
 
 // Initialize AsyncUDP
 bool initUDP() {
     bool success = true;
+    success &= udp_tx::init();
+    success &= udp_rx::init();
     success &= init_autosteer_udp();
     success &= init_gps_udp();
+    success &= init_telemetry_udp();
+    success &= diag::init();
+    onNetworkDown(onNetworkDownUDP);
+    onNetworkUp(onNetworkUpUDP);
     return success;
 }
@@ -0,0 +1,223 @@
+#include "udp_rx.h"
+
+#include <esp_timer.h>
+#include <freertos/queue.h>
+#include <lwip/pbuf.h>
+#include <lwip/udp.h>
+#include <lwip/priv/tcpip_priv.h>
+
+#include "config/defines.h"
+#include "utils/log.h"
+
+namespace udp_rx {
+
+struct Hook {
+    udp_pcb *pcb;
+    Handler handler;
+    udp_recv_fn next_recv; // AsyncUDP's own callback
+    void *next_arg;
+};
+
+// Fast path queue entry, the pbuf reference moves to the udp_rx task
+struct Item {
+    pbuf *p;
+    Hook *hook;
+    uint32_t address;
+    uint32_t stamp_us;
+};
+
+// AsyncUDP path: payload pointers are unique while the pbuf is alive, which pairs the
+// stamp with the delivery even when AsyncUDP drops packets in between
+struct Pending {
+    const void *payload;
+    uint32_t stamp_us;
+};
+
+constexpr size_t MAX_HOOKS    = 2;
+constexpr size_t PENDING_SIZE = 16;
+
+static Hook hooks[MAX_HOOKS];
+static size_t hook_count = 0;
+
+static Pending pending[PENDING_SIZE];
+static size_t pending_next = 0;
+
+static StaticQueue_t queue_storage;
+static uint8_t queue_buffer[UDP_RX_QUEUE_SIZE * sizeof(Item)];
+static QueueHandle_t queue = nullptr;
+
+static uint8_t rx_buffer[UDP_TX_BUFFER_SIZE]; // Chained pbufs are flattened here
+static Stats stats = {};
+static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static uint32_t now_us() {
+    return static_cast<uint32_t>(esp_timer_get_time());
+}
+
+static void record_latency(uint32_t stamp_us) {
+    uint32_t latency = now_us() - stamp_us;
+    size_t bucket    = min<size_t>(latency / LATENCY_BUCKET_US, LATENCY_BUCKETS - 1);
+    portENTER_CRITICAL(&stats_mux);
+    stats.latency_cnt++;
+    stats.latency_sum_us += latency;
+    if (latency > stats.latency_max_us) stats.latency_max_us = latency;
+    stats.latency_hist[bucket]++;
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+// Runs on the tcpip thread
+static void on_recv(void *arg, udp_pcb *pcb, pbuf *p, const ip_addr_t *addr, uint16_t port) {
+    Hook *hook     = static_cast<Hook *>(arg);
+    uint32_t stamp = now_us();
+    stats.packets++;
+
+    if (UDP_RX_FAST_PATH) {
+        Item item = {p, hook, addr ? ip_2_ip4(addr)->addr : 0, stamp};
+        if (xQueueSend(queue, &item, 0) != pdTRUE) {
+            stats.dropped++;
+            pbuf_free(p);
+        }
+        return;
+    }
+
+    portENTER_CRITICAL(&stats_mux);
+    pending[pending_next] = {p->payload, stamp};
+    pending_next = (pending_next + 1) % PENDING_SIZE;
+    portEXIT_CRITICAL(&stats_mux);
+    if (hook->next_recv == nullptr) {
+        pbuf_free(p);
+        return;
+    }
+    hook->next_recv(hook->next_arg, pcb, p, addr, port);
+}
+
+[[noreturn]] static void rx_task(void *pv_parameters) {
+    Item item;
+    for (;;) {
+        if (xQueueReceive(queue, &item, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        record_latency(item.stamp_us);
+        pbuf *p = item.p;
+        const uint8_t *data = static_cast<const uint8_t *>(p->payload);
+        size_t len          = p->len;
+        if (p->next != nullptr) {
+            len  = pbuf_copy_partial(p, rx_buffer, min<size_t>(p->tot_len, sizeof(rx_buffer)), 0);
+            data = rx_buffer;
+        }
+        item.hook->handler(data, len, IPAddress(item.address));
+        pbuf_free(p);
+    }
+}
+
+bool init() {
+    if (!UDP_RX_FAST_PATH || queue != nullptr) {
+        return true;
+    }
+    queue = xQueueCreateStatic(UDP_RX_QUEUE_SIZE, sizeof(Item), queue_buffer, &queue_storage);
+    TaskHandle_t handle = nullptr;
+    if (xTaskCreate(rx_task, "udp_rx", 4096, nullptr, UDP_RX_TASK_PRIORITY, &handle) != pdPASS) {
+        LOGE(net, "Failed to create UDP RX task");
+        return false;
+    }
+    LOGD(net, "UDP RX fast path, queue %d", UDP_RX_QUEUE_SIZE);
+    return true;
+}
+
+// The pcb callback is swapped on the tcpip thread
+struct HookCall {
+    struct tcpip_api_call_data call;
+    Hook *hook;
+};
+
+static err_t hook_on_tcpip(struct tcpip_api_call_data *data) {
+    Hook *hook = reinterpret_cast<HookCall *>(data)->hook;
+    // A repeated hook keeps the original AsyncUDP callback instead of chaining to itself
+    if (hook->pcb->recv != on_recv) {
+        hook->next_recv = hook->pcb->recv;
+        hook->next_arg  = hook->pcb->recv_arg;
+    }
+    udp_recv(hook->pcb, on_recv, hook);
+    return ERR_OK;
+}
+
+bool hook(udp_tx::PooledAsyncUDP &udp, Handler handler) {
+    if (!udp.pcb()) {
+        return false;
+    }
+    Hook *hook = nullptr;
+    for (size_t i = 0; i < hook_count; i++) {
+        if (hooks[i].pcb == udp.pcb()) {
+            hook = &hooks[i];
+        }
+    }
+    if (hook == nullptr) {
+        if (hook_count == MAX_HOOKS) {
+            LOGE(net, "UDP RX hook table full");
+            return false;
+        }
+        hook = &hooks[hook_count++];
+        *hook = {udp.pcb(), handler, nullptr, nullptr};
+    }
+    HookCall msg;
+    msg.hook = hook;
+    tcpip_api_call(hook_on_tcpip, reinterpret_cast<struct tcpip_api_call_data *>(&msg));
+    return UDP_RX_FAST_PATH || hook->next_recv != nullptr;
+}
+
+void dispatched(const uint8_t *data) {
+    uint32_t stamp = 0;
+    bool found     = false;
+    portENTER_CRITICAL(&stats_mux);
+    for (auto &entry: pending) {
+        if (entry.payload == data) {
+            stamp         = entry.stamp_us;
+            entry.payload = nullptr;
+            found         = true;
+            break;
+        }
+    }
+    if (!found) stats.unmatched++;
+    portEXIT_CRITICAL(&stats_mux);
+    if (found) {
+        record_latency(stamp);
+    }
+}
+
+bool fast_path() {
+    return UDP_RX_FAST_PATH;
+}
+
+Stats get_stats() {
+    portENTER_CRITICAL(&stats_mux);
+    Stats copy = stats;
+    portEXIT_CRITICAL(&stats_mux);
+    return copy;
+}
+
+uint32_t latency_percentile(const Stats &stats, float fraction) {
+    uint32_t target = static_cast<uint32_t>(stats.latency_cnt * fraction);
+    uint32_t seen   = 0;
+    for (size_t i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += stats.latency_hist[i];
+        if (seen > target) {
+            return (i + 1) * LATENCY_BUCKET_US;
+        }
+    }
+    return stats.latency_max_us;
+}
+
+void reset_stats() {
+    portENTER_CRITICAL(&stats_mux);
+    stats = {};
+    portEXIT_CRITICAL(&stats_mux);
+}
+
+void print_stats() {
+    Stats s = get_stats();
+    LOGD(net, "UDP RX %s: packets=%u dropped=%u unmatched=%u latency mean=%uus p99=%uus max=%uus",
+           UDP_RX_FAST_PATH ? "fast path" : "AsyncUDP", s.packets, s.dropped, s.unmatched,
+           s.latency_cnt ? static_cast<uint32_t>(s.latency_sum_us / s.latency_cnt) : 0,
+           latency_percentile(s, 0.99f), s.latency_max_us);
+}
+} // namespace udp_rx
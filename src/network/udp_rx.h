@@ -0,0 +1,47 @@
+#ifndef UDP_RX_H
+#define UDP_RX_H
+
+#include <Arduino.h>
+
+#include "udp_tx.h"
+
+// Receive path for the steer (8888) and correction (2233) sockets. Every datagram is stamped
+// on the lwIP tcpip thread as it leaves the stack. By default it then continues through
+// AsyncUDP's event queue and task to the onPacket handler. With UDP_RX_FAST_PATH it is
+// queued, without allocation, to a dedicated task that calls the handler directly. The
+// stamp-to-handler latency is measured on both paths so the builds can be compared.
+namespace udp_rx {
+
+using Handler = void (*)(const uint8_t *data, size_t len, const IPAddress &remote);
+
+constexpr size_t LATENCY_BUCKETS     = 40;
+constexpr uint32_t LATENCY_BUCKET_US = 25; // Last bucket collects everything above
+
+struct Stats {
+    uint32_t packets;        // Datagrams stamped on the tcpip thread
+    uint32_t dropped;        // Fast path queue full
+    uint32_t unmatched;      // AsyncUDP deliveries without a stamp
+    uint32_t latency_cnt;
+    uint32_t latency_max_us;
+    uint64_t latency_sum_us;
+    uint32_t latency_hist[LATENCY_BUCKETS];
+};
+
+bool init();
+
+// Hook a listening socket; call again after every listen(). With the fast path the handler
+// runs on the udp_rx task, otherwise the socket's onPacket handler has to call dispatched().
+bool hook(udp_tx::PooledAsyncUDP &udp, Handler handler);
+
+// AsyncUDP path: the datagram whose payload starts at data reached its handler
+void dispatched(const uint8_t *data);
+
+bool fast_path();
+
+Stats get_stats();
+uint32_t latency_percentile(const Stats &stats, float fraction);
+void reset_stats();
+void print_stats();
+} // namespace udp_rx
+
+#endif //UDP_RX_H
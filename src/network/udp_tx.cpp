@@ -0,0 +1,196 @@
+#include "udp_tx.h"
+
+#include <lwip/pbuf.h>
+#include <lwip/udp.h>
+#include <lwip/priv/tcpip_priv.h>
+
+#include "config/defines.h"
+#include "utils/log.h"
+#include "w6100/esp32_sc_w6100.h"
+
+namespace udp_tx {
+
+struct Slot {
+    pbuf *p;
+    void *base; // Payload pointer at allocation, lwIP leaves it moved onto the headers after a send
+    bool claimed;
+};
+
+static Slot pool[UDP_TX_POOL_SIZE];
+static portMUX_TYPE pool_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool initialized = false;
+static Stats stats = {};
+
+// Written by the receive task, read by every sender; guarded by pool_mux
+static uint32_t agio_address   = 0;
+static uint32_t agio_last_seen = 0;
+
+// lwIP calls have to run on the tcpip thread
+struct SendCall {
+    struct tcpip_api_call_data call;
+    udp_pcb *pcb;
+    pbuf *p;
+    const ip_addr_t *addr;
+    uint16_t port;
+    err_t err;
+};
+
+static err_t send_on_tcpip(struct tcpip_api_call_data *data) {
+    SendCall *msg = reinterpret_cast<SendCall *>(data);
+    msg->err      = udp_sendto(msg->pcb, msg->p, msg->addr, msg->port);
+    return msg->err;
+}
+
+bool init() {
+    if (initialized) return true;
+    for (auto &slot: pool) {
+        slot.p = pbuf_alloc(PBUF_TRANSPORT, UDP_TX_BUFFER_SIZE, PBUF_RAM);
+        if (!slot.p) {
+            LOGE(net, "UDP TX pool allocation failed");
+            return false;
+        }
+        slot.base    = slot.p->payload;
+        slot.claimed = false;
+    }
+    initialized = true;
+    LOGD(net, "UDP TX pool: %d x %d bytes", UDP_TX_POOL_SIZE, UDP_TX_BUFFER_SIZE);
+    return true;
+}
+
+uint8_t *acquire(size_t len) {
+    if (!initialized || len > UDP_TX_BUFFER_SIZE) {
+        return nullptr;
+    }
+    uint8_t *buf = nullptr;
+    portENTER_CRITICAL(&pool_mux);
+    for (auto &slot: pool) {
+        // ref > 1 means the stack still holds the pbuf from a previous send
+        if (!slot.claimed && slot.p->ref == 1) {
+            slot.claimed = true;
+            buf          = static_cast<uint8_t *>(slot.base);
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&pool_mux);
+    return buf;
+}
+
+static Slot *find_slot(const uint8_t *data) {
+    for (auto &slot: pool) {
+        if (slot.claimed && slot.base == data) {
+            return &slot;
+        }
+    }
+    return nullptr;
+}
+
+static void release(Slot *slot) {
+    portENTER_CRITICAL(&pool_mux);
+    slot->claimed = false;
+    portEXIT_CRITICAL(&pool_mux);
+}
+
+void learn_agio_address(const IPAddress &address) {
+    uint32_t now = millis();
+    portENTER_CRITICAL(&pool_mux);
+    agio_address   = static_cast<uint32_t>(address);
+    agio_last_seen = now;
+    portEXIT_CRITICAL(&pool_mux);
+}
+
+void forget_agio_address() {
+    portENTER_CRITICAL(&pool_mux);
+    agio_last_seen = 0;
+    portEXIT_CRITICAL(&pool_mux);
+}
+
+IPAddress get_destination() {
+    portENTER_CRITICAL(&pool_mux);
+    uint32_t address   = agio_address;
+    uint32_t last_seen = agio_last_seen;
+    portEXIT_CRITICAL(&pool_mux);
+    uint32_t now = millis(); // After the copy, so a concurrent learn cannot be ahead of now
+    if (UDP_UNICAST_TO_AGIO && last_seen != 0 && now - last_seen < AGIO_ADDRESS_TIMEOUT) {
+        return IPAddress(address);
+    }
+    return ETH.broadcastIP();
+}
+
+static void record_error(PortStats &port_stats, err_t err) {
+    port_stats.errors++;
+    int index = -err;
+    if (index >= 0 && index < static_cast<int>(ERR_HISTOGRAM_SIZE)) {
+        stats.err_histogram[index]++;
+    }
+}
+
+bool send(PooledAsyncUDP &udp, Port port, uint16_t remotePort, const uint8_t *data, size_t len) {
+    PortStats &port_stats = stats.ports[static_cast<size_t>(port)];
+
+    Slot *slot = find_slot(data);
+    if (len == 0) {
+        if (slot) release(slot);
+        return false;
+    }
+    if (!slot) {
+        // Caller built the packet elsewhere, copy it once into a pool buffer
+        uint8_t *buf = acquire(len);
+        if (!buf) {
+            port_stats.pool_empty++;
+            return false;
+        }
+        memcpy(buf, data, len);
+        slot = find_slot(buf);
+        port_stats.copied++;
+    }
+
+    if (!udp.connected() || !udp.pcb()) {
+        release(slot);
+        return false;
+    }
+
+    IPAddress destination = port == Port::log ? ETH.broadcastIP() : get_destination();
+    ip_addr_t addr;
+    addr.type            = IPADDR_TYPE_V4;
+    addr.u_addr.ip4.addr = static_cast<uint32_t>(destination);
+
+    slot->p->payload = slot->base;
+    slot->p->len     = len;
+    slot->p->tot_len = len;
+
+    SendCall msg;
+    msg.pcb  = udp.pcb();
+    msg.p    = slot->p;
+    msg.addr = &addr;
+    msg.port = remotePort;
+    msg.err  = ERR_OK;
+    tcpip_api_call(send_on_tcpip, reinterpret_cast<struct tcpip_api_call_data *>(&msg));
+    release(slot);
+
+    if (msg.err != ERR_OK) {
+        record_error(port_stats, msg.err);
+        return false;
+    }
+    port_stats.packets++;
+    port_stats.bytes += len;
+    return true;
+}
+
+const Stats &get_stats() {
+    return stats;
+}
+
+void print_stats() {
+    const char *names[] = {"autosteer", "gps", "telemetry", "log"};
+    uint32_t errors = 0;
+    for (size_t i = 0; i < static_cast<size_t>(Port::count); i++) {
+        const PortStats &s = stats.ports[i];
+        LOGD(net, "UDP TX %s: packets=%u bytes=%u errors=%u pool_empty=%u copied=%u",
+               names[i], s.packets, s.bytes, s.errors, s.pool_empty, s.copied);
+        errors += s.errors;
+    }
+    LOGD(net, "UDP TX errors: ERR_MEM=%u ERR_BUF=%u ERR_RTE=%u other=%u",
+           stats.err_histogram[-ERR_MEM], stats.err_histogram[-ERR_BUF], stats.err_histogram[-ERR_RTE],
+           errors - stats.err_histogram[-ERR_MEM] - stats.err_histogram[-ERR_BUF] - stats.err_histogram[-ERR_RTE]);
+}
+} // namespace udp_tx
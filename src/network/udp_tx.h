@@ -0,0 +1,60 @@
+#ifndef UDP_TX_H
+#define UDP_TX_H
+
+#include <Arduino.h>
+#include <AsyncUDP.h>
+
+// Preallocated UDP transmit path. Packet builders write straight into pooled
+// lwIP pbufs which are handed to the stack without an intermediate copy.
+namespace udp_tx {
+
+enum class Port : uint8_t {
+    autosteer = 0,
+    gps       = 1,
+    telemetry = 2,
+    log       = 3, // UDP log stream, always broadcast
+    count
+};
+
+// AsyncUDP keeps its pcb protected, the pooled path sends on it directly
+class PooledAsyncUDP : public AsyncUDP {
+public:
+    udp_pcb *pcb() const { return _pcb; }
+};
+
+struct PortStats {
+    uint32_t packets;
+    uint32_t bytes;
+    uint32_t errors;
+    uint32_t pool_empty;
+    uint32_t copied; // Sends whose data did not come from the pool
+};
+
+constexpr size_t ERR_HISTOGRAM_SIZE = 17; // lwIP err_t spans 0 (ERR_OK) to -16 (ERR_ARG)
+
+struct Stats {
+    PortStats ports[static_cast<size_t>(Port::count)];
+    uint32_t err_histogram[ERR_HISTOGRAM_SIZE]; // Indexed by -err_t, ERR_MEM (ENOMEM) is index 1
+};
+
+bool init();
+
+// Claim a pool buffer of at least len bytes, nullptr if the pool is exhausted.
+// Every acquired buffer must be passed to send(), which returns it to the pool.
+uint8_t *acquire(size_t len);
+
+// Send len bytes to remotePort. Pool buffers are sent in place, any other data is copied once.
+// len == 0 only releases a pool buffer.
+bool send(PooledAsyncUDP &udp, Port port, uint16_t remotePort, const uint8_t *data, size_t len);
+
+// Remember the AgIO address of a valid incoming packet for unicast replies
+void learn_agio_address(const IPAddress &address);
+// Fall back to broadcast until AgIO is heard again, e.g. after a link loss
+void forget_agio_address();
+IPAddress get_destination();
+
+const Stats &get_stats();
+void print_stats();
+} // namespace udp_tx
+
+#endif //UDP_TX_H
@@ -5,7 +5,19 @@
 #include "gps/gps_module.h"
 #include "hardware/was/ads1115_was.h"
 #include "hardware/imu/bno08x_imu.h"
+#include "autosteer/heading.h"
+#include "utils/stress.h"
 #include "utils/log.h"
+#include "utils/heap_guard.h"
+
+#include <esp_timer.h>
+
+// Stacks of the multi-task mode, summed for the scheduler comparison
+constexpr uint32_t WAS_STACK       = 4096;
+constexpr uint32_t IMU_STACK       = 4096;
+constexpr uint32_t BUTTONS_STACK   = 1024;
+constexpr uint32_t AUTOSTEER_STACK = 4096;
+constexpr uint32_t GPS_STACK       = 2048;
 
 [[noreturn]] void was_task(void *pv_parameters) {
     for (;;) {
@@ -17,6 +29,7 @@
 [[noreturn]] void imu_task(void *pv_parameters) {
     for (;;) {
         hw::BNO08XIMU::handler();
+        heading::update_imu(millis());
         vTaskDelay(pdMS_TO_TICKS(20)); // 50Hz update rate
     }
 }
@@ -30,6 +43,7 @@
 
 [[noreturn]] void autoSteerTask(void *pv_parameters) {
     for (;;) {
+        stress::control_tick();
         autosteer::handler();
         vTaskDelay(pdMS_TO_TICKS(1)); // 1kHz update rate
     }
@@ -43,14 +57,170 @@
 }
 
 
+// Cyclic executive: every handler runs from one task in a fixed frame table. A minor frame
+// lasts CYCLIC_FRAME_US; the major frame is the least common multiple of the job periods.
+// Slower jobs are placed at compile time on the offsets that keep the busiest frame lightest.
+struct Job {
+    const char *name;
+    void (*run)();
+    uint16_t rate_hz;
+};
+
+static void run_imu() {
+    hw::BNO08XIMU::handler();
+    heading::update_imu(millis());
+}
+
+static void run_autosteer() {
+    stress::control_tick();
+    autosteer::handler();
+}
+
+// Same rates as the tasks above
+constexpr Job jobs[] = {
+    {"autosteer", run_autosteer, 1000},
+    {"gps", gps::handler, 1000},
+    {"was", hw::ADS1115WAS::handler, 50},
+    {"imu", run_imu, 50},
+    {"buttons", buttons::handler, 10},
+};
+constexpr size_t JOB_COUNT   = sizeof(jobs) / sizeof(jobs[0]);
+constexpr uint32_t FRAME_HZ  = 1000000UL / CYCLIC_FRAME_US;
+constexpr TickType_t FRAME_TICKS = pdMS_TO_TICKS(CYCLIC_FRAME_US / 1000);
+static_assert(CYCLIC_FRAME_US % (1000000UL / configTICK_RATE_HZ) == 0, "Minor frame must be whole ticks");
+
+constexpr uint32_t gcd(uint32_t a, uint32_t b) {
+    return b == 0 ? a : gcd(b, a % b);
+}
+
+constexpr uint32_t major_frames() {
+    uint32_t frames = 1;
+    for (const auto &job: jobs) {
+        uint32_t period = FRAME_HZ / job.rate_hz;
+        frames          = frames / gcd(frames, period) * period;
+    }
+    return frames;
+}
+
+constexpr bool rates_fit() {
+    for (const auto &job: jobs) {
+        if (job.rate_hz == 0 || job.rate_hz > FRAME_HZ || FRAME_HZ % job.rate_hz != 0) return false;
+    }
+    return true;
+}
+static_assert(rates_fit(), "Every job rate must divide the minor frame rate");
+
+constexpr uint32_t MAJOR_FRAMES = major_frames();
+static_assert(MAJOR_FRAMES <= 1000, "Major frame too long for the static table");
+
+struct Schedule {
+    uint8_t count[MAJOR_FRAMES];           // Jobs in each minor frame
+    uint8_t jobs[MAJOR_FRAMES][JOB_COUNT]; // Indices into jobs[], in table order
+    uint16_t offset[JOB_COUNT];
+    uint8_t busiest;                       // Most jobs in any minor frame
+};
+
+constexpr Schedule make_schedule() {
+    Schedule schedule{};
+    for (size_t j = 0; j < JOB_COUNT; j++) {
+        uint32_t period = FRAME_HZ / jobs[j].rate_hz;
+        // Offset whose frames are least loaded so far, earliest on a tie
+        uint32_t best = 0, best_load = UINT32_MAX;
+        for (uint32_t offset = 0; offset < period; offset++) {
+            uint32_t load = 0;
+            for (uint32_t frame = offset; frame < MAJOR_FRAMES; frame += period) {
+                if (schedule.count[frame] > load) load = schedule.count[frame];
+            }
+            if (load < best_load) {
+                best      = offset;
+                best_load = load;
+            }
+        }
+        schedule.offset[j] = best;
+        for (uint32_t frame = best; frame < MAJOR_FRAMES; frame += period) {
+            schedule.jobs[frame][schedule.count[frame]++] = j;
+            if (schedule.count[frame] > schedule.busiest) schedule.busiest = schedule.count[frame];
+        }
+    }
+    return schedule;
+}
+
+constexpr Schedule schedule = make_schedule();
+
+static ScheduleStats schedule_stats = {};
+static FrameStats frame_stats[MAJOR_FRAMES];
+
+[[noreturn]] static void cyclic_task(void *pv_parameters) {
+    TickType_t wake = xTaskGetTickCount();
+    uint32_t frame  = 0;
+    for (;;) {
+        int64_t start = esp_timer_get_time();
+        for (uint8_t i = 0; i < schedule.count[frame]; i++) {
+            jobs[schedule.jobs[frame][i]].run();
+        }
+        uint32_t used = static_cast<uint32_t>(esp_timer_get_time() - start);
+
+        FrameStats &stats = frame_stats[frame];
+        stats.runs++;
+        if (used > stats.max_us) stats.max_us = used;
+        if (used > CYCLIC_FRAME_US) {
+            stats.overruns++;
+            schedule_stats.overruns++;
+        }
+        schedule_stats.frames++;
+        if (used > schedule_stats.max_frame_us) schedule_stats.max_frame_us = used;
+
+        frame = frame + 1 == MAJOR_FRAMES ? 0 : frame + 1;
+        // Behind by a whole frame: vTaskDelayUntil returns at once and the next frames run back to back
+        if (xTaskGetTickCount() - wake >= FRAME_TICKS) {
+            schedule_stats.slips++;
+        }
+        vTaskDelayUntil(&wake, FRAME_TICKS);
+    }
+}
+
+static bool create_cyclic_task() {
+    infof("Cyclic executive: %u us minor frame, %u frames per major frame, at most %u jobs per frame",
+          CYCLIC_FRAME_US, MAJOR_FRAMES, schedule.busiest);
+    for (size_t j = 0; j < JOB_COUNT; j++) {
+        debugf("  %s: %u Hz, frame %u of every %u", jobs[j].name, jobs[j].rate_hz, schedule.offset[j],
+               FRAME_HZ / jobs[j].rate_hz);
+    }
+    TaskHandle_t handle = nullptr;
+    BaseType_t created  = xTaskCreate(cyclic_task, "cyclic_task", CYCLIC_STACK_SIZE, nullptr, CYCLIC_TASK_PRIORITY,
+                                      &handle);
+    if (created != pdPASS || handle == nullptr) {
+        error("Failed to create cyclic executive task");
+        return false;
+    }
+    heap_guard::watch(handle);
+    return true;
+}
+
+ScheduleStats get_schedule_stats() {
+    ScheduleStats stats = schedule_stats;
+    stats.cyclic        = SCHEDULER_CYCLIC;
+    stats.major_frames  = MAJOR_FRAMES;
+    stats.stack_bytes   = SCHEDULER_CYCLIC ? CYCLIC_STACK_SIZE
+                                           : WAS_STACK + IMU_STACK + BUTTONS_STACK + AUTOSTEER_STACK + GPS_STACK;
+    return stats;
+}
+
+FrameStats get_frame_stats(size_t frame) {
+    return frame < MAJOR_FRAMES ? frame_stats[frame] : FrameStats{};
+}
+
 bool create_tasks() {
+    if (SCHEDULER_CYCLIC) {
+        return create_cyclic_task();
+    }
     debug("Creating tasks...");
     debug("Creating WAS task...");
     TaskHandle_t wasTaskHandle = nullptr;
     BaseType_t taskCreated = xTaskCreate(
         was_task,
-        "was_task", 
-        4096,
+        "was_task",
+        WAS_STACK,
         nullptr, 
         WAS_TASK_PRIORITY, 
         &wasTaskHandle
@@ -60,6 +230,7 @@ bool create_tasks() {
         error("Failed to create WAS task");
         return false;
     }
+    heap_guard::watch(wasTaskHandle);
 
     delay(100);
     debug("Creating IMU task...");
@@ -67,7 +238,7 @@ bool create_tasks() {
     taskCreated = xTaskCreate(
         imu_task,
         "imu_task",
-        4096,
+        IMU_STACK,
         nullptr,
         IMU_TASK_PRIORITY,
         &imuTaskHandle
@@ -77,6 +248,7 @@ bool create_tasks() {
         error("Failed to create IMU task");
         return false;
     }
+    heap_guard::watch(imuTaskHandle);
 
     delay(100);
     debug("Creating buttons task...");
@@ -84,7 +256,7 @@ bool create_tasks() {
     taskCreated = xTaskCreate(
         buttons_task,
         "buttons_task",
-        1024,
+        BUTTONS_STACK,
         nullptr,
         BUTTONS_TASK_PRIORITY,
         &buttonsTaskHandle
@@ -94,6 +266,7 @@ bool create_tasks() {
         error("Failed to create buttons task");
         return false;
     }
+    heap_guard::watch(buttonsTaskHandle);
 
     delay(100);
     debug("Creating autoSteer task...");
@@ -101,7 +274,7 @@ bool create_tasks() {
     taskCreated = xTaskCreate(
           autoSteerTask,
           "autoSteerTask",
-          4096,
+          AUTOSTEER_STACK,
           NULL,
           AUTOSTEER_TASK_PRIORITY,
           &autoSteerTaskHandle
@@ -109,18 +282,20 @@ bool create_tasks() {
     if (taskCreated != pdPASS || autoSteerTaskHandle == nullptr) {
         error("Failed to create autoSteer task");
     }
+    heap_guard::watch(autoSteerTaskHandle);
     delay(100);
     debug("Creating GPS task...");
     TaskHandle_t gpsTaskHandle = nullptr;
     taskCreated = xTaskCreate(
         gpsTask,
         "gpsTask",
-        2048,
+        GPS_STACK,
         NULL,
         GPS_TASK_PRIORITY,
         &gpsTaskHandle
     );
-    
+    heap_guard::watch(gpsTaskHandle);
+
     return true;
 }
 
@@ -12,5 +12,25 @@
 // Task creation functions
 bool create_tasks();
 
+// Cyclic executive statistics, all zero in the multi-task mode
+struct FrameStats {
+    uint32_t runs;
+    uint32_t overruns; // Jobs took longer than CYCLIC_FRAME_US
+    uint32_t max_us;
+};
+
+struct ScheduleStats {
+    bool cyclic;
+    uint32_t frames;
+    uint32_t overruns;
+    uint32_t slips;        // Frames started late because an earlier one overran
+    uint32_t max_frame_us;
+    uint32_t major_frames;
+    uint32_t stack_bytes;  // Stack reserved for the sensor and control work
+};
+
+ScheduleStats get_schedule_stats();
+FrameStats get_frame_stats(size_t frame);
+
 
 #endif // TASKS_H 
\ No newline at end of file
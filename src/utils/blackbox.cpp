@@ -0,0 +1,261 @@
+#include "blackbox.h"
+
+#include <LittleFS.h>
+#include <atomic>
+
+#include "config/defines.h"
+#include "utils/log.h"
+
+namespace blackbox {
+    constexpr size_t RECORDS_PER_BUFFER = BLACKBOX_BUFFER_SIZE / RECORD_SIZE;
+    constexpr uint32_t INTERVAL_US      = 1000000UL / BLACKBOX_RATE;
+    static_assert(RECORDS_PER_BUFFER > 0, "Black box buffer too small for one record");
+    static_assert(BLACKBOX_SEGMENT_SIZE >= HEADER_SIZE + BLACKBOX_BUFFER_SIZE, "Black box segment smaller than a buffer");
+
+    // Double buffer: the control loop fills buffers[active] while the writer appends the other
+    static uint8_t buffers[2][RECORDS_PER_BUFFER * RECORD_SIZE];
+    static uint8_t active   = 0;
+    static size_t fill      = 0;
+    static std::atomic<int8_t> pending{-1}; // Buffer handed to the writer, -1 when it is idle
+    static uint32_t last_us = 0;
+
+    static TaskHandle_t writer_handle = nullptr;
+    static File segment;
+    static size_t segment_size     = 0;
+    static uint32_t current        = 0; // Sequence of the open segment
+    static uint32_t oldest         = 0;
+    static uint32_t boot_sequence  = 0;
+    static volatile bool running   = false;
+    static Stats stats             = {};
+
+    static void put_u8(uint8_t *&p, uint8_t value) {
+        *p++ = value;
+    }
+
+    static void put_u16(uint8_t *&p, uint16_t value) {
+        *p++ = value & 0xFF;
+        *p++ = value >> 8;
+    }
+
+    static void put_u32(uint8_t *&p, uint32_t value) {
+        put_u16(p, value & 0xFFFF);
+        put_u16(p, value >> 16);
+    }
+
+    static int16_t fixed_i16(float value, float scale) {
+        float scaled = value * scale;
+        return scaled >= 32767.0f ? 32767 : scaled <= -32768.0f ? -32768 : static_cast<int16_t>(lroundf(scaled));
+    }
+
+    static uint16_t fixed_u16(float value, float scale) {
+        float scaled = value * scale;
+        return scaled >= 65535.0f ? 65535 : scaled <= 0.0f ? 0 : static_cast<uint16_t>(lroundf(scaled));
+    }
+
+    static void write_record(uint8_t *p, const Sample &s) {
+        constexpr int64_t WEEK_MS = 7LL * 24 * 3600 * 1000;
+        put_u32(p, s.time_ms);
+        put_u32(p, static_cast<uint32_t>((s.gnss_us / 1000) % WEEK_MS));
+        put_u16(p, fixed_i16(s.setPoint, 100.0f));
+        put_u16(p, fixed_i16(s.actual, 100.0f));
+        put_u16(p, fixed_u16(s.heading, 100.0f));
+        put_u16(p, fixed_i16(s.roll, 100.0f));
+        put_u16(p, fixed_i16(s.pitch, 100.0f));
+        put_u16(p, static_cast<uint16_t>(s.output));
+        put_u16(p, s.guidanceAge_ms);
+        put_u16(p, fixed_u16(s.speed, 100.0f));
+        put_u8(p, s.pwm);
+        put_u8(p, s.switches);
+        put_u8(p, s.linkState);
+        put_u8(p, 0);
+    }
+
+    static void path(uint32_t sequence, char *buf, size_t len) {
+        snprintf(buf, len, "/bb/%08u.bin", sequence);
+    }
+
+    static void delete_oldest() {
+        char name[24];
+        path(oldest, name, sizeof(name));
+        LittleFS.remove(name);
+        oldest++;
+    }
+
+    static bool open_next() {
+        if (segment) {
+            segment.close();
+        }
+        if (running) {
+            current++;
+        }
+        // Room for the new segment plus one in reserve, LittleFS needs free blocks to rotate writes
+        while (current > oldest && LittleFS.totalBytes() - LittleFS.usedBytes() < 2 * BLACKBOX_SEGMENT_SIZE) {
+            delete_oldest();
+        }
+
+        char name[24];
+        path(current, name, sizeof(name));
+        segment = LittleFS.open(name, FILE_WRITE);
+        if (!segment) {
+            return false;
+        }
+        uint8_t header[HEADER_SIZE];
+        uint8_t *p = header;
+        put_u8(p, 'B');
+        put_u8(p, 'B');
+        put_u8(p, VERSION);
+        put_u8(p, RECORD_SIZE);
+        put_u32(p, current);
+        put_u32(p, boot_sequence);
+        put_u16(p, BLACKBOX_RATE);
+        put_u16(p, 0);
+        segment_size = segment.write(header, sizeof(header));
+        return segment_size == sizeof(header);
+    }
+
+    static void append(const uint8_t *data, size_t len) {
+        uint32_t start = micros();
+        if (!segment || segment_size + len > BLACKBOX_SEGMENT_SIZE) {
+            if (!open_next()) {
+                stats.write_errors++;
+                return;
+            }
+        }
+        size_t written = segment.write(data, len);
+        // Commit per buffer so a power cut loses at most one buffer of records
+        segment.flush();
+        segment_size += written;
+        if (written != len) {
+            stats.write_errors++;
+            // Usually a full partition, start over in a fresh segment
+            segment.close();
+        }
+        stats.buffers++;
+        stats.max_write_us = max(stats.max_write_us, micros() - start);
+    }
+
+    [[noreturn]] static void writer_task(void *pv_parameters) {
+        for (;;) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            int8_t index = pending.load();
+            if (index < 0) {
+                continue;
+            }
+            append(buffers[index], sizeof(buffers[index]));
+            pending.store(-1);
+        }
+    }
+
+    static bool sequence_of(const char *name, uint32_t &sequence) {
+        const char *base = strrchr(name, '/');
+        base = base ? base + 1 : name;
+        char *end;
+        unsigned long value = strtoul(base, &end, 10);
+        if (end == base || strcmp(end, ".bin") != 0) {
+            return false;
+        }
+        sequence = value;
+        return true;
+    }
+
+    bool init() {
+        if (!LittleFS.begin(true, "/littlefs", 4, BLACKBOX_PARTITION)) {
+            error("Black box: no data partition, recording off");
+            return false;
+        }
+        LittleFS.mkdir("/bb");
+
+        // Continue the sequence of the previous boots
+        bool found = false;
+        File dir   = LittleFS.open("/bb");
+        for (File file = dir.openNextFile(); file; file = dir.openNextFile()) {
+            uint32_t sequence;
+            if (sequence_of(file.name(), sequence)) {
+                oldest  = found ? min(oldest, sequence) : sequence;
+                current = found ? max(current, sequence) : sequence;
+                found   = true;
+            }
+        }
+        dir.close();
+        if (found) {
+            current++;
+        }
+        boot_sequence = current;
+        if (!open_next()) {
+            error("Black box: cannot create a segment, recording off");
+            return false;
+        }
+
+        BaseType_t created = xTaskCreatePinnedToCore(writer_task, "blackbox_task", 4096, nullptr,
+                                                     BLACKBOX_TASK_PRIORITY, &writer_handle, BLACKBOX_TASK_CORE);
+        if (created != pdPASS || writer_handle == nullptr) {
+            error("Failed to create black box task");
+            return false;
+        }
+        running = true;
+        infof("Black box: segment %u, %u KiB of %u KiB used", current,
+              static_cast<unsigned>(LittleFS.usedBytes() / 1024), static_cast<unsigned>(LittleFS.totalBytes() / 1024));
+        return true;
+    }
+
+    bool is_running() {
+        return running;
+    }
+
+    bool due(uint32_t now_us) {
+        if (!running || now_us - last_us < INTERVAL_US) {
+            return false;
+        }
+        last_us = now_us;
+        return true;
+    }
+
+    void record(const Sample &sample) {
+        write_record(buffers[active] + fill, sample);
+        fill += RECORD_SIZE;
+        if (fill < sizeof(buffers[active])) {
+            stats.records++;
+            return;
+        }
+        if (pending.load() >= 0) {
+            // Writer still busy with the other buffer, the next record overwrites this one
+            fill -= RECORD_SIZE;
+            stats.dropped++;
+            return;
+        }
+        stats.records++;
+        pending.store(active);
+        active ^= 1;
+        fill = 0;
+        xTaskNotifyGive(writer_handle);
+    }
+
+    void list(void (*sink)(uint32_t sequence, size_t size, void *context), void *context) {
+        char name[24];
+        for (uint32_t sequence = oldest; sequence <= current; sequence++) {
+            path(sequence, name, sizeof(name));
+            File file = LittleFS.open(name, FILE_READ);
+            if (file) {
+                sink(sequence, file.size(), context);
+            }
+        }
+    }
+
+    File open_segment(uint32_t sequence) {
+        if (!running || sequence < oldest || sequence > current) {
+            return File();
+        }
+        char name[24];
+        path(sequence, name, sizeof(name));
+        return LittleFS.open(name, FILE_READ);
+    }
+
+    Stats get_stats() {
+        Stats copy       = stats;
+        copy.segment     = current;
+        copy.segments    = running ? current - oldest + 1 : 0;
+        copy.used_bytes  = running ? LittleFS.usedBytes() : 0;
+        copy.total_bytes = running ? LittleFS.totalBytes() : 0;
+        return copy;
+    }
+} // namespace blackbox
@@ -0,0 +1,89 @@
+#ifndef BLACKBOX_H
+#define BLACKBOX_H
+
+#include <Arduino.h>
+#include <FS.h>
+
+// Flight recorder for steering sessions. The control loop packs a fixed-point record at
+// BLACKBOX_RATE into one of two RAM buffers; a background task appends each full buffer
+// to the current segment file on the LittleFS data partition. Segments rotate at
+// BLACKBOX_SEGMENT_SIZE and the oldest is deleted while fewer than two segments' worth of
+// space is free; LittleFS spreads the writes over the partition. tools/blackbox_decode.py
+// fetches segments from /api/blackbox and decodes them.
+//
+// Every flash write and erase disables the cache on both cores, so control tasks running
+// from flash stall for its duration even though they never call into LittleFS. Check the
+// control loop period with tools/udp_flood.py before enabling BLACKBOX_ENABLED.
+//
+// Segment file /bb/<sequence>.bin, little-endian:
+//   header
+//     0  'B' 'B'
+//     2  u8  version
+//     3  u8  record size
+//     4  u32 segment sequence
+//     8  u32 boot sequence (first segment of this boot)
+//     12 u16 record rate (Hz)
+//     14 u16 reserved
+//   records
+//     0  u32 uptime (ms)        4  u32 GNSS time of week (ms, valid with SWITCH_SYNCED)
+//     8  i16 set point (0.01 deg)   10 i16 WAS angle (0.01 deg)
+//     12 u16 heading (0.01 deg)     14 i16 roll (0.01 deg)   16 i16 pitch (0.01 deg)
+//     18 i16 controller output      20 u16 guidance age (ms)  22 u16 speed (0.01 km/h)
+//     24 u8 PWM  25 u8 SWITCH_* bits  26 u8 guidance_link::State  27 reserved
+namespace blackbox {
+    constexpr uint8_t VERSION     = 1;
+    constexpr size_t HEADER_SIZE = 16;
+    constexpr size_t RECORD_SIZE = 28;
+
+    constexpr uint8_t SWITCH_STEER    = 0x01;
+    constexpr uint8_t SWITCH_WORK     = 0x02;
+    constexpr uint8_t SWITCH_ENABLED  = 0x04;
+    constexpr uint8_t SWITCH_REVERSED = 0x08;
+    constexpr uint8_t SWITCH_SYNCED   = 0x10;
+
+    struct Sample {
+        uint32_t time_ms;
+        int64_t gnss_us; // timebase::now_gnss()
+        float setPoint;
+        float actual;
+        float heading;
+        float roll;
+        float pitch;
+        float speed;
+        int16_t output;
+        uint16_t guidanceAge_ms;
+        uint8_t pwm;
+        uint8_t switches;
+        uint8_t linkState;
+    };
+
+    struct Stats {
+        uint32_t records;     // Kept by the control loop
+        uint32_t dropped;     // Lost because the writer still held the other buffer
+        uint32_t buffers;     // Appended to flash
+        uint32_t write_errors;
+        uint32_t segment;     // Sequence of the segment being written
+        uint32_t segments;    // Segments on flash
+        uint32_t max_write_us; // Longest buffer append
+        size_t used_bytes;
+        size_t total_bytes;
+    };
+
+    // Mounts the data partition and starts the writer task, false leaves recording off
+    bool init();
+    bool is_running();
+
+    // True once per 1/BLACKBOX_RATE while recording, the control loop then calls record()
+    bool due(uint32_t now_us);
+    // Packs the sample into the RAM buffer, never touches flash
+    void record(const Sample &sample);
+
+    // Every stored segment, oldest first
+    void list(void (*sink)(uint32_t sequence, size_t size, void *context), void *context);
+    // Open a segment for reading, an invalid File if it does not exist
+    File open_segment(uint32_t sequence);
+
+    Stats get_stats();
+} // namespace blackbox
+
+#endif //BLACKBOX_H
@@ -0,0 +1,162 @@
+#include "heap_guard.h"
+
+#include <atomic>
+#include <esp_attr.h>
+#include <esp_heap_caps.h>
+#include <esp_rom_sys.h>
+
+#include "config/defines.h"
+#include "log.h"
+
+namespace heap_guard {
+
+constexpr size_t MAX_WATCHED = 8;
+
+static std::atomic<bool> ready{false};
+static std::atomic<uint32_t> boot_allocations{0};
+static std::atomic<uint32_t> allocations{0};
+static std::atomic<uint32_t> allocated_bytes{0};
+static std::atomic<uint32_t> watched_allocations{0};
+static volatile uint32_t last_caller = 0;
+static char last_task[16]            = "";
+
+static TaskHandle_t watched[MAX_WATCHED];
+static std::atomic<size_t> watched_count{0};
+
+static uint32_t rate_allocations = 0;
+static uint32_t rate_stamp_ms    = 0;
+static float rate                = 0.0f;
+
+// Runs inside every allocation: no allocation, no locks, no logging
+static IRAM_ATTR void on_alloc(size_t size, void *caller) {
+    if (HEAP_GUARD_MODE == HEAP_GUARD_OFF) {
+        return;
+    }
+    if (!ready.load(std::memory_order_relaxed)) {
+        boot_allocations.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    last_caller = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(caller));
+
+    TaskHandle_t task = xTaskGetCurrentTaskHandle();
+    const char *name  = pcTaskGetName(task);
+    strncpy(last_task, name ? name : "?", sizeof(last_task) - 1);
+
+    size_t count = watched_count.load(std::memory_order_acquire);
+    for (size_t i = 0; i < count; i++) {
+        if (watched[i] == task) {
+            watched_allocations.fetch_add(1, std::memory_order_relaxed);
+            if (HEAP_GUARD_MODE == HEAP_GUARD_TRAP) {
+                esp_rom_printf("heap_guard: %u byte allocation in %s from 0x%08x after ready\n",
+                               static_cast<unsigned>(size), last_task, last_caller);
+                abort();
+            }
+            return;
+        }
+    }
+}
+
+void mark_ready() {
+    ready.store(true);
+    rate_allocations = allocations.load();
+    rate_stamp_ms    = millis();
+    infof("Heap guard: %u allocations during boot, %u bytes free, largest block %u", boot_allocations.load(),
+          heap_caps_get_free_size(MALLOC_CAP_8BIT), heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+}
+
+bool is_ready() {
+    return ready.load();
+}
+
+bool watch(TaskHandle_t task) {
+    size_t count = watched_count.load();
+    if (task == nullptr || count >= MAX_WATCHED) {
+        return false;
+    }
+    watched[count] = task;
+    watched_count.store(count + 1, std::memory_order_release);
+    return true;
+}
+
+void update() {
+    if (!ready.load()) {
+        return;
+    }
+    uint32_t now   = millis();
+    uint32_t count = allocations.load();
+    if (now - rate_stamp_ms >= 1000) {
+        rate             = (count - rate_allocations) * 1000.0f / (now - rate_stamp_ms);
+        rate_allocations = count;
+        rate_stamp_ms    = now;
+    }
+}
+
+Stats get_stats() {
+    Stats stats               = {};
+    stats.ready               = ready.load();
+    stats.boot_allocations    = boot_allocations.load();
+    stats.allocations         = allocations.load();
+    stats.allocated_bytes     = allocated_bytes.load();
+    stats.watched_allocations = watched_allocations.load();
+    stats.rate                = rate;
+    stats.last_caller         = last_caller;
+    memcpy(stats.last_task, last_task, sizeof(stats.last_task) - 1);
+    stats.free_bytes     = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    stats.min_free_bytes = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    stats.largest_block  = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    return stats;
+}
+
+void print_stats() {
+    Stats stats = get_stats();
+    debugf("Heap: free=%u min_free=%u largest_block=%u allocations=%u (%.1f/s, %u from control tasks) last=%s@0x%08x",
+           stats.free_bytes, stats.min_free_bytes, stats.largest_block, stats.allocations, stats.rate,
+           stats.watched_allocations, stats.last_task[0] ? stats.last_task : "-", stats.last_caller);
+}
+} // namespace heap_guard
+
+// Link-time wrappers, see the --wrap flags in platformio.ini
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void *__real_heap_caps_malloc(size_t size, uint32_t caps);
+void *__real_heap_caps_calloc(size_t count, size_t size, uint32_t caps);
+void *__real_heap_caps_realloc(void *ptr, size_t size, uint32_t caps);
+
+IRAM_ATTR void *__wrap_malloc(size_t size) {
+    heap_guard::on_alloc(size, __builtin_return_address(0));
+    return __real_malloc(size);
+}
+
+IRAM_ATTR void *__wrap_calloc(size_t count, size_t size) {
+    heap_guard::on_alloc(count * size, __builtin_return_address(0));
+    return __real_calloc(count, size);
+}
+
+IRAM_ATTR void *__wrap_realloc(void *ptr, size_t size) {
+    if (size > 0) {
+        heap_guard::on_alloc(size, __builtin_return_address(0));
+    }
+    return __real_realloc(ptr, size);
+}
+
+IRAM_ATTR void *__wrap_heap_caps_malloc(size_t size, uint32_t caps) {
+    heap_guard::on_alloc(size, __builtin_return_address(0));
+    return __real_heap_caps_malloc(size, caps);
+}
+
+IRAM_ATTR void *__wrap_heap_caps_calloc(size_t count, size_t size, uint32_t caps) {
+    heap_guard::on_alloc(count * size, __builtin_return_address(0));
+    return __real_heap_caps_calloc(count, size, caps);
+}
+
+IRAM_ATTR void *__wrap_heap_caps_realloc(void *ptr, size_t size, uint32_t caps) {
+    if (size > 0) {
+        heap_guard::on_alloc(size, __builtin_return_address(0));
+    }
+    return __real_heap_caps_realloc(ptr, size, caps);
+}
+}
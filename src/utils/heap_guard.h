@@ -0,0 +1,40 @@
+#ifndef HEAP_GUARD_H
+#define HEAP_GUARD_H
+
+#include <Arduino.h>
+
+// Heap allocation guard. malloc, calloc, realloc and their heap_caps variants are wrapped at
+// link time (-Wl,--wrap in platformio.ini). Allocations are counted from boot. After
+// mark_ready() every allocation counts against the steady state. In HEAP_GUARD_TRAP mode an
+// allocation from a watched control task aborts with a backtrace.
+namespace heap_guard {
+
+struct Stats {
+    bool ready;
+    uint32_t boot_allocations;    // Before mark_ready()
+    uint32_t allocations;         // After mark_ready(), from any task
+    uint32_t allocated_bytes;
+    uint32_t watched_allocations; // After mark_ready(), from a watched task
+    float rate;                   // Allocations per second over the last update() interval
+    uint32_t last_caller;         // Return address of the last steady-state allocation, for addr2line
+    char last_task[16];           // Task that made it
+    uint32_t free_bytes;
+    uint32_t min_free_bytes;      // Low-water mark since boot
+    uint32_t largest_block;
+};
+
+// Every allocation from here on counts as steady state
+void mark_ready();
+bool is_ready();
+
+// Add a task whose steady-state allocations are counted separately and trapped in HEAP_GUARD_TRAP mode
+bool watch(TaskHandle_t task);
+
+// Refreshes the allocation rate, call about once a second
+void update();
+
+Stats get_stats();
+void print_stats();
+} // namespace heap_guard
+
+#endif //HEAP_GUARD_H
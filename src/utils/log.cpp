@@ -2,17 +2,38 @@
 #include "log.h"
 #include "output_stream.h"
 #include "udp_stream.h"
+#include "config/defines.h"
+#include <Preferences.h>
 #include <stdarg.h>
+#include <new>
 
-// Global variable definitions
-String logs[LOG_SIZE];
-int prevPosition = 0;
+// Web log ring of JSON array entries, oldest at logHead - logCount
+static char logEntries[LOG_SIZE][LOG_ENTRY_SIZE];
+static int logHead  = 0;
+static int logCount = 0;
 
-// UDP stream instance
+constexpr size_t CATEGORY_COUNT = static_cast<size_t>(LogCategory::count);
+static const char* categoryNames[CATEGORY_COUNT] = {"general", "autosteer", "udp_io", "gps", "imu", "was", "settings",
+                                                    "net"};
+static const char* levelNames[] = {"debug", "info", "warning", "error", "off"};
+
+volatile uint8_t logLevels[CATEGORY_COUNT];
+static uint16_t logRates[CATEGORY_COUNT];
+static uint32_t logSuppressed[CATEGORY_COUNT];
+
+// UDP stream instance, constructed in static storage on first use
+alignas(UDPStream) static uint8_t udpStreamStorage[sizeof(UDPStream)];
 static UDPStream* udpStream = nullptr;
 
+// Guards logs[] against readers on other tasks
+static SemaphoreHandle_t logMutex() {
+    static StaticSemaphore_t storage;
+    static SemaphoreHandle_t mutex = xSemaphoreCreateMutexStatic(&storage);
+    return mutex;
+}
+
 // Helper function to get log level string
-String getLevelString(LogLevel level) {
+static const char* getLevelString(LogLevel level) {
     switch(level) {
         case LogLevel::DEBUG:   return "DEBUG";
         case LogLevel::INFO:    return "INFO";
@@ -22,123 +43,311 @@ String getLevelString(LogLevel level) {
     }
 }
 
-String getLog()
-{
-  String response = "{\"timestamp\":" + String(millis()) + ",\"log\":[";
-  bool firstEntry = true;
-
-  // Build JSON array of logs
-  for (int i = 0; i < LOG_SIZE; i++)
-  {
-    if (logs[i].length() > 0)
-    {
-      if (!firstEntry)
-      {
-        response += ",";
-      }
-      response += logs[i];
-      firstEntry = false;
+// Appends text as the inside of a JSON string. An escape that does not fit ends the text, and so
+// does a UTF-8 sequence cut in half, so a clipped entry is still valid JSON.
+static size_t appendEscaped(char* dst, size_t pos, size_t capacity, const char* text) {
+    size_t start = pos;
+    for (const char* p = text; *p; p++) {
+        char c = *p;
+        char escaped[7];
+        size_t n;
+        if (c == '"' || c == '\\') {
+            escaped[0] = '\\';
+            escaped[1] = c;
+            n          = 2;
+        } else if (static_cast<uint8_t>(c) < 0x20) {
+            n = snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+        } else {
+            escaped[0] = c;
+            n          = 1;
+        }
+        if (pos + n >= capacity) {
+            while (pos > start && (static_cast<uint8_t>(dst[pos - 1]) & 0xC0) == 0x80) pos--;
+            if (pos > start && static_cast<uint8_t>(dst[pos - 1]) >= 0xC0) pos--;
+            break;
+        }
+        memcpy(dst + pos, escaped, n);
+        pos += n;
     }
-  }
-
-  response += "]}";
-  return response;
+    return pos;
 }
 
-void addToLog(const String& input, LogLevel level)
+void addToLog(const char* input, LogLevel level)
 {
-    // Format the message with timestamp and level
-    String formattedMessage = "[" + getLevelString(level) + "] " + input;
-    
+    // Format the message with its level, on the stack so logging never allocates
+    char formattedMessage[288];
+    snprintf(formattedMessage, sizeof(formattedMessage), "[%s] %s", getLevelString(level), input);
+
     // Always send to output stream (USBSerial/UDP)
     OutputStream::println(formattedMessage);
 
     // Only add to web log if level is INFO or higher
     if (level >= LogLevel::INFO) {
-        // Create timestamped log entry
-        const String msg = "[\"" + String(millis()) + "\",\"" + formattedMessage + "\"]";
-
-        if (prevPosition == LOG_SIZE - 1)
-        {
-            // Shift all logs one position back
-            for (int i = 0; i < LOG_SIZE - 1; i++)
-            {
-                logs[i] = logs[i + 1];
-            }
-            logs[LOG_SIZE - 1] = msg;
-        }
-        else
-        {
-            // Find first empty position
-            for (int i = 0; i < LOG_SIZE; i++)
-            {
-                if (logs[i].length() == 0)
-                {
-                    logs[i] = msg;
-                    prevPosition = i;
-                    break;
-                }
-            }
+        xSemaphoreTake(logMutex(), portMAX_DELAY);
+        // Timestamped entry, overwriting the oldest once the ring is full
+        char* entry = logEntries[logHead];
+        int prefix  = snprintf(entry, LOG_ENTRY_SIZE, "[\"%lu\",\"", static_cast<unsigned long>(millis()));
+        size_t pos  = appendEscaped(entry, prefix, LOG_ENTRY_SIZE - 2, formattedMessage);
+        memcpy(entry + pos, "\"]", 3);
+        logHead = (logHead + 1) % LOG_SIZE;
+        if (logCount < LOG_SIZE) {
+            logCount++;
         }
+        xSemaphoreGive(logMutex());
+    }
+}
+
+void addToLog(const String& input, LogLevel level) {
+    addToLog(input.c_str(), level);
+}
+
+size_t copyLogEntry(int index, char* buf, size_t capacity) {
+    if (index < 0 || index >= LOG_SIZE || capacity == 0) {
+        return 0;
+    }
+    xSemaphoreTake(logMutex(), portMAX_DELAY);
+    size_t len = 0;
+    if (index < logCount) {
+        const char* entry = logEntries[(logHead - logCount + index + LOG_SIZE) % LOG_SIZE];
+        len = min(strlen(entry), capacity - 1);
+        memcpy(buf, entry, len);
     }
+    xSemaphoreGive(logMutex());
+    buf[len] = '\0';
+    return len;
 }
 
 // Convenience functions for different log levels
+void debug(const char* message) {
+    if (!logEnabled(LogCategory::general, LogLevel::DEBUG)) {
+        return;
+    }
+    addToLog(message, LogLevel::DEBUG);
+}
+
+void info(const char* message) {
+    if (!logEnabled(LogCategory::general, LogLevel::INFO)) {
+        return;
+    }
+    addToLog(message, LogLevel::INFO);
+}
+
+void warning(const char* message) {
+    if (!logEnabled(LogCategory::general, LogLevel::WARNING)) {
+        return;
+    }
+    addToLog(message, LogLevel::WARNING);
+}
+
+void error(const char* message) {
+    if (!logEnabled(LogCategory::general, LogLevel::ERROR)) {
+        return;
+    }
+    addToLog(message, LogLevel::ERROR);
+}
+
 void debug(const String& message) {
+    if (!logEnabled(LogCategory::general, LogLevel::DEBUG)) {
+        return;
+    }
     addToLog(message, LogLevel::DEBUG);
 }
 
 void info(const String& message) {
+    if (!logEnabled(LogCategory::general, LogLevel::INFO)) {
+        return;
+    }
     addToLog(message, LogLevel::INFO);
 }
 
 void warning(const String& message) {
+    if (!logEnabled(LogCategory::general, LogLevel::WARNING)) {
+        return;
+    }
     addToLog(message, LogLevel::WARNING);
 }
 
 void error(const String& message) {
+    if (!logEnabled(LogCategory::general, LogLevel::ERROR)) {
+        return;
+    }
     addToLog(message, LogLevel::ERROR);
 }
 
+static bool takeToken(LogCategory category, LogLimiter* limiter) {
+    uint16_t rate = logRates[static_cast<size_t>(category)];
+    if (rate == 0) {
+        return true;
+    }
+    uint32_t now = millis();
+    if (!limiter->primed) {
+        limiter->tokens = LOG_BURST;
+        limiter->primed = true;
+    } else {
+        limiter->tokens = min(static_cast<float>(LOG_BURST), limiter->tokens + (now - limiter->stamp_ms) * rate / 1000.0f);
+    }
+    limiter->stamp_ms = now;
+    if (limiter->tokens < 1.0f) {
+        if (limiter->suppressed < UINT16_MAX) limiter->suppressed++;
+        logSuppressed[static_cast<size_t>(category)]++;
+        return false;
+    }
+    limiter->tokens -= 1.0f;
+    return true;
+}
+
+void logMessagef(LogCategory category, LogLevel level, LogLimiter* limiter, const char* format, ...) {
+    if (!logEnabled(category, level) || !takeToken(category, limiter)) {
+        return;
+    }
+    char buffer[256];
+    int n = snprintf(buffer, sizeof(buffer), "[%s] ", categoryNames[static_cast<size_t>(category)]);
+    va_list args;
+    va_start(args, format);
+    vsnprintf(buffer + n, sizeof(buffer) - n, format, args);
+    va_end(args);
+    if (limiter->suppressed > 0) {
+        size_t len = strlen(buffer);
+        snprintf(buffer + len, sizeof(buffer) - len, " (%u suppressed)", limiter->suppressed);
+        limiter->suppressed = 0;
+    }
+    addToLog(buffer, level);
+}
+
+const char* logCategoryName(LogCategory category) {
+    return categoryNames[static_cast<size_t>(category)];
+}
+
+const char* logLevelName(LogLevel level) {
+    return levelNames[static_cast<size_t>(level)];
+}
+
+bool parseLogCategory(const char* name, LogCategory& category) {
+    for (size_t i = 0; i < CATEGORY_COUNT; i++) {
+        if (strcmp(name, categoryNames[i]) == 0) {
+            category = static_cast<LogCategory>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool parseLogLevel(const char* name, LogLevel& level) {
+    for (size_t i = 0; i < sizeof(levelNames) / sizeof(levelNames[0]); i++) {
+        if (strcmp(name, levelNames[i]) == 0) {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void setLogLevel(LogCategory category, LogLevel level) {
+    logLevels[static_cast<size_t>(category)] = static_cast<uint8_t>(level);
+}
+
+LogLevel getLogLevel(LogCategory category) {
+    return static_cast<LogLevel>(logLevels[static_cast<size_t>(category)]);
+}
+
+void setLogRate(LogCategory category, uint16_t perSecond) {
+    logRates[static_cast<size_t>(category)] = perSecond;
+}
+
+uint16_t getLogRate(LogCategory category) {
+    return logRates[static_cast<size_t>(category)];
+}
+
+uint32_t getLogSuppressed(LogCategory category) {
+    return logSuppressed[static_cast<size_t>(category)];
+}
+
+bool saveLogConfig() {
+    Preferences prefs;
+    if (!prefs.begin("log", false)) {
+        return false;
+    }
+    uint8_t levels[CATEGORY_COUNT];
+    for (size_t i = 0; i < CATEGORY_COUNT; i++) levels[i] = logLevels[i];
+    bool ok = prefs.putBytes("levels", levels, sizeof(levels)) == sizeof(levels);
+    ok &= prefs.putBytes("rates", logRates, sizeof(logRates)) == sizeof(logRates);
+    prefs.end();
+    return ok;
+}
+
+static void loadLogConfig() {
+    for (size_t i = 0; i < CATEGORY_COUNT; i++) {
+        logLevels[i] = static_cast<uint8_t>(LOG_DEFAULT_LEVEL);
+        logRates[i]  = LOG_RATE_LIMIT;
+    }
+    Preferences prefs;
+    if (!prefs.begin("log", true)) {
+        return;
+    }
+    // Stored tables of another category count are ignored, the defaults stay
+    uint8_t levels[CATEGORY_COUNT];
+    if (prefs.getBytesLength("levels") == sizeof(levels) && prefs.getBytes("levels", levels, sizeof(levels))) {
+        for (size_t i = 0; i < CATEGORY_COUNT; i++) logLevels[i] = min(levels[i], static_cast<uint8_t>(LogLevel::OFF));
+    }
+    if (prefs.getBytesLength("rates") == sizeof(logRates)) {
+        prefs.getBytes("rates", logRates, sizeof(logRates));
+    }
+    prefs.end();
+}
+
 // Formatted logging functions
 void debugf(const char* format, ...) {
+    if (!logEnabled(LogCategory::general, LogLevel::DEBUG)) {
+        return;
+    }
     char buffer[256];
     va_list args;
     va_start(args, format);
     vsnprintf(buffer, sizeof(buffer), format, args);
     va_end(args);
-    debug(String(buffer));
+    debug(buffer);
 }
 
 void infof(const char* format, ...) {
+    if (!logEnabled(LogCategory::general, LogLevel::INFO)) {
+        return;
+    }
     char buffer[256];
     va_list args;
     va_start(args, format);
     vsnprintf(buffer, sizeof(buffer), format, args);
     va_end(args);
-    info(String(buffer));
+    info(buffer);
 }
 
 void warningf(const char* format, ...) {
+    if (!logEnabled(LogCategory::general, LogLevel::WARNING)) {
+        return;
+    }
     char buffer[256];
     va_list args;
     va_start(args, format);
     vsnprintf(buffer, sizeof(buffer), format, args);
     va_end(args);
-    warning(String(buffer));
+    warning(buffer);
 }
 
 void errorf(const char* format, ...) {
+    if (!logEnabled(LogCategory::general, LogLevel::ERROR)) {
+        return;
+    }
     char buffer[256];
     va_list args;
     va_start(args, format);
     vsnprintf(buffer, sizeof(buffer), format, args);
     va_end(args);
-    error(String(buffer));
+    error(buffer);
 }
 
 // Initialization functions
 bool initLogging() {
+    loadLogConfig();
+
     // Clear any existing streams
     OutputStream::clearStreams();
 
@@ -156,16 +365,20 @@ bool initUDPLogging(uint16_t udpPort) {
         return false;
     }
 
-    // Create and initialize UDP stream
-    udpStream = new UDPStream(IPAddress(255, 255, 255, 255), udpPort);
+    // Log lines are sent from the udp_tx pool, which may not be up yet
+    if (!udp_tx::init()) {
+        error("Failed to initialize UDP broadcast logging");
+        return false;
+    }
+    if (udpStream == nullptr) {
+        udpStream = new (udpStreamStorage) UDPStream(IPAddress(255, 255, 255, 255), udpPort);
+    }
     if (udpStream->begin()) {
         OutputStream::addStream(udpStream);
-        debug("UDP broadcast logging initialized on port " + String(udpPort));
+        debugf("UDP broadcast logging initialized on port %u", udpPort);
         return true;
     } else {
         error("Failed to initialize UDP broadcast logging");
-        delete udpStream;
-        udpStream = nullptr;
         return false;
     }
 }
\ No newline at end of file
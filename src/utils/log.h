@@ -4,21 +4,86 @@
 
 // Constants
 constexpr int LOG_SIZE = 20;
+constexpr size_t LOG_ENTRY_SIZE = 320; // Web log entry including its JSON framing
 
 // Logging levels
 enum class LogLevel {
     DEBUG,
     INFO,
     WARNING,
-    ERROR
+    ERROR,
+    OFF // Category threshold only, silences the category
 };
 
-// Global variable declaration
-extern String logs[LOG_SIZE];
+// Log categories, each with a runtime level and a per call site rate limit.
+// The plain debug()/debugf() family logs to general.
+enum class LogCategory : uint8_t {
+    general,
+    autosteer,
+    udp_io,
+    gps,
+    imu,
+    was,
+    settings,
+    net,
+    count
+};
+
+// Lowest level let through per category, indexed by LogCategory
+extern volatile uint8_t logLevels[static_cast<size_t>(LogCategory::count)];
+
+inline bool logEnabled(LogCategory category, LogLevel level) {
+    return static_cast<uint8_t>(level) >= logLevels[static_cast<size_t>(category)];
+}
+
+// Token bucket of one call site, refilled at the category's rate
+struct LogLimiter {
+    uint32_t stamp_ms;
+    float tokens;
+    uint16_t suppressed; // Messages dropped since the last one let through
+    bool primed;
+};
+
+// Category logging. The level is checked before the arguments are formatted, and each call
+// site gets its own LogLimiter so one chatty line cannot crowd out the others.
+#define LOG_AT(category, level, ...)                                                     \
+    do {                                                                                 \
+        if (logEnabled(category, level)) {                                               \
+            static LogLimiter log_limiter_;                                              \
+            logMessagef(category, level, &log_limiter_, __VA_ARGS__);                    \
+        }                                                                                \
+    } while (0)
+#define LOGD(category, ...) LOG_AT(LogCategory::category, LogLevel::DEBUG, __VA_ARGS__)
+#define LOGI(category, ...) LOG_AT(LogCategory::category, LogLevel::INFO, __VA_ARGS__)
+#define LOGW(category, ...) LOG_AT(LogCategory::category, LogLevel::WARNING, __VA_ARGS__)
+#define LOGE(category, ...) LOG_AT(LogCategory::category, LogLevel::ERROR, __VA_ARGS__)
+
+void logMessagef(LogCategory category, LogLevel level, LogLimiter* limiter, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+// Runtime configuration, changed through the diagnostics port "log" command and kept in NVS
+const char* logCategoryName(LogCategory category);
+const char* logLevelName(LogLevel level);
+bool parseLogCategory(const char* name, LogCategory& category);
+bool parseLogLevel(const char* name, LogLevel& level);
+void setLogLevel(LogCategory category, LogLevel level);
+LogLevel getLogLevel(LogCategory category);
+// Messages per second per call site, 0 disables the limit
+void setLogRate(LogCategory category, uint16_t perSecond);
+uint16_t getLogRate(LogCategory category);
+uint32_t getLogSuppressed(LogCategory category);
+bool saveLogConfig();
 
 // Function declarations
-String getLog();
+// Copy web log entry index (a JSON array, 0 is the oldest) into buf, returns its length or 0 for an empty slot
+size_t copyLogEntry(int index, char* buf, size_t capacity);
+// The const char* overloads format on the stack; the String ones remain for callers that build messages
+void addToLog(const char* input, LogLevel level = LogLevel::INFO);
 void addToLog(const String& input, LogLevel level = LogLevel::INFO);
+void debug(const char* message);
+void info(const char* message);
+void warning(const char* message);
+void error(const char* message);
 void debug(const String& message);
 void info(const String& message);
 void warning(const String& message);
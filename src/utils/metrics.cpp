@@ -0,0 +1,224 @@
+#include "metrics.h"
+
+#include <atomic>
+#include <stdarg.h>
+#include <esp_heap_caps.h>
+
+#include "heap_guard.h"
+
+namespace metrics {
+constexpr size_t CORES           = portNUM_PROCESSORS;
+constexpr size_t COUNTER_COUNT   = static_cast<size_t>(Counter::count);
+constexpr size_t GAUGE_COUNT     = static_cast<size_t>(Gauge::count);
+constexpr size_t HISTOGRAM_COUNT = static_cast<size_t>(Histogram::count);
+constexpr size_t MAX_BUCKETS     = 12;
+
+struct Description {
+    const char *name;
+    const char *help;
+};
+
+static const Description counter_info[COUNTER_COUNT] = {
+    {"aio_aog_bad_crc_total", "Steer port datagrams failing the AOG checksum"},
+    {"aio_aog_unknown_pgn_total", "Steer port datagrams with an unregistered PGN"},
+    {"aio_aog_bad_length_total", "Steer port datagrams with an unexpected payload length"},
+    {"aio_aog_malformed_total", "Steer port datagrams too short, truncated or without AOG header"},
+    {"aio_gps_bytes_forwarded_total", "Correction bytes written to the GNSS receiver"},
+    {"aio_eeprom_commits_total", "EEPROM commits"},
+    {"aio_eeprom_commit_failures_total", "EEPROM commits that failed"},
+    {"aio_i2c_errors_total", "I2C transactions without acknowledge or with short reads"},
+    {"aio_imu_resets_total", "BNO08x reset reports"},
+    {"aio_motor_enable_transitions_total", "Steering engaged or disengaged"},
+};
+
+static const Description gauge_info[GAUGE_COUNT] = {
+    {"aio_steer_enabled", "Motor output enabled"},
+    {"aio_steer_angle_degrees", "Wheel angle sensor reading"},
+    {"aio_steer_set_point_degrees", "Set point from guidance"},
+    {"aio_steer_pwm", "Motor PWM duty, 0-255"},
+    {"aio_guidance_age_ms", "Time since the last steer data packet"},
+};
+
+struct HistogramInfo {
+    Description description;
+    uint8_t buckets;
+    uint32_t bounds[MAX_BUCKETS]; // Upper bounds, ascending
+};
+
+static const HistogramInfo histogram_info[HISTOGRAM_COUNT] = {
+    {{"aio_control_period_us", "Time between control loop runs"},
+     10, {900, 950, 990, 1010, 1050, 1100, 1500, 2000, 5000, 10000}},
+    {{"aio_steer_interval_ms", "Time between steer data packets"},
+     10, {20, 50, 75, 90, 110, 150, 200, 300, 500, 1000}},
+};
+
+// One slot per core, bumped only with relaxed atomic adds
+struct Cell {
+    std::atomic<uint32_t> cores[CORES];
+
+    void add(uint32_t n) {
+        cores[xPortGetCoreID()].fetch_add(n, std::memory_order_relaxed);
+    }
+
+    uint32_t load() const {
+        uint32_t sum = 0;
+        for (const auto &core: cores) sum += core.load(std::memory_order_relaxed);
+        return sum;
+    }
+};
+
+struct HistogramCells {
+    Cell buckets[MAX_BUCKETS + 1]; // Last one counts values above every bound
+    Cell sum;
+};
+
+static Cell counters[COUNTER_COUNT];
+static Cell pgns[256];
+static std::atomic<uint32_t> gauges[GAUGE_COUNT]; // Float bits, one writer each
+static HistogramCells histograms[HISTOGRAM_COUNT];
+
+void inc(Counter counter, uint32_t n) {
+    counters[static_cast<size_t>(counter)].add(n);
+}
+
+void inc_pgn(uint8_t pgn) {
+    pgns[pgn].add(1);
+}
+
+void set(Gauge gauge, float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    gauges[static_cast<size_t>(gauge)].store(bits, std::memory_order_relaxed);
+}
+
+static float gauge_value(size_t index) {
+    uint32_t bits = gauges[index].load(std::memory_order_relaxed);
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void observe(Histogram histogram, uint32_t value) {
+    const HistogramInfo &info = histogram_info[static_cast<size_t>(histogram)];
+    HistogramCells &cells     = histograms[static_cast<size_t>(histogram)];
+    size_t bucket = 0;
+    while (bucket < info.buckets && value > info.bounds[bucket]) bucket++;
+    cells.buckets[bucket].add(1);
+    cells.sum.add(value);
+}
+
+static void emit(void (*sink)(const char *, size_t, void *), void *context, const char *format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+static void emit(void (*sink)(const char *, size_t, void *), void *context, const char *format, ...) {
+    char line[160];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (n > 0) {
+        sink(line, min(static_cast<size_t>(n), sizeof(line) - 1), context);
+    }
+}
+
+static void header(void (*sink)(const char *, size_t, void *), void *context, const Description &description,
+                   const char *type) {
+    emit(sink, context, "# HELP %s %s\n# TYPE %s %s\n", description.name, description.help, description.name, type);
+}
+
+void write_text(void (*sink)(const char *text, size_t len, void *context), void *context) {
+    for (size_t i = 0; i < COUNTER_COUNT; i++) {
+        header(sink, context, counter_info[i], "counter");
+        emit(sink, context, "%s %u\n", counter_info[i].name, counters[i].load());
+    }
+
+    header(sink, context, {"aio_aog_packets_total", "Accepted steer port datagrams by PGN"}, "counter");
+    for (size_t pgn = 0; pgn < 256; pgn++) {
+        uint32_t value = pgns[pgn].load();
+        if (value) {
+            emit(sink, context, "aio_aog_packets_total{pgn=\"%u\"} %u\n", static_cast<unsigned>(pgn), value);
+        }
+    }
+
+    for (size_t i = 0; i < GAUGE_COUNT; i++) {
+        header(sink, context, gauge_info[i], "gauge");
+        emit(sink, context, "%s %g\n", gauge_info[i].name, gauge_value(i));
+    }
+    header(sink, context, {"aio_uptime_seconds", "Time since boot"}, "gauge");
+    emit(sink, context, "aio_uptime_seconds %.3f\n", millis() / 1000.0);
+    header(sink, context, {"aio_heap_free_bytes", "Free 8-bit heap"}, "gauge");
+    emit(sink, context, "aio_heap_free_bytes %u\n", heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    header(sink, context, {"aio_heap_min_free_bytes", "Lowest free 8-bit heap since boot"}, "gauge");
+    emit(sink, context, "aio_heap_min_free_bytes %u\n", heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+    header(sink, context, {"aio_heap_largest_free_block_bytes", "Largest free 8-bit heap block"}, "gauge");
+    emit(sink, context, "aio_heap_largest_free_block_bytes %u\n", heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+    heap_guard::Stats heap = heap_guard::get_stats();
+    header(sink, context, {"aio_heap_allocations_total", "Heap allocations since the system was ready"}, "counter");
+    emit(sink, context, "aio_heap_allocations_total{tasks=\"control\"} %u\n", heap.watched_allocations);
+    emit(sink, context, "aio_heap_allocations_total{tasks=\"other\"} %u\n", heap.allocations - heap.watched_allocations);
+
+    for (size_t i = 0; i < HISTOGRAM_COUNT; i++) {
+        const HistogramInfo &info   = histogram_info[i];
+        const HistogramCells &cells = histograms[i];
+        const char *name            = info.description.name;
+        header(sink, context, info.description, "histogram");
+        uint32_t cumulative = 0;
+        for (size_t b = 0; b < info.buckets; b++) {
+            cumulative += cells.buckets[b].load();
+            emit(sink, context, "%s_bucket{le=\"%u\"} %u\n", name, info.bounds[b], cumulative);
+        }
+        cumulative += cells.buckets[info.buckets].load();
+        emit(sink, context, "%s_bucket{le=\"+Inf\"} %u\n%s_sum %u\n%s_count %u\n", name, cumulative, name,
+             cells.sum.load(), name, cumulative);
+    }
+}
+
+static void put_u32(uint8_t *&p, uint32_t value) {
+    *p++ = value & 0xFF;
+    *p++ = (value >> 8) & 0xFF;
+    *p++ = (value >> 16) & 0xFF;
+    *p++ = value >> 24;
+}
+
+size_t encode(uint8_t *buf, size_t cap) {
+    size_t pgn_count = 0;
+    for (const auto &pgn: pgns) pgn_count += pgn.load() != 0;
+    size_t size = 8 + 1 + COUNTER_COUNT * 4 + 1 + GAUGE_COUNT * 4 + 1 + 1 + pgn_count * 5;
+    for (const auto &info: histogram_info) size += 1 + info.buckets * 8 + 8;
+    if (size > cap) {
+        return 0;
+    }
+
+    uint8_t *p = buf;
+    *p++ = 'M';
+    *p++ = 'T';
+    *p++ = VERSION;
+    *p++ = 0;
+    put_u32(p, millis());
+    *p++ = COUNTER_COUNT;
+    for (const auto &counter: counters) put_u32(p, counter.load());
+    *p++ = GAUGE_COUNT;
+    for (const auto &gauge: gauges) put_u32(p, gauge.load(std::memory_order_relaxed));
+    *p++ = HISTOGRAM_COUNT;
+    for (size_t i = 0; i < HISTOGRAM_COUNT; i++) {
+        const HistogramInfo &info = histogram_info[i];
+        *p++ = info.buckets;
+        for (size_t b = 0; b < info.buckets; b++) put_u32(p, info.bounds[b]);
+        for (size_t b = 0; b <= info.buckets; b++) put_u32(p, histograms[i].buckets[b].load());
+        put_u32(p, histograms[i].sum.load());
+    }
+    // Counts may have moved since pgn_count, keep the announced number of entries
+    uint8_t *count_at = p++;
+    size_t written    = 0;
+    for (size_t pgn = 0; pgn < 256 && written < pgn_count; pgn++) {
+        uint32_t value = pgns[pgn].load();
+        if (value) {
+            *p++ = pgn;
+            put_u32(p, value);
+            written++;
+        }
+    }
+    *count_at = written;
+    return p - buf;
+}
+} // namespace metrics
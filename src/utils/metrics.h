@@ -0,0 +1,63 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <Arduino.h>
+
+// Statically allocated counters, gauges and fixed-bucket histograms. Every cell is kept
+// once per core and bumped with a relaxed atomic add, so recording never takes a lock.
+// Snapshots sum the cores. Counters and histogram sums are 32 bits and wrap.
+// Exported as Prometheus text on /metrics and as a binary reply to the "metrics"
+// diagnostics command (tools/metrics_dump.py).
+namespace metrics {
+
+enum class Counter : uint8_t {
+    aog_bad_crc,         // Steer port datagrams failing the AOG checksum
+    aog_unknown_pgn,
+    aog_bad_length,      // Known PGN, unexpected payload length
+    aog_malformed,       // Too short, bad header or truncated
+    gps_bytes_forwarded, // Correction bytes written to the receiver UART
+    eeprom_commits,
+    eeprom_commit_failures,
+    i2c_errors,
+    imu_resets,          // BNO08x reset reports
+    motor_enable_transitions,
+    count
+};
+
+enum class Gauge : uint8_t {
+    steer_enabled,
+    steer_angle,
+    steer_set_point,
+    pwm,
+    guidance_age_ms,
+    count
+};
+
+enum class Histogram : uint8_t {
+    control_period_us,  // Between autosteer handler runs
+    steer_interval_ms,  // Between PGN 254 arrivals
+    count
+};
+
+void inc(Counter counter, uint32_t n = 1);
+// Accepted steer port datagrams by PGN
+void inc_pgn(uint8_t pgn);
+void set(Gauge gauge, float value);
+void observe(Histogram histogram, uint32_t value);
+
+// Prometheus text exposition format, handed to sink piece by piece
+void write_text(void (*sink)(const char *text, size_t len, void *context), void *context);
+
+// Binary snapshot, little-endian:
+//   0  'M' 'T'  2 u8 version  3 u8 reserved  4 u32 uptime (ms)
+//   u8 counters, u32 each (Counter order)
+//   u8 gauges, f32 each (Gauge order)
+//   u8 histograms, each: u8 buckets, u32 upper bounds, u32 counts, u32 overflow count, u32 sum
+//   u8 PGNs, each: u8 PGN, u32 count
+// Returns the length, 0 when cap is too small
+size_t encode(uint8_t *buf, size_t cap);
+
+constexpr uint8_t VERSION = 1;
+} // namespace metrics
+
+#endif //METRICS_H
@@ -1,4 +1,5 @@
 #include "output_stream.h"
 
-std::vector<Stream*> OutputStream::streams;
+Stream* OutputStream::streams[OutputStream::MAX_STREAMS];
+size_t OutputStream::count = 0;
 bool OutputStream::initialized = false; 
\ No newline at end of file
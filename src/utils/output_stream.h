@@ -2,55 +2,67 @@
 
 #include <Arduino.h>
 #include <Stream.h>
-#include <vector>
 
 class OutputStream {
 private:
-    static std::vector<Stream*> streams;
+    static constexpr size_t MAX_STREAMS = 4; // Fixed table, adding a stream never allocates
+    static Stream* streams[MAX_STREAMS];
+    static size_t count;
     static bool initialized;
 
 public:
-    static void addStream(Stream* s) {
-        streams.push_back(s);
+    static bool addStream(Stream* s) {
+        if (count >= MAX_STREAMS) {
+            return false;
+        }
+        streams[count++] = s;
         initialized = true;
+        return true;
     }
 
     static void removeStream(Stream* s) {
-        for (auto it = streams.begin(); it != streams.end(); ++it) {
-            if (*it == s) {
-                streams.erase(it);
+        for (size_t i = 0; i < count; i++) {
+            if (streams[i] == s) {
+                for (size_t j = i + 1; j < count; j++) {
+                    streams[j - 1] = streams[j];
+                }
+                count--;
                 break;
             }
         }
-        initialized = !streams.empty();
+        initialized = count > 0;
     }
 
     static void clearStreams() {
-        streams.clear();
+        count = 0;
         initialized = false;
     }
 
-    static void print(const String& message) {
+    static void print(const char* message) {
         if (initialized) {
-            for (auto stream : streams) {
-                if (stream) {
-                    stream->print(message);
-                }
+            for (size_t i = 0; i < count; i++) {
+                streams[i]->print(message);
             }
         }
     }
 
-    static void println(const String& message) {
+    static void println(const char* message) {
         if (initialized) {
-            for (auto stream : streams) {
-                if (stream) {
-                    stream->println(message);
-                    stream->flush();
-                }
+            for (size_t i = 0; i < count; i++) {
+                streams[i]->println(message);
+                streams[i]->flush();
             }
         }
     }
 
+    static void print(const String& message) {
+        print(message.c_str());
+    }
+
+    static void println(const String& message) {
+        println(message.c_str());
+    }
+
     static void printf(const char* format, ...) {
         if (initialized) {
             char buffer[256];
@@ -58,10 +70,8 @@ public:
             va_start(args, format);
             vsnprintf(buffer, sizeof(buffer), format, args);
             va_end(args);
-            for (auto stream : streams) {
-                if (stream) {
-                    stream->print(buffer);
-                }
+            for (size_t i = 0; i < count; i++) {
+                streams[i]->print(buffer);
             }
         }
     }
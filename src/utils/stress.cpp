@@ -0,0 +1,172 @@
+#include "stress.h"
+
+#include <atomic>
+#include <cmath>
+#include <esp_freertos_hooks.h>
+#include <esp_timer.h>
+
+#include "config/defines.h"
+#include "log.h"
+
+namespace stress {
+constexpr uint32_t BUCKET_US   = 100;
+constexpr size_t BUCKET_COUNT  = 100; // Periods of 10 ms and more share the last bucket
+
+static std::atomic<Phase> phase{Phase::idle};
+static uint32_t phase_end_ms = 0;
+static uint32_t load_ms      = 0;
+static uint32_t load_start_ms = 0;
+
+// Control loop periods, only touched by the autosteer task
+static int64_t last_tick_us  = 0;
+static uint32_t histogram[BUCKET_COUNT];
+static uint32_t cycles       = 0;
+static uint32_t period_max   = 0;
+static double period_sum     = 0;
+static double period_sum_sq  = 0;
+
+static std::atomic<uint32_t> rx[static_cast<size_t>(Port::count)];
+
+// Idle hook iterations per core; the baseline rate stands for an unloaded core
+static volatile uint32_t idle_count[2] = {0, 0};
+static uint32_t baseline_rate[2]       = {0, 0}; // Iterations per second
+static uint32_t load_idle[2]           = {0, 0};
+static uint32_t phase_idle_start[2]    = {0, 0};
+
+static bool idle_hook_0() {
+    idle_count[0] = idle_count[0] + 1;
+    return false; // Keep spinning so the count tracks idle time
+}
+
+static bool idle_hook_1() {
+    idle_count[1] = idle_count[1] + 1;
+    return false;
+}
+
+static void register_hooks(bool enable) {
+    if (enable) {
+        esp_register_freertos_idle_hook_for_cpu(idle_hook_0, 0);
+        esp_register_freertos_idle_hook_for_cpu(idle_hook_1, 1);
+    } else {
+        esp_deregister_freertos_idle_hook_for_cpu(idle_hook_0, 0);
+        esp_deregister_freertos_idle_hook_for_cpu(idle_hook_1, 1);
+    }
+}
+
+void start(uint32_t duration_ms) {
+    stop();
+    memset(histogram, 0, sizeof(histogram));
+    cycles        = 0;
+    period_max    = 0;
+    period_sum    = 0;
+    period_sum_sq = 0;
+    last_tick_us  = 0;
+    for (auto &count: rx) count.store(0);
+    for (int core = 0; core < 2; core++) {
+        phase_idle_start[core] = idle_count[core];
+        load_idle[core]        = 0;
+    }
+    load_ms      = duration_ms;
+    phase_end_ms = millis() + STRESS_BASELINE_MS;
+    register_hooks(true);
+    phase.store(Phase::baseline);
+    infof("Stress run: %u ms baseline, %u ms load", STRESS_BASELINE_MS, duration_ms);
+}
+
+void stop() {
+    Phase current = phase.exchange(Phase::idle);
+    if (current == Phase::baseline || current == Phase::load) {
+        register_hooks(false);
+    }
+}
+
+// Phase changes ride on the control tick so no extra timer is needed
+static void advance(uint32_t now_ms) {
+    if (static_cast<int32_t>(now_ms - phase_end_ms) < 0) {
+        return;
+    }
+    if (phase.load() == Phase::baseline) {
+        for (int core = 0; core < 2; core++) {
+            baseline_rate[core]    = (idle_count[core] - phase_idle_start[core]) * 1000ULL / STRESS_BASELINE_MS;
+            phase_idle_start[core] = idle_count[core];
+        }
+        for (auto &count: rx) count.store(0);
+        load_start_ms = now_ms;
+        phase_end_ms  = now_ms + load_ms;
+        last_tick_us  = 0;
+        phase.store(Phase::load);
+    } else {
+        for (int core = 0; core < 2; core++) {
+            load_idle[core] = idle_count[core] - phase_idle_start[core];
+        }
+        register_hooks(false);
+        phase.store(Phase::done);
+        Report report = get_report();
+        infof("Stress run %s: period max=%uus p99=%uus jitter=%.0fus load=%.0f%%/%.0f%%",
+              report.passed ? "passed" : "FAILED", report.period_max_us, report.period_p99_us, report.jitter_us,
+              report.cpu_load[0] * 100.0f, report.cpu_load[1] * 100.0f);
+    }
+}
+
+void control_tick() {
+    Phase current = phase.load(std::memory_order_relaxed);
+    if (current != Phase::baseline && current != Phase::load) {
+        return;
+    }
+    int64_t now = esp_timer_get_time();
+    if (current == Phase::load && last_tick_us != 0) {
+        uint32_t period = static_cast<uint32_t>(now - last_tick_us);
+        size_t bucket   = period / BUCKET_US;
+        histogram[bucket < BUCKET_COUNT ? bucket : BUCKET_COUNT - 1]++;
+        if (period > period_max) period_max = period;
+        period_sum += period;
+        period_sum_sq += static_cast<double>(period) * period;
+        cycles++;
+    }
+    last_tick_us = now;
+    advance(millis());
+}
+
+void count_rx(Port port) {
+    if (phase.load(std::memory_order_relaxed) == Phase::load) {
+        rx[static_cast<size_t>(port)].fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+Report get_report() {
+    Report report = {};
+    report.phase  = phase.load();
+    report.cycles = cycles;
+    report.period_max_us = period_max;
+    if (cycles > 0) {
+        double mean           = period_sum / cycles;
+        report.period_mean_us = mean;
+        report.jitter_us      = std::sqrt(std::max(0.0, period_sum_sq / cycles - mean * mean));
+        uint32_t target = cycles - cycles / 100;
+        uint32_t seen   = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; i++) {
+            seen += histogram[i];
+            if (seen >= target) {
+                report.period_p99_us = (i + 1) * BUCKET_US;
+                break;
+            }
+        }
+    }
+    for (size_t i = 0; i < static_cast<size_t>(Port::count); i++) {
+        report.rx[i] = rx[i].load();
+    }
+
+    uint32_t elapsed_ms = report.phase == Phase::done ? load_ms : millis() - load_start_ms;
+    for (int core = 0; core < 2; core++) {
+        uint32_t idle = report.phase == Phase::done ? load_idle[core] : idle_count[core] - phase_idle_start[core];
+        float expected = static_cast<float>(baseline_rate[core]) * elapsed_ms / 1000.0f;
+        float load     = expected > 0 ? 1.0f - idle / expected : 0.0f;
+        report.cpu_load[core]  = load < 0.0f ? 0.0f : load;
+        report.idle_rate[core] = baseline_rate[core];
+    }
+
+    report.passed = cycles > 0 && report.period_max_us <= STRESS_MAX_PERIOD_US &&
+                    report.period_p99_us <= STRESS_MAX_P99_US;
+    return report;
+}
+} // namespace stress
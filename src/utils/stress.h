@@ -0,0 +1,49 @@
+#ifndef STRESS_H
+#define STRESS_H
+
+#include <Arduino.h>
+
+// Network load resilience run. Started from the diagnostics port while tools/udp_flood.py
+// loads the network; records control loop period jitter, received datagrams per port and
+// CPU load per core, first for a quiet baseline window and then under load.
+namespace stress {
+
+enum class Port : uint8_t {
+    autosteer = 0,
+    gps       = 1,
+    count
+};
+
+enum class Phase : uint8_t {
+    idle,
+    baseline, // Calibrating idle counts before the flood starts
+    load,
+    done
+};
+
+struct Report {
+    Phase phase;
+    uint32_t cycles;          // Control loop periods measured under load
+    uint32_t period_max_us;
+    uint32_t period_p99_us;
+    float period_mean_us;
+    float jitter_us;          // Standard deviation of the period
+    uint32_t rx[static_cast<size_t>(Port::count)];
+    float cpu_load[2];        // Share of each core's baseline idle time used up under load
+    uint32_t idle_rate[2];    // Idle hook runs per second in the baseline, compares scheduler modes
+    bool passed;              // Period limits held; RX loss is judged by the host
+};
+
+void start(uint32_t duration_ms);
+void stop();
+
+// Called at the start of every control cycle
+void control_tick();
+
+// Called by every UDP receive callback
+void count_rx(Port port);
+
+Report get_report();
+} // namespace stress
+
+#endif //STRESS_H
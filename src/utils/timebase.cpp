@@ -0,0 +1,125 @@
+#include "timebase.h"
+
+#include <esp_timer.h>
+
+#include "config/defines.h"
+#include "config/pinout.h"
+#include "log.h"
+
+namespace timebase {
+constexpr int64_t US_PER_WEEK = 604800LL * 1000000LL;
+
+static portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+// Written by the PPS interrupt
+static volatile int64_t pps_edge_us = 0;
+static volatile uint32_t pps_edges  = 0;
+
+// Reference pair and drift estimate, guarded by mux
+static bool has_reference = false;
+static int64_t ref_local_us = 0;
+static int64_t ref_gnss_us  = 0;
+static float drift          = 0.0f; // Fractional rate error
+static int32_t residual_us  = 0;
+static uint32_t pairings    = 0;
+
+// GNSS week continuity, only touched by the GNSS task
+static uint32_t last_itow_ms = 0;
+static int64_t week_base_us  = 0;
+
+static void IRAM_ATTR pps_isr() {
+    int64_t now = esp_timer_get_time();
+    portENTER_CRITICAL_ISR(&mux);
+    pps_edge_us = now;
+    pps_edges   = pps_edges + 1;
+    portEXIT_CRITICAL_ISR(&mux);
+}
+
+bool init() {
+    if (GPS_PPS_PIN < 0) {
+        debug("PPS not wired, timebase runs on the local clock");
+        return false;
+    }
+    pinMode(GPS_PPS_PIN, INPUT);
+    attachInterrupt(digitalPinToInterrupt(GPS_PPS_PIN), pps_isr, RISING);
+    debugf("PPS capture on GPIO %d", GPS_PPS_PIN);
+    return true;
+}
+
+static int64_t extrapolate(int64_t local_us) {
+    int64_t elapsed = local_us - ref_local_us;
+    return ref_gnss_us + elapsed + static_cast<int64_t>(elapsed * drift);
+}
+
+int64_t to_gnss(int64_t local_us) {
+    portENTER_CRITICAL(&mux);
+    int64_t gnss = has_reference ? extrapolate(local_us) : local_us;
+    portEXIT_CRITICAL(&mux);
+    return gnss;
+}
+
+int64_t now_gnss() {
+    return to_gnss(esp_timer_get_time());
+}
+
+bool synced() {
+    portENTER_CRITICAL(&mux);
+    bool result = has_reference && esp_timer_get_time() - ref_local_us < TIMEBASE_HOLDOVER * 1000LL;
+    portEXIT_CRITICAL(&mux);
+    return result;
+}
+
+void on_gnss_epoch(uint32_t itow_ms) {
+    if (itow_ms < last_itow_ms && last_itow_ms - itow_ms > 302400000UL) {
+        week_base_us += US_PER_WEEK; // Time of week wrapped
+    }
+    last_itow_ms = itow_ms;
+    if (itow_ms % 1000 != 0) {
+        return;
+    }
+
+    int64_t arrival = esp_timer_get_time();
+    portENTER_CRITICAL(&mux);
+    int64_t edge = pps_edge_us;
+    // The epoch message trails its PPS edge, an older edge belongs to a missed second
+    if (edge == 0 || arrival - edge <= 0 || arrival - edge >= 1000000LL) {
+        portEXIT_CRITICAL(&mux);
+        return;
+    }
+    int64_t gnss = week_base_us + static_cast<int64_t>(itow_ms) * 1000LL;
+    if (has_reference && edge != ref_local_us) {
+        int64_t local_delta = edge - ref_local_us;
+        int64_t gnss_delta  = gnss - ref_gnss_us;
+        residual_us         = static_cast<int32_t>(gnss - extrapolate(edge));
+        if (local_delta > 0 && gnss_delta > 0 && gnss_delta <= TIMEBASE_MAX_GAP * 1000LL) {
+            float sample = static_cast<float>(gnss_delta - local_delta) / local_delta;
+            drift += (sample - drift) * TIMEBASE_DRIFT_FILTER;
+        }
+    }
+    ref_local_us  = edge;
+    ref_gnss_us   = gnss;
+    has_reference = true;
+    pairings++;
+    portEXIT_CRITICAL(&mux);
+}
+
+Status get_status() {
+    Status status;
+    status.synced = synced();
+    portENTER_CRITICAL(&mux);
+    status.offset_us   = ref_gnss_us - ref_local_us;
+    status.drift_ppm   = drift * 1e6f;
+    status.residual_us = residual_us;
+    status.pps_edges   = pps_edges;
+    status.pairings    = pairings;
+    portEXIT_CRITICAL(&mux);
+    return status;
+}
+
+void print_status() {
+    Status status = get_status();
+    debugf("Timebase: synced=%d offset=%lldus drift=%.2fppm residual=%dus pps=%u pairings=%u",
+           status.synced, status.offset_us, status.drift_ppm, status.residual_us, status.pps_edges,
+           status.pairings);
+}
+} // namespace timebase
@@ -0,0 +1,35 @@
+#ifndef TIMEBASE_H
+#define TIMEBASE_H
+
+#include <Arduino.h>
+
+// Common timebase for sensor samples. The receiver's PPS edge is captured against
+// esp_timer_get_time() and paired with the top-of-second NAV-PVT epoch to estimate the
+// offset and drift of the local clock to GNSS time.
+namespace timebase {
+
+struct Status {
+    bool synced;          // A PPS edge was paired with GNSS time within TIMEBASE_HOLDOVER
+    int64_t offset_us;    // GNSS minus local time at the last pairing
+    float drift_ppm;      // Local clock rate error, positive when the local clock is slow
+    int32_t residual_us;  // Prediction error at the last pairing
+    uint32_t pps_edges;
+    uint32_t pairings;
+};
+
+bool init();
+
+// Microseconds of GNSS time (week-continuous time of week). Before the first pairing, or with
+// no PPS wired, this is local esp_timer time, check synced() before comparing with GNSS epochs.
+int64_t now_gnss();
+int64_t to_gnss(int64_t local_us);
+bool synced();
+
+// Called with each NAV-PVT epoch, whole-second epochs are paired with the latest PPS edge
+void on_gnss_epoch(uint32_t itow_ms);
+
+Status get_status();
+void print_status();
+} // namespace timebase
+
+#endif //TIMEBASE_H
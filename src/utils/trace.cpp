@@ -0,0 +1,86 @@
+#include "trace.h"
+
+#include <atomic>
+#include <esp_timer.h>
+#include <xtensa/core-macros.h>
+
+#include "config/defines.h"
+
+namespace trace {
+static_assert((TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) == 0, "Trace buffer size must be a power of two");
+
+static Event ring[TRACE_BUFFER_SIZE];
+static std::atomic<uint32_t> head{0};
+static std::atomic<bool> running{TRACE_ENABLED};
+static std::atomic<uint16_t> last_id{0};
+static std::atomic<uint16_t> last_published{0};
+
+void start() {
+    head.store(0);
+    running.store(true);
+}
+
+void stop() {
+    running.store(false);
+}
+
+bool is_running() {
+    return running.load(std::memory_order_relaxed);
+}
+
+uint16_t next_id() {
+    return last_id.fetch_add(1, std::memory_order_relaxed) + 1;
+}
+
+uint16_t rx_id() {
+    return last_id.load(std::memory_order_relaxed);
+}
+
+uint16_t published_id() {
+    return last_published.load(std::memory_order_relaxed);
+}
+
+void publish(uint16_t id) {
+    last_published.store(id, std::memory_order_relaxed);
+}
+
+void IRAM_ATTR record(Point point, uint16_t id) {
+    if (!running.load(std::memory_order_relaxed)) {
+        return;
+    }
+    uint32_t slot = head.fetch_add(1, std::memory_order_relaxed) % TRACE_BUFFER_SIZE;
+    Event &event  = ring[slot];
+    event.time_us = static_cast<uint32_t>(esp_timer_get_time());
+    event.cycles  = XTHAL_GET_CCOUNT();
+    event.id      = id;
+    event.point   = static_cast<uint8_t>(point);
+    event.core    = static_cast<uint8_t>(xPortGetCoreID());
+}
+
+size_t dump(void (*sink)(const Event &event, void *context), void *context) {
+    bool was_running = running.exchange(false);
+    // Let writers that already claimed a slot finish
+    delayMicroseconds(50);
+
+    uint32_t written = head.load();
+    size_t count     = written < TRACE_BUFFER_SIZE ? written : TRACE_BUFFER_SIZE;
+    uint32_t first   = written - count;
+    for (size_t i = 0; i < count; i++) {
+        sink(ring[(first + i) % TRACE_BUFFER_SIZE], context);
+    }
+
+    running.store(was_running);
+    return count;
+}
+
+void encode(const Event &event, uint8_t *buf) {
+    for (int i = 0; i < 4; i++) {
+        buf[i]     = (event.time_us >> (8 * i)) & 0xFF;
+        buf[4 + i] = (event.cycles >> (8 * i)) & 0xFF;
+    }
+    buf[8]  = event.id & 0xFF;
+    buf[9]  = event.id >> 8;
+    buf[10] = event.point;
+    buf[11] = event.core;
+}
+} // namespace trace
@@ -0,0 +1,54 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <Arduino.h>
+
+// Latency tracing from steer packet arrival to PWM output. Static trace points write
+// fixed-size events into a RAM ring; the diagnostics port dumps it and
+// tools/trace_convert.py turns the dump into Chrome/Perfetto trace JSON.
+namespace trace {
+
+enum class Point : uint8_t {
+    packet_rx,        // Autosteer datagram entered the UDP callback
+    parse,            // PGN 254 decoded
+    setpoint_publish, // New set point handed to the conditioner
+    control_start,    // First control cycle after a new set point
+    was_sample,       // WAS reading used by that cycle
+    pwm_write,        // Motor output applied
+    response_tx,      // PGN 253 sent
+    count
+};
+
+// Event as stored and dumped (little-endian, 12 bytes)
+struct Event {
+    uint32_t time_us; // esp_timer, comparable across cores
+    uint32_t cycles;  // CPU cycle counter of the recording core
+    uint16_t id;      // Correlation ID of the packet the event belongs to
+    uint8_t point;
+    uint8_t core;
+};
+
+constexpr size_t EVENT_SIZE = 12;
+
+void start();
+void stop();
+bool is_running();
+
+// New correlation ID for an arriving packet, and the ID of the packet being handled.
+// Receive callbacks run one at a time, so handlers can pick up the ID with rx_id().
+uint16_t next_id();
+uint16_t rx_id();
+// ID of the last published set point, the control loop tags its events with it
+uint16_t published_id();
+void publish(uint16_t id);
+
+void record(Point point, uint16_t id);
+
+// Hand every stored event to sink, oldest first. Tracing is paused meanwhile.
+size_t dump(void (*sink)(const Event &event, void *context), void *context);
+
+// Little-endian wire form of an event, buf holds EVENT_SIZE bytes
+void encode(const Event &event, uint8_t *buf);
+} // namespace trace
+
+#endif //TRACE_H
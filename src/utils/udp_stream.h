@@ -1,14 +1,14 @@
 #pragma once
 
 #include <Arduino.h>
-#include <AsyncUDP.h>
 #include <Stream.h>
 
-#include "w6100/esp32_sc_w6100.h"
+#include "network/udp_tx.h"
 
+// Lines go out through the preallocated udp_tx pool, logging never allocates a pbuf
 class UDPStream : public Stream {
 private:
-    AsyncUDP udp;
+    udp_tx::PooledAsyncUDP udp;
     IPAddress broadcastAddress;
     uint16_t port;
     bool initialized;
@@ -35,7 +35,7 @@ public:
     void flush() override { 
         // Send any buffered data
         if (initialized && bufferIndex) {
-            udp.broadcastTo((uint8_t*)buffer, bufferIndex, port);
+            udp_tx::send(udp, udp_tx::Port::log, port, buffer, bufferIndex);
             bufferIndex = 0; // Reset buffer index after sending
         }
     }
@@ -48,7 +48,7 @@ public:
             
             // If we get a newline, send the buffer
             if (c == '\n' || bufferIndex >= bufferSize) {
-                udp.writeTo(buffer, bufferIndex,ETH.broadcastIP(), port);
+                udp_tx::send(udp, udp_tx::Port::log, port, buffer, bufferIndex);
                 bufferIndex = 0; // Reset buffer index after sending
             }
             return 1;
@@ -58,7 +58,7 @@ public:
 
     size_t write(uint8_t *buffer, size_t size) {
         if (initialized) {
-            udp.broadcastTo(buffer, size, port);
+            udp_tx::send(udp, udp_tx::Port::log, port, buffer, size);
             return size;
         }
         return 0;
@@ -0,0 +1,187 @@
+#include <unity.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Runs the firmware's own scheduling and PID code. Those sources are compiled here rather
+// than through build_src_filter, so the other native tests need no settings stubs.
+#include "autosteer/gain_schedule.cpp"
+#include "autosteer/pid_controller.cpp"
+
+// Regression test for gain_schedule::get and calcSteeringPID. The bundled regression_fixture.csv
+// is not field data: it was generated from a model of this controller, sweeping 0.5-24.5 km/h
+// across the FIXTURE_SCHEDULE below, and the recomputed terms must match it up to its rounding.
+// Any change to the schedule interpolation or the PID terms shows up as a mismatch.
+//
+// A telemetry capture (CSV from tools/telemetry_decode.py) can be run through the same code
+// instead. It is not checked against the recorded output, the test only reports how far the
+// output moves:
+//
+//   TELEMETRY_CSV=run.csv pio test -e native -f test_gain_regression -v
+//   REPLAY_SCHEDULE="2:40:20:150:15:2.0,8:60:30:200:20:1.5" to try another table
+//
+// REPLAY_SCHEDULE points are speed km/h:P:low PWM:max PWM:min PWM:FF PWM per deg/s, in speed
+// order. "none" runs with the AOG steer settings.
+
+static const char FIXTURE_SCHEDULE[] = "2:40:20:150:15:2.0,8:60:30:200:20:1.5,20:30:25:120:18:0.5";
+
+Storage Set;
+static GainSchedule replay_schedule;
+
+namespace settings {
+    GainSchedule getSchedule() {
+        return replay_schedule;
+    }
+}
+
+struct Row {
+    float error;
+    float setPointRate;
+    float speed;
+    float pTerm;
+    float ffTerm;
+    float pwmLimit;
+    int output;
+};
+
+static std::string fixturePath() {
+    std::string path = __FILE__;
+    size_t slash     = path.find_last_of("/\\");
+    return (slash == std::string::npos ? std::string() : path.substr(0, slash + 1)) + "regression_fixture.csv";
+}
+
+static bool parseSchedule(const char *text, GainSchedule &table) {
+    table = GainSchedule{};
+    if (strcmp(text, "none") == 0) {
+        return true;
+    }
+    std::stringstream points(text);
+    std::string point;
+    while (std::getline(points, point, ',')) {
+        float speed, ff;
+        unsigned p, low, max, min;
+        if (table.count >= GAIN_SCHEDULE_MAX_POINTS ||
+            sscanf(point.c_str(), "%f:%u:%u:%u:%u:%f", &speed, &p, &low, &max, &min, &ff) != 6) {
+            return false;
+        }
+        GainPoint &entry = table.points[table.count++];
+        entry.speed      = static_cast<uint16_t>(std::lround(speed * 10.0f));
+        entry.gainP      = p;
+        entry.lowPWM     = low;
+        entry.maxPWM     = max;
+        entry.minPWM     = min;
+        entry.ffGain     = static_cast<uint8_t>(std::lround(ff * 10.0f));
+    }
+    return table.count > 0;
+}
+
+static std::vector<std::string> split(const std::string &line) {
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ',')) {
+        if (!field.empty() && field.back() == '\r') {
+            field.pop_back();
+        }
+        fields.push_back(field);
+    }
+    return fields;
+}
+
+static bool loadCapture(const std::string &path, std::vector<Row> &rows) {
+    std::ifstream file(path);
+    std::string line;
+    if (!file || !std::getline(file, line)) {
+        return false;
+    }
+    const char *names[] = {"error", "set_point_rate", "speed", "p_term", "ff_term", "pwm_limit", "output"};
+    int column[7];
+    std::vector<std::string> header = split(line);
+    for (int i = 0; i < 7; i++) {
+        column[i] = -1;
+        for (size_t c = 0; c < header.size(); c++) {
+            if (header[c] == names[i]) column[i] = static_cast<int>(c);
+        }
+        if (column[i] < 0) {
+            printf("Capture has no %s column\n", names[i]);
+            return false;
+        }
+    }
+    while (std::getline(file, line)) {
+        std::vector<std::string> fields = split(line);
+        if (fields.size() < header.size()) {
+            continue;
+        }
+        rows.push_back({strtof(fields[column[0]].c_str(), nullptr), strtof(fields[column[1]].c_str(), nullptr),
+                        strtof(fields[column[2]].c_str(), nullptr), strtof(fields[column[3]].c_str(), nullptr),
+                        strtof(fields[column[4]].c_str(), nullptr), strtof(fields[column[5]].c_str(), nullptr),
+                        atoi(fields[column[6]].c_str())});
+    }
+    return !rows.empty();
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_regression_fixture() {
+    const char *capture  = getenv("TELEMETRY_CSV");
+    const char *schedule = getenv("REPLAY_SCHEDULE");
+    bool fixture         = capture == nullptr && schedule == nullptr;
+
+    // "none" falls back to these, as after a fresh install
+    SteerSettings defaults;
+    Set.gainP  = defaults.gainP;
+    Set.lowPWM = defaults.lowPWM;
+    Set.maxPWM = defaults.highPWM;
+    Set.minPWM = defaults.minPWM;
+
+    std::vector<Row> rows;
+    std::string path = capture ? capture : fixturePath();
+    TEST_ASSERT_TRUE(loadCapture(path, rows));
+    TEST_ASSERT_TRUE(parseSchedule(schedule ? schedule : FIXTURE_SCHEDULE, replay_schedule));
+
+    uint32_t changed = 0, saturated = 0;
+    float max_delta = 0.0f, sum_abs = 0.0f;
+    for (const Row &row: rows) {
+        gain_schedule::Gains gains = gain_schedule::get(row.speed);
+        PidTerms terms;
+        int output = calcSteeringPID(row.error, row.setPointRate, gains, &terms);
+
+        // The limit holds for every table, the output never leaves it
+        TEST_ASSERT_TRUE(std::fabs(static_cast<float>(output)) <= terms.limit);
+        TEST_ASSERT_TRUE(terms.limit <= gains.maxPWM + 0.01f);
+
+        float delta = std::fabs(static_cast<float>(output - row.output));
+        changed += delta > 1.0f;
+        saturated += std::fabs(static_cast<float>(output)) >= terms.limit - 1.0f;
+        max_delta = delta > max_delta ? delta : max_delta;
+        sum_abs += std::fabs(static_cast<float>(output));
+
+        // The fixture is rounded to 6 digits, so the output may truncate one count apart
+        if (fixture) {
+            TEST_ASSERT_FLOAT_WITHIN(0.01f + std::fabs(row.pTerm) * 1e-4f, row.pTerm, terms.p);
+            TEST_ASSERT_FLOAT_WITHIN(0.01f + std::fabs(row.ffTerm) * 1e-4f, row.ffTerm, terms.ff);
+            TEST_ASSERT_FLOAT_WITHIN(0.01f, row.pwmLimit, terms.limit);
+            TEST_ASSERT_INT_WITHIN(1, row.output, output);
+        }
+    }
+
+    char message[200];
+    snprintf(message, sizeof(message),
+             "%s: %u rows, mean |output| %.1f, %.1f%% at the PWM limit, %u rows moved more than 1 (max %.0f)",
+             path.c_str(), static_cast<unsigned>(rows.size()), sum_abs / rows.size(),
+             100.0f * saturated / rows.size(), changed, max_delta);
+    TEST_MESSAGE(message);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_regression_fixture);
+    return UNITY_END();
+}
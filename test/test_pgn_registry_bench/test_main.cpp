@@ -0,0 +1,143 @@
+#include <unity.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "autosteer/steer_pgns.h"
+#include "autosteer/udp_io.h"
+
+// Throughput of pgn::validate plus handler dispatch over a mixed packet corpus.
+// The table comes from the same makeSteerTable list as udp_io.cpp, with handlers that only read
+// a field so the numbers measure the registry and not the control code. BENCH_PACKETS overrides the count.
+
+static uint32_t dispatched[256];
+static uint32_t sink;
+
+static void readSteer(const PacketView &packet, const ip_address &) {
+    sink += packet.u16(0) + packet.i16(3);
+    dispatched[packet.pgn()]++;
+}
+
+static void readByte(const PacketView &packet, const ip_address &) {
+    sink += packet.u8(0);
+    dispatched[packet.pgn()]++;
+}
+
+constexpr auto benchTable =
+    pgn::makeSteerTable({readSteer, readByte, readByte, readByte, readByte, readByte, readByte});
+
+struct Sample {
+    uint8_t data[64];
+    size_t len;
+    pgn::Result expected;
+};
+
+static Sample corpus[32];
+static size_t corpus_size = 0;
+
+static Sample &frame(uint8_t pgn_id, uint8_t length, pgn::Result expected) {
+    Sample &sample = corpus[corpus_size++];
+    uint8_t *data  = sample.data;
+    data[0]        = AOG_HEADER[0];
+    data[1]        = AOG_HEADER[1];
+    data[2]        = AOG_HEADER[2];
+    data[AOG_PGN_OFFSET]    = pgn_id;
+    data[AOG_LENGTH_OFFSET] = length;
+    for (uint8_t i = 0; i < length; i++) {
+        data[AOG_PAYLOAD_OFFSET + i] = static_cast<uint8_t>(pgn_id * 7 + i * 13);
+    }
+    data[AOG_PAYLOAD_OFFSET + length] =
+        calculateCRC(data + INCOMING_CRC_START_BYTE, AOG_PAYLOAD_OFFSET + length - INCOMING_CRC_START_BYTE);
+    sample.len      = AOG_PAYLOAD_OFFSET + length + 1;
+    sample.expected = expected;
+    return sample;
+}
+
+// Roughly what the steer port sees: mostly PGN 254 at the guidance rate, the module's own
+// broadcasts echoed back, AgIO housekeeping and the occasional damaged or foreign frame.
+static void buildCorpus() {
+    corpus_size = 0;
+    for (int i = 0; i < 12; i++) {
+        frame(PGN_STEER_DATA, SteerData_payload_len, pgn::Result::ok);
+    }
+    for (int i = 0; i < 4; i++) {
+        Sample &sample = corpus[corpus_size++];
+        sample.len      = writeAutoSteerPacket(sample.data, sizeof(sample.data), -3.5f * i, 90.0f, 1.0f, true, false, 40);
+        sample.expected = pgn::Result::ok;
+    }
+    frame(PGN_FROM_AUTOSTEER2, PAYLOAD_LENGTH, pgn::Result::ok);
+    frame(PGN_CORRECTED_POSITION, 16, pgn::Result::ok);
+    frame(PGN_CORRECTED_POSITION, 16, pgn::Result::ok);
+    frame(PGN_FROM_MACHINE, MachineData_payload_len, pgn::Result::ok);
+    frame(PGN_64_SECTIONS, Sections64_payload_len, pgn::Result::ok);
+    frame(PGN_HELLO_MODULE, HelloModule_payload_len, pgn::Result::ok);
+    frame(PGN_STEER_SETTINGS, SteerSettings_payload_len, pgn::Result::ok);
+    frame(PGN_STEER_CONFIG, SteerConfig_payload_len, pgn::Result::ok);
+    frame(PGN_GAIN_SCHEDULE, GainSchedule_payload_len, pgn::Result::ok);
+
+    frame(PGN_STEER_DATA, SteerData_payload_len, pgn::Result::bad_crc).data[AOG_PAYLOAD_OFFSET] ^= 0x55;
+    frame(0x42, 8, pgn::Result::unknown_pgn);
+    frame(PGN_STEER_DATA, SteerData_payload_len, pgn::Result::bad_header).data[1] = 0x00;
+    frame(PGN_STEER_SETTINGS, 4, pgn::Result::bad_length);
+    frame(PGN_STEER_DATA, SteerData_payload_len, pgn::Result::incomplete).len -= 3;
+    frame(PGN_STEER_DATA, SteerData_payload_len, pgn::Result::too_short).len = 4;
+}
+
+void setUp() {
+    buildCorpus();
+    memset(dispatched, 0, sizeof(dispatched));
+}
+
+void tearDown() {}
+
+static bool process(const Sample &sample, pgn::Result &result) {
+    const pgn::Entry *entry = nullptr;
+    result                  = pgn::validate(benchTable, sample.data, sample.len, entry);
+    if (result == pgn::Result::ok) {
+        entry->handler(PacketView(sample.data, sample.len), ip_address{});
+        return true;
+    }
+    return false;
+}
+
+// Every sample classifies as intended, otherwise the throughput number is meaningless
+void test_corpus_classification() {
+    for (size_t i = 0; i < corpus_size; i++) {
+        pgn::Result result;
+        process(corpus[i], result);
+        TEST_ASSERT_EQUAL_INT(static_cast<int>(corpus[i].expected), static_cast<int>(result));
+    }
+}
+
+void test_throughput() {
+    const char *env      = getenv("BENCH_PACKETS");
+    const uint32_t total = env ? strtoul(env, nullptr, 10) : 5000000;
+    uint32_t accepted    = 0;
+    uint32_t expected    = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < total; i++) {
+        pgn::Result result;
+        accepted += process(corpus[i % corpus_size], result);
+    }
+    auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (uint32_t i = 0; i < total; i++) {
+        expected += corpus[i % corpus_size].expected == pgn::Result::ok;
+    }
+    TEST_ASSERT_EQUAL_UINT(expected, accepted);
+
+    char message[160];
+    snprintf(message, sizeof(message), "%u packets (%u dispatched) in %.3f s: %.2f M packets/s, %.1f ns/packet (sink %u)",
+             total, accepted, elapsed, total / elapsed / 1e6, elapsed * 1e9 / total, sink);
+    TEST_MESSAGE(message);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_corpus_classification);
+    RUN_TEST(test_throughput);
+    return UNITY_END();
+}
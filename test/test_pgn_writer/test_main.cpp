@@ -0,0 +1,112 @@
+#include <unity.h>
+
+#include "autosteer/pgn_writer.h"
+#include "autosteer/udp_io.h"
+
+// Reference frames as AgIO receives them from the reference steer module:
+// 0x80 0x81 source pgn length payload... crc, with the CRC summed from the source byte.
+
+static const uint8_t AUTOSTEER_NEGATIVE[] = {0x80, 0x81, 0x7F, 0xFD, 0x08, 0x2E, 0xFB, 0x9B, 0x0A,
+                                             0xE0, 0xFF, 0x02, 0xC8, 0xFB};
+static const uint8_t AUTOSTEER_POSITIVE[] = {0x80, 0x81, 0x7F, 0xFD, 0x08, 0x94, 0x11, 0x00, 0x00,
+                                             0x0F, 0x00, 0x00, 0x00, 0x38};
+static const uint8_t AUTOSTEER2[]         = {0x80, 0x81, 0x7F, 0xFA, 0x08, 0x4D, 0x00, 0x00, 0x00,
+                                             0x00, 0x00, 0x00, 0x00, 0xCE};
+static const uint8_t HELLO_REPLY[]        = {0x80, 0x81, 0x7E, 0x7E, 0x05, 0xDA, 0xFD, 0xC4, 0x0B, 0x03, 0xAA};
+static const uint8_t SUBNET_REPLY[]       = {0x80, 0x81, 0x7E, 0xCB, 0x07, 0xC0, 0xA8, 0x05,
+                                             0x7E, 0xC0, 0xA8, 0x05, 0xA8};
+
+void setUp() {}
+void tearDown() {}
+
+// angle -12.34, heading 271.5, roll -3.2, work switch on, steer switch off, PWM 200
+void test_autosteer_negative_angle() {
+    uint8_t buf[64];
+    size_t len = writeAutoSteerPacket(buf, sizeof(buf), -12.34f, 271.5f, -3.2f, true, false, 200);
+    TEST_ASSERT_EQUAL_UINT(sizeof(AUTOSTEER_NEGATIVE), len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(AUTOSTEER_NEGATIVE, buf, len);
+}
+
+// angle 45.0, heading 0, roll 1.5, both switches on
+void test_autosteer_positive_angle() {
+    uint8_t buf[64];
+    size_t len = writeAutoSteerPacket(buf, sizeof(buf), 45.0f, 0.0f, 1.5f, true, true, 0);
+    TEST_ASSERT_EQUAL_UINT(sizeof(AUTOSTEER_POSITIVE), len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(AUTOSTEER_POSITIVE, buf, len);
+}
+
+// Bits are set when the switch is off: bit 0 work, bit 1 steer
+void test_switch_byte() {
+    const bool work[]       = {true, false, true, false};
+    const bool steer[]      = {true, true, false, false};
+    const uint8_t expected[] = {0x00, 0x01, 0x02, 0x03};
+    for (int i = 0; i < 4; i++) {
+        uint8_t buf[64];
+        writeAutoSteerPacket(buf, sizeof(buf), 0.0f, 0.0f, 0.0f, work[i], steer[i], 0);
+        TEST_ASSERT_EQUAL_HEX8(expected[i], buf[11]);
+        writeHelloReplyPacket(buf, sizeof(buf), 0.0f, 0, work[i], steer[i]);
+        TEST_ASSERT_EQUAL_HEX8(expected[i], buf[9]);
+    }
+}
+
+void test_autosteer2() {
+    uint8_t buf[64];
+    size_t len = writeAutoSteer2Packet(buf, sizeof(buf), 77);
+    TEST_ASSERT_EQUAL_UINT(sizeof(AUTOSTEER2), len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(AUTOSTEER2, buf, len);
+}
+
+// angle -5.5, 3012 WAS counts, both switches off
+void test_hello_reply() {
+    uint8_t buf[64];
+    size_t len = writeHelloReplyPacket(buf, sizeof(buf), -5.5f, 3012, false, false);
+    TEST_ASSERT_EQUAL_UINT(sizeof(HELLO_REPLY), len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(HELLO_REPLY, buf, len);
+}
+
+// Module 192.168.5.126, AgIO 192.168.5.10
+void test_subnet_reply() {
+    uint8_t buf[64];
+    size_t len = writeSubnetReplyPacket(buf, sizeof(buf), ip_address{{192, 168, 5, 126}}, ip_address{{192, 168, 5, 10}});
+    TEST_ASSERT_EQUAL_UINT(sizeof(SUBNET_REPLY), len);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(SUBNET_REPLY, buf, len);
+}
+
+// CRC matches the receive-side helper over the same bytes
+void test_crc_matches_calculate_crc() {
+    uint8_t buf[64];
+    size_t len = writeAutoSteerPacket(buf, sizeof(buf), -12.34f, 271.5f, -3.2f, true, false, 200);
+    TEST_ASSERT_EQUAL_HEX8(calculateCRC(buf + OUTGOING_CRC_START_BYTE, len - OUTGOING_CRC_START_BYTE - 1), buf[len - 1]);
+}
+
+// Out-of-range and NaN values saturate instead of wrapping
+void test_fixed16_saturates() {
+    uint8_t buf[64];
+    writeAutoSteerPacket(buf, sizeof(buf), 400.0f, NAN, -5000.0f, true, true, 0);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, buf[5]);
+    TEST_ASSERT_EQUAL_HEX8(0x7F, buf[6]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, buf[7]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, buf[8]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, buf[9]);
+    TEST_ASSERT_EQUAL_HEX8(0x80, buf[10]);
+}
+
+void test_capacity_too_small() {
+    uint8_t buf[64];
+    TEST_ASSERT_EQUAL_UINT(0, writeAutoSteerPacket(buf, AutoSteerData_len - 1, 0.0f, 0.0f, 0.0f, true, true, 0));
+    TEST_ASSERT_EQUAL_UINT(0, writeSubnetReplyPacket(nullptr, sizeof(buf), ip_address{}, ip_address{}));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_autosteer_negative_angle);
+    RUN_TEST(test_autosteer_positive_angle);
+    RUN_TEST(test_switch_byte);
+    RUN_TEST(test_autosteer2);
+    RUN_TEST(test_hello_reply);
+    RUN_TEST(test_subnet_reply);
+    RUN_TEST(test_crc_matches_calculate_crc);
+    RUN_TEST(test_fixed16_saturates);
+    RUN_TEST(test_capacity_too_small);
+    return UNITY_END();
+}
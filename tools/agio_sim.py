@@ -0,0 +1,268 @@
+#!/usr/bin/env python3
+"""Stand-in for AgIO when benchmarking the steer module's network path.
+
+Sends Hello (200), Scan (202), Steer Data (254), Steer Settings (252) and Steer Config (251)
+to the module at configurable rates, with jitter and simulated loss. Listens for the module's
+PGN 253, 250, 126 and 203 replies and reports reply rates, CRC failures and round-trip latency
+histograms. The packet layouts follow src/autosteer/networking.h and packet_view.h.
+
+    python tools/agio_sim.py --target 192.168.178.126 --duration 30
+    python tools/agio_sim.py --target 127.0.0.1 --steer-rate 20 --jitter 15 --loss 0.05
+
+The module answers to the AgIO port (9999) on the broadcast or learned unicast address, so run
+this on a host of the module's subnet with nothing else bound to that port.
+"""
+
+import argparse
+import collections
+import math
+import random
+import select
+import socket
+import struct
+import sys
+import time
+
+STEER_PORT = 8888
+AGIO_PORT = 9999
+
+HEADER = bytes([0x80, 0x81, 0x7F])
+
+PGN_STEER_DATA = 254
+PGN_STEER_SETTINGS = 252
+PGN_STEER_CONFIG = 251
+PGN_FROM_AUTOSTEER = 253
+PGN_FROM_AUTOSTEER2 = 250
+PGN_HELLO_MODULE = 200
+PGN_HELLO_REPLY = 126
+PGN_SCAN_REQUEST = 202
+PGN_SUBNET_REPLY = 203
+
+# Reply expected for each request, used to pair round trips
+REPLY_FOR = {
+    PGN_STEER_DATA: PGN_FROM_AUTOSTEER,
+    PGN_HELLO_MODULE: PGN_HELLO_REPLY,
+    PGN_SCAN_REQUEST: PGN_SUBNET_REPLY,
+}
+
+HISTOGRAM_BUCKETS_MS = [0.5, 1, 2, 5, 10, 20, 50, 100, 200]
+
+
+def crc(frame):
+    """AOG sum CRC over source, PGN, length and payload."""
+    return sum(frame[2:]) & 0xFF
+
+
+def frame(pgn, payload):
+    body = HEADER + bytes([pgn, len(payload)]) + payload
+    return body + bytes([crc(body)])
+
+
+def hello():
+    # AgIO sends a fixed CRC byte on hello and scan
+    return HEADER + bytes([PGN_HELLO_MODULE, 3, 56, 0, 0, 0x47])
+
+
+def scan():
+    return HEADER + bytes([PGN_SCAN_REQUEST, 3, 202, 202, 5, 0x47])
+
+
+def steer_data(speed_kmh, status, angle_deg, xte=0, section_lo=0, section_hi=0):
+    payload = struct.pack("<HBhBBB", int(round(speed_kmh * 10)), status, int(round(angle_deg * 100)),
+                          xte, section_lo, section_hi)
+    return frame(PGN_STEER_DATA, payload)
+
+
+def steer_settings(gain_p, high_pwm, low_pwm, min_pwm, counts, was_offset, ackerman):
+    payload = struct.pack("<BBBBBhB", gain_p, high_pwm, low_pwm, min_pwm, counts, was_offset, ackerman)
+    return frame(PGN_STEER_SETTINGS, payload)
+
+
+def steer_config(setting0=0, pulse_count_max=3, was_speed=0, setting1=0):
+    payload = bytes([setting0, pulse_count_max, was_speed, setting1, 0, 0, 0, 0])
+    return frame(PGN_STEER_CONFIG, payload)
+
+
+class Stream:
+    """One periodic packet source with jitter and simulated loss."""
+
+    def __init__(self, name, rate_hz, build, jitter_ms, loss):
+        self.name = name
+        self.period = 1.0 / rate_hz if rate_hz > 0 else None
+        self.build = build
+        self.jitter = jitter_ms / 1000.0
+        self.loss = loss
+        self.next_time = time.monotonic()
+        self.sent = 0
+        self.dropped = 0
+
+    def due(self, now):
+        return self.period is not None and now >= self.next_time
+
+    def schedule(self):
+        self.next_time += self.period + random.uniform(-self.jitter, self.jitter)
+
+
+class Stats:
+    def __init__(self):
+        self.replies = collections.Counter()
+        self.crc_failures = 0
+        self.malformed = 0
+        self.rtt = collections.defaultdict(list)
+        self.pending = collections.defaultdict(collections.deque)
+        self.unmatched = collections.Counter()
+
+    def sent(self, pgn, when):
+        reply = REPLY_FOR.get(pgn)
+        if reply is not None:
+            self.pending[reply].append(when)
+
+    def received(self, data, when, timeout):
+        if len(data) < 6 or data[0] != 0x80 or data[1] != 0x81:
+            self.malformed += 1
+            return
+        pgn, length = data[3], data[4]
+        if len(data) != length + 6:
+            self.malformed += 1
+            return
+        if crc(data[:-1]) != data[-1]:
+            self.crc_failures += 1
+            return
+        self.replies[pgn] += 1
+
+        # Replies come in request order; requests older than the timeout were lost
+        queue = self.pending.get(pgn)
+        while queue and when - queue[0] > timeout:
+            queue.popleft()
+            self.unmatched[pgn] += 1
+        if queue:
+            self.rtt[pgn].append((when - queue.popleft()) * 1000.0)
+
+
+def histogram(samples):
+    counts = [0] * (len(HISTOGRAM_BUCKETS_MS) + 1)
+    for value in samples:
+        for i, bound in enumerate(HISTOGRAM_BUCKETS_MS):
+            if value <= bound:
+                counts[i] += 1
+                break
+        else:
+            counts[-1] += 1
+    width = max(counts) or 1
+    lines = []
+    labels = [f"<={b}ms" for b in HISTOGRAM_BUCKETS_MS] + [f">{HISTOGRAM_BUCKETS_MS[-1]}ms"]
+    for label, count in zip(labels, counts):
+        lines.append(f"    {label:>9s} {count:7d} {'#' * int(40 * count / width)}")
+    return "\n".join(lines)
+
+
+def percentile(samples, fraction):
+    ordered = sorted(samples)
+    return ordered[min(len(ordered) - 1, int(len(ordered) * fraction))]
+
+
+def report(streams, stats, elapsed):
+    print(f"\n{elapsed:.1f} s")
+    for stream in streams:
+        if stream.period is not None:
+            print(f"  sent {stream.name:9s} {stream.sent:7d} ({stream.sent / elapsed:6.1f}/s), "
+                  f"{stream.dropped} dropped by --loss")
+    for pgn, count in sorted(stats.replies.items()):
+        print(f"  reply {pgn:3d}       {count:7d} ({count / elapsed:6.1f}/s)")
+    print(f"  crc failures {stats.crc_failures}, malformed {stats.malformed}")
+    for pgn, samples in sorted(stats.rtt.items()):
+        if not samples:
+            continue
+        print(f"  round trip to {pgn}: n={len(samples)} min={min(samples):.2f}ms "
+              f"p50={percentile(samples, 0.5):.2f}ms p95={percentile(samples, 0.95):.2f}ms "
+              f"p99={percentile(samples, 0.99):.2f}ms max={max(samples):.2f}ms "
+              f"unanswered={stats.unmatched[pgn]}")
+        print(histogram(samples))
+
+
+def build_streams(args):
+    start = time.monotonic()
+
+    def steer():
+        t = time.monotonic() - start
+        angle = args.amplitude * math.sin(2 * math.pi * t / args.period) if args.period > 0 else args.amplitude
+        return steer_data(args.speed, 1 if args.engage else 0, angle)
+
+    return [
+        Stream("hello", args.hello_rate, hello, 0, 0),
+        Stream("scan", args.scan_rate, scan, 0, 0),
+        Stream("steer", args.steer_rate, steer, args.jitter, args.loss),
+        Stream("settings", args.settings_rate,
+               lambda: steer_settings(args.gain_p, 200, 60, 25, 100, 0, 100), 0, 0),
+        Stream("config", args.config_rate, steer_config, 0, 0),
+    ]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--target", required=True, help="module address, 127.0.0.1 for a local build")
+    parser.add_argument("--steer-port", type=int, default=STEER_PORT)
+    parser.add_argument("--listen-port", type=int, default=AGIO_PORT)
+    parser.add_argument("--duration", type=float, default=10.0)
+    parser.add_argument("--steer-rate", type=float, default=10.0, help="PGN 254 per second")
+    parser.add_argument("--hello-rate", type=float, default=1.0)
+    parser.add_argument("--scan-rate", type=float, default=0.2)
+    parser.add_argument("--settings-rate", type=float, default=0.2)
+    parser.add_argument("--config-rate", type=float, default=0.1)
+    parser.add_argument("--jitter", type=float, default=0.0, help="+- ms on steer packet spacing")
+    parser.add_argument("--loss", type=float, default=0.0, help="fraction of steer packets not sent")
+    parser.add_argument("--speed", type=float, default=8.0, help="km/h")
+    parser.add_argument("--amplitude", type=float, default=5.0, help="set point sine amplitude, degrees")
+    parser.add_argument("--period", type=float, default=4.0, help="set point sine period, s; 0 holds")
+    parser.add_argument("--gain-p", type=int, default=40)
+    parser.add_argument("--engage", action="store_true", help="set the guidance status bit")
+    parser.add_argument("--timeout", type=float, default=0.5, help="seconds before a request counts as lost")
+    args = parser.parse_args()
+
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+    sock.bind(("", args.listen_port))
+    sock.setblocking(False)
+
+    streams = build_streams(args)
+    stats = Stats()
+    destination = (args.target, args.steer_port)
+    start = time.monotonic()
+    try:
+        while time.monotonic() - start < args.duration:
+            now = time.monotonic()
+            for stream in streams:
+                if not stream.due(now):
+                    continue
+                stream.schedule()
+                if stream.loss and random.random() < stream.loss:
+                    stream.dropped += 1
+                    continue
+                packet = stream.build()
+                sock.sendto(packet, destination)
+                stream.sent += 1
+                stats.sent(packet[3], time.monotonic())
+
+            # Wait for replies until the next packet is due, stamping them as they arrive
+            wake = min((s.next_time for s in streams if s.period is not None), default=now + 0.01)
+            while True:
+                readable, _, _ = select.select([sock], [], [], max(0.0, wake - time.monotonic()))
+                if not readable:
+                    break
+                try:
+                    data, _ = sock.recvfrom(2048)
+                except BlockingIOError:
+                    continue
+                stats.received(data, time.monotonic(), args.timeout)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        sock.close()
+
+    report(streams, stats, time.monotonic() - start)
+    return 1 if stats.crc_failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
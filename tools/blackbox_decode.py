@@ -0,0 +1,183 @@
+#!/usr/bin/env python3
+"""Fetch and decode black box segments.
+
+Lists the module's segments over HTTP, downloads the ones asked for and writes one row per
+record to CSV, or to Parquet when pandas and pyarrow are installed. Stored segment files can
+be decoded offline. The layout matches src/utils/blackbox.h.
+
+    python tools/blackbox_decode.py --host 192.168.178.126 --list
+    python tools/blackbox_decode.py --host 192.168.178.126 --last 5 -o session.csv --save segments/
+    python tools/blackbox_decode.py --host 192.168.178.126 --at 14:32 --window 120 -o wander.csv
+    python tools/blackbox_decode.py segments/*.bin -o session.csv
+
+--at picks records by UTC time of day and needs GNSS-synced records (synced column).
+"""
+
+import argparse
+import csv
+import json
+import os
+import struct
+import sys
+import urllib.request
+
+HEADER = struct.Struct("<2sBBIIHH")
+RECORD = struct.Struct("<IIhhHhhhHHBBBx")
+VERSION = 1
+
+COLUMNS = [
+    "segment", "boot", "time_ms", "gnss_tow_ms", "utc", "set_point", "actual", "heading", "roll", "pitch",
+    "output", "guidance_age_ms", "speed", "pwm", "steer", "work", "enabled", "reversed", "synced", "link_state",
+]
+
+LINK_STATES = ["waiting", "fresh", "grace", "lost"]
+
+SWITCH_STEER = 0x01
+SWITCH_WORK = 0x02
+SWITCH_ENABLED = 0x04
+SWITCH_REVERSED = 0x08
+SWITCH_SYNCED = 0x10
+
+GPS_UTC_LEAP_SECONDS = 18
+DAY_MS = 86400 * 1000
+
+
+def utc_of_day(tow_ms):
+    """Seconds after UTC midnight of a GPS time of week."""
+    return ((tow_ms - GPS_UTC_LEAP_SECONDS * 1000) % DAY_MS) / 1000.0
+
+
+def clock(seconds):
+    return f"{int(seconds // 3600):02d}:{int(seconds % 3600 // 60):02d}:{seconds % 60:06.3f}"
+
+
+def decode(data):
+    """Yield one row per record of a segment, the last partial record is skipped."""
+    if len(data) < HEADER.size:
+        raise ValueError("segment shorter than its header")
+    magic, version, record_size, sequence, boot, rate, _ = HEADER.unpack_from(data)
+    if magic != b"BB" or version != VERSION or record_size != RECORD.size:
+        raise ValueError(f"not a version {VERSION} black box segment")
+    for offset in range(HEADER.size, len(data) - RECORD.size + 1, RECORD.size):
+        (time_ms, tow_ms, set_point, actual, heading, roll, pitch, output, age, speed, pwm, switches,
+         link_state) = RECORD.unpack_from(data, offset)
+        synced = bool(switches & SWITCH_SYNCED)
+        yield [
+            sequence, boot, time_ms, tow_ms if synced else "", clock(utc_of_day(tow_ms)) if synced else "",
+            set_point / 100.0, actual / 100.0, heading / 100.0, roll / 100.0, pitch / 100.0,
+            output, age, speed / 100.0, pwm,
+            int(bool(switches & SWITCH_STEER)), int(bool(switches & SWITCH_WORK)),
+            int(bool(switches & SWITCH_ENABLED)), int(bool(switches & SWITCH_REVERSED)), int(synced),
+            LINK_STATES[link_state] if link_state < len(LINK_STATES) else link_state,
+        ]
+
+
+def fetch(url, timeout):
+    with urllib.request.urlopen(url, timeout=timeout) as response:
+        return response.read()
+
+
+def parse_clock(text):
+    parts = [float(p) for p in text.split(":")]
+    while len(parts) < 3:
+        parts.append(0.0)
+    return parts[0] * 3600 + parts[1] * 60 + parts[2]
+
+
+def in_window(row, at, window):
+    if not row[4]:
+        return False
+    # Around midnight the distance wraps
+    distance = abs(utc_of_day(row[3]) - at)
+    return min(distance, 86400 - distance) <= window / 2
+
+
+def write_rows(rows, output):
+    if output.endswith(".parquet"):
+        try:
+            import pandas as pd
+        except ImportError:
+            sys.exit("Parquet output needs pandas and pyarrow")
+        pd.DataFrame(list(rows), columns=COLUMNS).to_parquet(output, index=False)
+        return
+    with open(output, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(COLUMNS)
+        writer.writerows(rows)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("files", nargs="*", help="stored segment files to decode instead of fetching")
+    parser.add_argument("--host", help="module address")
+    parser.add_argument("--list", action="store_true", help="print the module's segments and exit")
+    parser.add_argument("--segment", type=int, action="append", help="segment sequence, repeatable")
+    parser.add_argument("--last", type=int, help="the newest N segments")
+    parser.add_argument("--at", help="UTC time of day HH:MM[:SS], keep records around it")
+    parser.add_argument("--window", type=float, default=300, help="seconds kept around --at")
+    parser.add_argument("--save", help="directory to store the fetched segment files in")
+    parser.add_argument("-o", "--output", help="CSV or .parquet output file")
+    parser.add_argument("--timeout", type=float, default=10.0)
+    args = parser.parse_args()
+
+    segments = []
+    if args.host:
+        base = f"http://{args.host}"
+        index = json.loads(fetch(f"{base}/api/blackbox", args.timeout))
+        if args.list:
+            print(f"{len(index['segments'])} segments, {index['used_bytes'] // 1024} of "
+                  f"{index['total_bytes'] // 1024} KiB, {index['rate_hz']} Hz, "
+                  f"{index['dropped']} records dropped since boot")
+            for entry in index["segments"]:
+                print(f"  {entry['sequence']:8d} {entry['size']:8d} bytes")
+            return 0
+        wanted = [entry["sequence"] for entry in index["segments"]]
+        if args.segment:
+            wanted = [s for s in wanted if s in args.segment]
+        elif args.last:
+            wanted = wanted[-args.last:]
+        for sequence in wanted:
+            print(f"fetching segment {sequence}", file=sys.stderr)
+            data = fetch(f"{base}/api/blackbox/segment?sequence={sequence}", args.timeout)
+            if args.save:
+                os.makedirs(args.save, exist_ok=True)
+                with open(os.path.join(args.save, f"{sequence:08d}.bin"), "wb") as f:
+                    f.write(data)
+            segments.append((str(sequence), data))
+    for path in args.files:
+        with open(path, "rb") as f:
+            segments.append((path, f.read()))
+    if not segments:
+        parser.error("give --host or segment files")
+
+    def rows():
+        for name, data in segments:
+            try:
+                yield from decode(data)
+            except ValueError as e:
+                print(f"{name}: {e}", file=sys.stderr)
+
+    selected = rows()
+    if args.at:
+        at = parse_clock(args.at)
+        selected = (row for row in selected if in_window(row, at, args.window))
+
+    count = 0
+
+    def counted(source):
+        nonlocal count
+        for row in source:
+            count += 1
+            yield row
+
+    if args.output:
+        write_rows(counted(selected), args.output)
+    else:
+        for _ in counted(selected):
+            pass
+    print(f"{len(segments)} segments, {count} records", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+"""Read the metrics registry over the diagnostics port.
+
+Sends "metrics" to the module and decodes the binary snapshot, or prints the Prometheus
+text from /metrics with --http. With --interval it polls and prints counter rates. The
+layout matches src/utils/metrics.h; scrapers should use http://<board-ip>/metrics.
+
+    python tools/metrics_dump.py --host 192.168.178.126
+    python tools/metrics_dump.py --host 192.168.178.126 --interval 5
+    python tools/metrics_dump.py --host 192.168.178.126 --http
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import time
+import urllib.request
+
+DIAG_PORT = 7779
+VERSION = 1
+
+# Same order as metrics::Counter, metrics::Gauge and metrics::Histogram
+COUNTERS = [
+    "aog_bad_crc", "aog_unknown_pgn", "aog_bad_length", "aog_malformed", "gps_bytes_forwarded",
+    "eeprom_commits", "eeprom_commit_failures", "i2c_errors", "imu_resets", "motor_enable_transitions",
+]
+GAUGES = ["steer_enabled", "steer_angle", "steer_set_point", "pwm", "guidance_age_ms"]
+HISTOGRAMS = ["control_period_us", "steer_interval_ms"]
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def take(self, fmt):
+        values = struct.unpack_from("<" + fmt, self.data, self.offset)
+        self.offset += struct.calcsize("<" + fmt)
+        return values
+
+
+def decode(data):
+    r = Reader(data)
+    magic, version, _, uptime = r.take("2sBBI")
+    if magic != b"MT" or version != VERSION:
+        raise ValueError(data[:64])
+    (count,) = r.take("B")
+    counters = dict(zip(COUNTERS + [f"counter_{i}" for i in range(len(COUNTERS), count)], r.take(f"{count}I")))
+    (count,) = r.take("B")
+    gauges = dict(zip(GAUGES + [f"gauge_{i}" for i in range(len(GAUGES), count)], r.take(f"{count}f")))
+    histograms = {}
+    (count,) = r.take("B")
+    for i in range(count):
+        (buckets,) = r.take("B")
+        bounds = r.take(f"{buckets}I")
+        counts = r.take(f"{buckets + 1}I")
+        (total,) = r.take("I")
+        name = HISTOGRAMS[i] if i < len(HISTOGRAMS) else f"histogram_{i}"
+        histograms[name] = (bounds, counts, total)
+    (count,) = r.take("B")
+    pgns = dict(r.take("BI") for _ in range(count))
+    return uptime, counters, gauges, histograms, pgns
+
+
+def snapshot(host, port, timeout):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(timeout)
+    try:
+        sock.sendto(b"metrics", (host, port))
+        data, _ = sock.recvfrom(2048)
+    finally:
+        sock.close()
+    return decode(data)
+
+
+def show(current, previous):
+    uptime, counters, gauges, histograms, pgns = current
+    elapsed = (uptime - previous[0]) / 1000.0 if previous else 0
+
+    def rate(value, before):
+        return f"  {(value - before) / elapsed:10.1f}/s" if previous and elapsed > 0 else ""
+
+    print(f"uptime {uptime / 1000:.1f} s")
+    for name, value in counters.items():
+        print(f"  {name:28s} {value:10d}{rate(value, previous[1][name]) if previous else ''}")
+    for pgn, value in sorted(pgns.items()):
+        print(f"  {'pgn ' + str(pgn):28s} {value:10d}{rate(value, previous[4].get(pgn, 0)) if previous else ''}")
+    for name, value in gauges.items():
+        print(f"  {name:28s} {value:10.2f}")
+    for name, (bounds, counts, total) in histograms.items():
+        n = sum(counts)
+        print(f"  {name}: n={n} mean={total / n if n else 0:.1f}")
+        labels = [f"<={b}" for b in bounds] + [f">{bounds[-1]}"]
+        width = max(counts) or 1
+        for label, count in zip(labels, counts):
+            print(f"    {label:>8s} {count:9d} {'#' * int(40 * count / width)}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", required=True, help="module address")
+    parser.add_argument("--port", type=int, default=DIAG_PORT)
+    parser.add_argument("--http", action="store_true", help="print the Prometheus text instead")
+    parser.add_argument("--interval", type=float, default=0, help="poll every N seconds and show rates")
+    parser.add_argument("--timeout", type=float, default=2.0)
+    args = parser.parse_args()
+
+    if args.http:
+        with urllib.request.urlopen(f"http://{args.host}/metrics", timeout=args.timeout) as response:
+            sys.stdout.write(response.read().decode())
+        return 0
+
+    previous = None
+    try:
+        while True:
+            current = snapshot(args.host, args.port, args.timeout)
+            show(current, previous)
+            if not args.interval:
+                return 0
+            previous = current
+            time.sleep(args.interval)
+    except KeyboardInterrupt:
+        return 0
+    except socket.timeout:
+        print("no reply from the module", file=sys.stderr)
+        return 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,161 @@
+#!/usr/bin/env python3
+"""Firmware update over Ethernet.
+
+Streams a firmware image to the module's OTA port, shows progress and throughput, and with
+--wait follows the reboot on the diagnostics port until the new image has passed its boot
+health checks or was rolled back. The protocol is described in src/network/ota.h.
+
+    python tools/ota_push.py --host 192.168.178.126 --secret <OTA_SECRET> .pio/build/esp32-s3/firmware.bin
+    OTA_SECRET=<secret> python tools/ota_push.py --host 192.168.178.126 firmware.bin --wait 60
+
+The upload is authorized with an HMAC-SHA256 keyed with the OTA_SECRET the firmware was built with.
+"""
+
+import argparse
+import hashlib
+import hmac
+import os
+import socket
+import sys
+import time
+
+OTA_PORT = 3232
+DIAG_PORT = 7779
+BLOCK = 4096
+
+
+def read_line(sock):
+    line = b""
+    while not line.endswith(b"\n"):
+        byte = sock.recv(1)
+        if not byte:
+            raise ConnectionError("connection closed by the module")
+        line += byte
+    return line.decode(errors="replace").strip()
+
+
+def progress(done, total, start):
+    elapsed = max(time.monotonic() - start, 1e-3)
+    width = 40
+    filled = int(width * done / total)
+    print(f"\r[{'#' * filled}{'.' * (width - filled)}] {done * 100 // total:3d}% "
+          f"{done / 1024:7.0f} KiB {done / elapsed / 1024:6.1f} KiB/s", end="", file=sys.stderr, flush=True)
+
+
+def push(host, port, image, secret, timeout):
+    digest = hashlib.sha256(image).hexdigest()
+    sock = socket.create_connection((host, port), timeout=timeout)
+    try:
+        challenge = read_line(sock)
+        if not challenge.startswith("CHALLENGE "):
+            raise RuntimeError(f"unexpected greeting '{challenge}'")
+        message = f"{challenge.split()[1]} {len(image)} {digest}".encode()
+        mac = hmac.new(secret.encode(), message, hashlib.sha256).hexdigest()
+        sock.sendall(f"OTA {len(image)} {digest} {mac}\n".encode())
+        reply = read_line(sock)
+        if reply != "READY":
+            raise RuntimeError(reply)
+
+        start = time.monotonic()
+        acked = 0
+        buffered = b""
+        for offset in range(0, len(image), BLOCK):
+            sock.setblocking(True)
+            sock.sendall(image[offset:offset + BLOCK])
+            # Progress lines arrive while sending, read whatever is there without blocking
+            sock.setblocking(False)
+            try:
+                buffered += sock.recv(1024)
+            except BlockingIOError:
+                pass
+            *lines, buffered = buffered.split(b"\n")
+            for line in lines:
+                text = line.decode(errors="replace").strip()
+                if text.startswith("ERROR"):
+                    raise RuntimeError(text)
+                if text.startswith("PROGRESS"):
+                    acked = int(text.split()[1])
+            progress(min(offset + BLOCK, len(image)), len(image), start)
+        sock.setblocking(True)
+
+        # The module acknowledges the rest once it is written and verified
+        while True:
+            if b"\n" in buffered:
+                line, _, buffered = buffered.partition(b"\n")
+                text = line.decode(errors="replace").strip()
+            else:
+                text = (buffered.decode(errors="replace") + read_line(sock)).strip()
+                buffered = b""
+            if text.startswith("PROGRESS"):
+                acked = int(text.split()[1])
+                continue
+            if text == "OK":
+                break
+            raise RuntimeError(text)
+        elapsed = time.monotonic() - start
+        print(f"\n{acked} bytes written and verified in {elapsed:.1f} s ({acked / elapsed / 1024:.1f} KiB/s)",
+              file=sys.stderr)
+    finally:
+        sock.close()
+
+
+def status(host, port):
+    """Return the 'ota:' key=value reply as a dict, None while the module does not answer."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(1.0)
+    try:
+        sock.sendto(b"ota", (host, port))
+        data, _ = sock.recvfrom(1024)
+    except OSError:
+        return None
+    finally:
+        sock.close()
+    return dict(item.partition("=")[::2] for item in data.decode(errors="replace").split()[1:])
+
+
+def wait(host, port, seconds):
+    deadline = time.monotonic() + seconds
+    time.sleep(2.0)
+    while time.monotonic() < deadline:
+        values = status(host, port)
+        if values is not None:
+            if values.get("rolled_back") == "1":
+                print(f"rolled back, running {values.get('running')}", file=sys.stderr)
+                return False
+            if values.get("pending") == "0":
+                print(f"new image healthy, running {values.get('running')} version {values.get('version')}",
+                      file=sys.stderr)
+                return True
+        time.sleep(1.0)
+    print("module did not confirm the new image", file=sys.stderr)
+    return False
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("image", help="firmware.bin")
+    parser.add_argument("--host", required=True, help="module address")
+    parser.add_argument("--port", type=int, default=OTA_PORT)
+    parser.add_argument("--diag-port", type=int, default=DIAG_PORT)
+    parser.add_argument("--secret", default=os.environ.get("OTA_SECRET"),
+                        help="OTA_SECRET of the firmware, defaults to the OTA_SECRET environment variable")
+    parser.add_argument("--timeout", type=float, default=10.0, help="socket timeout in seconds")
+    parser.add_argument("--wait", type=float, default=0, help="seconds to follow the reboot and health checks")
+    args = parser.parse_args()
+
+    if not args.secret:
+        parser.error("--secret or OTA_SECRET is required")
+    with open(args.image, "rb") as f:
+        image = f.read()
+    try:
+        push(args.host, args.port, image, args.secret, args.timeout)
+    except (OSError, RuntimeError) as e:
+        print(f"\nupdate failed: {e}", file=sys.stderr)
+        return 1
+    if args.wait:
+        return 0 if wait(args.host, args.diag_port, args.wait) else 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""Record and decode the autosteer binary telemetry stream.
+
+Listens on the telemetry UDP port (or reads a capture written with --raw) and writes one
+row per control cycle record to CSV, or to Parquet when pandas and pyarrow are installed.
+The layout matches src/autosteer/telemetry.h.
+
+    python tools/telemetry_decode.py -o run.csv
+    python tools/telemetry_decode.py -o run.parquet --duration 60
+    python tools/telemetry_decode.py --raw run.bin            # store datagrams only
+    python tools/telemetry_decode.py --replay run.bin -o run.csv
+"""
+
+import argparse
+import csv
+import socket
+import struct
+import sys
+import time
+
+HEADER = struct.Struct("<2sBBIHH")
+RECORD = struct.Struct("<q10fhhBBHHHHBB")
+VERSION = 2
+
+COLUMNS = [
+    "time_us", "set_point", "actual", "error", "p_term", "ff_term", "pwm_limit",
+    "set_point_rate", "speed", "heading", "roll", "output", "was_raw", "pwm",
+    "enabled", "reversed", "hw_enable", "sw_enable", "synced",
+    "link_age_ms", "link_period_ms", "link_jitter_ms", "link_timeout_ms", "link_loss", "link_state",
+    "sequence",
+]
+
+LINK_STATES = ["waiting", "fresh", "grace", "lost"]
+
+FLAG_ENABLED = 0x01
+FLAG_REVERSED = 0x02
+FLAG_HW_ENABLE = 0x04
+FLAG_SW_ENABLE = 0x08
+FLAG_SYNCED = 0x10
+
+
+class Decoder:
+    def __init__(self):
+        self.expected_sequence = None
+        self.lost_datagrams = 0
+        self.dropped_records = 0
+        self.bad_datagrams = 0
+
+    def decode(self, datagram):
+        """Yield one row per record, tracking sequence gaps and on-device drops."""
+        if len(datagram) < HEADER.size:
+            self.bad_datagrams += 1
+            return
+        magic, version, record_size, sequence, count, dropped = HEADER.unpack_from(datagram)
+        if magic != b"TL" or version != VERSION or record_size != RECORD.size:
+            self.bad_datagrams += 1
+            return
+        if len(datagram) < HEADER.size + count * record_size:
+            self.bad_datagrams += 1
+            return
+
+        if self.expected_sequence is not None and sequence != self.expected_sequence:
+            self.lost_datagrams += (sequence - self.expected_sequence) & 0xFFFFFFFF
+        self.expected_sequence = (sequence + 1) & 0xFFFFFFFF
+        self.dropped_records += dropped
+
+        for i in range(count):
+            fields = RECORD.unpack_from(datagram, HEADER.size + i * record_size)
+            flags = fields[14]
+            yield list(fields[:14]) + [
+                int(bool(flags & FLAG_ENABLED)),
+                int(bool(flags & FLAG_REVERSED)),
+                int(bool(flags & FLAG_HW_ENABLE)),
+                int(bool(flags & FLAG_SW_ENABLE)),
+                int(bool(flags & FLAG_SYNCED)),
+                fields[15],
+                fields[16] / 10.0,
+                fields[17] / 10.0,
+                fields[18],
+                fields[19] / 200.0,
+                LINK_STATES[fields[20]] if fields[20] < len(LINK_STATES) else fields[20],
+                sequence,
+            ]
+
+
+def read_capture(path):
+    """Datagrams stored by --raw, each prefixed with a u16 length."""
+    with open(path, "rb") as f:
+        while True:
+            prefix = f.read(2)
+            if len(prefix) < 2:
+                return
+            (length,) = struct.unpack("<H", prefix)
+            yield f.read(length)
+
+
+def receive(port, duration, raw_file=None):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("", port))
+    sock.settimeout(0.5)
+    deadline = time.monotonic() + duration if duration else None
+    try:
+        while deadline is None or time.monotonic() < deadline:
+            try:
+                datagram, _ = sock.recvfrom(2048)
+            except socket.timeout:
+                continue
+            if raw_file:
+                raw_file.write(struct.pack("<H", len(datagram)) + datagram)
+            yield datagram
+    except KeyboardInterrupt:
+        return
+    finally:
+        sock.close()
+
+
+def write_rows(rows, output):
+    if output.endswith(".parquet"):
+        try:
+            import pandas as pd
+        except ImportError:
+            sys.exit("Parquet output needs pandas and pyarrow")
+        pd.DataFrame(list(rows), columns=COLUMNS).to_parquet(output, index=False)
+        return
+    with open(output, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(COLUMNS)
+        writer.writerows(rows)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("-p", "--port", type=int, default=7778, help="telemetry UDP port")
+    parser.add_argument("-o", "--output", help="CSV or .parquet output file")
+    parser.add_argument("-d", "--duration", type=float, default=0, help="stop after this many seconds")
+    parser.add_argument("--raw", help="also store the received datagrams in this file")
+    parser.add_argument("--replay", help="decode a file written with --raw instead of listening")
+    args = parser.parse_args()
+
+    if not args.output and not args.raw:
+        parser.error("give --output, --raw or both")
+
+    raw_file = open(args.raw, "wb") if args.raw and not args.replay else None
+    datagrams = read_capture(args.replay) if args.replay else receive(args.port, args.duration, raw_file)
+
+    decoder = Decoder()
+    rows = (row for datagram in datagrams for row in decoder.decode(datagram))
+    if args.output:
+        write_rows(rows, args.output)
+    else:
+        for _ in rows:
+            pass
+    if raw_file:
+        raw_file.close()
+
+    print(f"lost datagrams={decoder.lost_datagrams} dropped records={decoder.dropped_records} "
+          f"bad datagrams={decoder.bad_datagrams}", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Fetch the latency trace ring from the board and convert it to Chrome/Perfetto trace JSON.
+
+    python tools/trace_convert.py --host 192.168.178.126 start        # arm tracing
+    python tools/trace_convert.py --host 192.168.178.126 dump -o trace.json --raw trace.bin
+    python tools/trace_convert.py --input trace.bin -o trace.json      # convert a stored dump
+
+Open the JSON in https://ui.perfetto.dev or chrome://tracing. Each steer packet becomes an async
+span from UDP arrival to PWM output, with one slice per stage. A per-stage latency summary is
+printed to stderr. The layout matches src/utils/trace.h and src/network/diag.cpp.
+"""
+
+import argparse
+import json
+import socket
+import statistics
+import struct
+import sys
+
+DIAG_PORT = 7779
+HEADER = struct.Struct("<2sBBHH")
+EVENT = struct.Struct("<IIHBB")
+
+POINTS = [
+    "packet_rx",
+    "parse",
+    "setpoint_publish",
+    "control_start",
+    "was_sample",
+    "pwm_write",
+    "response_tx",
+]
+
+
+def command(host, port, text, timeout=2.0):
+    """Send a diagnostics command, return (binary datagrams, text replies)."""
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(timeout)
+    sock.sendto(text.encode(), (host, port))
+    binary, lines = [], []
+    try:
+        while True:
+            data, _ = sock.recvfrom(2048)
+            if data[:2] == b"TR":
+                binary.append(data)
+                continue
+            line = data.decode(errors="replace")
+            lines.append(line)
+            if not text.startswith("trace dump") or line.startswith("trace:"):
+                break
+    except socket.timeout:
+        pass
+    finally:
+        sock.close()
+    return binary, lines
+
+
+def parse_datagrams(datagrams):
+    events = []
+    for data in sorted(datagrams, key=lambda d: HEADER.unpack_from(d)[3]):
+        _, version, size, _, count = HEADER.unpack_from(data)
+        if version != 1 or size != EVENT.size:
+            sys.exit(f"unsupported trace format version={version} event size={size}")
+        for i in range(count):
+            events.append(EVENT.unpack_from(data, HEADER.size + i * size))
+    return events
+
+
+def unwrap(events):
+    """esp_timer is dumped as 32 bits and wraps every ~71 minutes."""
+    offset, previous, result = 0, None, []
+    for time_us, cycles, ident, point, core in events:
+        if previous is not None and time_us + offset < previous - (1 << 31):
+            offset += 1 << 32
+        previous = time_us + offset
+        result.append((time_us + offset, cycles, ident, point, core))
+    return result
+
+
+def to_chrome(events):
+    trace = []
+    by_id = {}
+    for time_us, cycles, ident, point, core in events:
+        name = POINTS[point] if point < len(POINTS) else f"point{point}"
+        trace.append({"name": name, "ph": "i", "s": "t", "ts": time_us, "pid": 1, "tid": core,
+                      "args": {"id": ident, "cycles": cycles}})
+        by_id.setdefault(ident, []).append((time_us, point))
+
+    stages = {}
+    for ident, points in by_id.items():
+        points.sort()
+        if len(points) < 2:
+            continue
+        start, end = points[0][0], points[-1][0]
+        trace.append({"name": f"steer {ident}", "cat": "latency", "ph": "b", "id": ident, "ts": start, "pid": 1})
+        trace.append({"name": f"steer {ident}", "cat": "latency", "ph": "e", "id": ident, "ts": end, "pid": 1})
+        for (t0, p0), (t1, p1) in zip(points, points[1:]):
+            stage = f"{POINTS[p0]} -> {POINTS[p1]}"
+            trace.append({"name": stage, "cat": "stage", "ph": "X", "ts": t0, "dur": t1 - t0,
+                          "pid": 2, "tid": p0})
+            stages.setdefault(stage, []).append(t1 - t0)
+        rx = [t for t, p in points if p == POINTS.index("packet_rx")]
+        pwm = [t for t, p in points if p == POINTS.index("pwm_write")]
+        if rx and pwm:
+            stages.setdefault("packet_rx => pwm_write", []).append(pwm[0] - rx[0])
+
+    trace.append({"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "events"}})
+    trace.append({"name": "process_name", "ph": "M", "pid": 2, "args": {"name": "stages"}})
+    return {"traceEvents": trace, "displayTimeUnit": "ms"}, stages
+
+
+def print_summary(stages):
+    for stage, durations in sorted(stages.items()):
+        durations.sort()
+        p95 = durations[min(len(durations) - 1, int(len(durations) * 0.95))]
+        print(f"{stage:40s} n={len(durations):5d} median={statistics.median(durations):8.0f}us "
+              f"p95={p95:8d}us max={durations[-1]:8d}us", file=sys.stderr)
+
+
+def read_raw(path):
+    datagrams = []
+    with open(path, "rb") as f:
+        while True:
+            prefix = f.read(2)
+            if len(prefix) < 2:
+                return datagrams
+            (length,) = struct.unpack("<H", prefix)
+            datagrams.append(f.read(length))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("action", nargs="?", default="dump", choices=["start", "stop", "dump"])
+    parser.add_argument("--host", help="board address")
+    parser.add_argument("--port", type=int, default=DIAG_PORT)
+    parser.add_argument("--input", help="convert a dump stored with --raw instead of fetching")
+    parser.add_argument("--raw", help="store the fetched dump datagrams")
+    parser.add_argument("-o", "--output", default="trace.json")
+    args = parser.parse_args()
+
+    if args.input:
+        datagrams = read_raw(args.input)
+    else:
+        if not args.host:
+            parser.error("--host or --input is required")
+        datagrams, lines = command(args.host, args.port, f"trace {args.action}")
+        for line in lines:
+            print(line, file=sys.stderr)
+        if args.action != "dump":
+            return
+        if args.raw:
+            with open(args.raw, "wb") as f:
+                for data in datagrams:
+                    f.write(struct.pack("<H", len(data)) + data)
+
+    events = unwrap(parse_datagrams(datagrams))
+    chrome, stages = to_chrome(events)
+    with open(args.output, "w") as f:
+        json.dump(chrome, f)
+    print(f"{len(events)} events written to {args.output}", file=sys.stderr)
+    print_summary(stages)
+
+
+if __name__ == "__main__":
+    main()
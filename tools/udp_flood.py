@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+"""Network load resilience test for the steer module.
+
+Starts a stress run on the module's diagnostics port, floods the autosteer (8888) and
+correction (2233) ports, optionally through the broadcast address, at a fixed packet rate,
+then collects the module's control loop period statistics, received datagram counts and
+per-core CPU load and prints a pass/fail report.
+
+    python tools/udp_flood.py --host 192.168.178.126 --pps 2000 --duration 30
+    python tools/udp_flood.py --host 192.168.178.126 --pps 5000 --broadcast --json run.json
+    python tools/udp_flood.py --host 192.168.178.126 --pps 5000 --baseline run.json
+    python tools/udp_flood.py --host 192.168.178.126 --pps 0 --json tasks.json
+    python tools/udp_flood.py --host 192.168.178.126 --pps 0 --baseline tasks.json
+
+With --baseline the run also fails when the period p99, period max or RX loss got worse than
+the stored run by more than --tolerance, and prints both runs side by side. --pps 0 measures
+without load, which together with a baseline from a build with the other SCHEDULER_CYCLIC
+setting compares the cyclic executive against the multi-task mode. The layout of the report
+matches src/utils/stress.h.
+"""
+
+import argparse
+import json
+import socket
+import sys
+import time
+
+DIAG_PORT = 7779
+STEER_PORT = 8888
+GPS_PORT = 2233
+
+
+def command(host, port, text, timeout=2.0):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.settimeout(timeout)
+    try:
+        sock.sendto(text.encode(), (host, port))
+        data, _ = sock.recvfrom(2048)
+        return data.decode(errors="replace")
+    finally:
+        sock.close()
+
+
+def parse_report(line):
+    """Turn 'stress: key=value ...' into a dict with numbers converted."""
+    values = {}
+    for item in line.split()[1:]:
+        key, _, value = item.partition("=")
+        try:
+            values[key] = float(value) if "." in value else int(value)
+        except ValueError:
+            values[key] = value
+    return values
+
+
+def flood(targets, pps, duration, size):
+    """Send round-robin to targets at pps for duration seconds, return packets sent per port."""
+    if pps <= 0:
+        time.sleep(duration)
+        return {}, duration
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+    # Neither an AOG header nor an RTCM preamble, the module has to reject every packet
+    payload = bytes([0x55]) * size
+    sent = {port: 0 for _, port in targets}
+    interval = 1.0 / pps
+    start = time.monotonic()
+    next_send = start
+    i = 0
+    while time.monotonic() - start < duration:
+        now = time.monotonic()
+        if now < next_send:
+            time.sleep(min(next_send - now, 0.001))
+            continue
+        # Catch up in bursts when the sleep overshoots
+        while next_send <= now:
+            address, port = targets[i % len(targets)]
+            try:
+                sock.sendto(payload, (address, port))
+                sent[port] += 1
+            except OSError:
+                pass
+            i += 1
+            next_send += interval
+    sock.close()
+    return sent, time.monotonic() - start
+
+
+def judge(report, sent, args):
+    failures = []
+    if not report.get("passed"):
+        failures.append(f"control loop period over limits (max {report.get('period_max_us')}us, "
+                        f"p99 {report.get('period_p99_us')}us)")
+    loss = {}
+    for port, key in ((STEER_PORT, "rx_autosteer"), (GPS_PORT, "rx_gps")):
+        if sent.get(port):
+            loss[port] = max(0.0, 1.0 - report.get(key, 0) / sent[port])
+            if loss[port] > args.max_loss:
+                failures.append(f"RX loss on {port} {loss[port] * 100:.2f}% > {args.max_loss * 100:.2f}%")
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            base = json.load(f)
+        limit = 1.0 + args.tolerance
+        for key in ("period_p99_us", "period_max_us"):
+            if base["report"].get(key) and report.get(key, 0) > base["report"][key] * limit:
+                failures.append(f"{key} {report[key]} worse than baseline {base['report'][key]}")
+        for port, value in loss.items():
+            base_loss = base["loss"].get(str(port), 0.0)
+            if value > base_loss + args.tolerance * max(base_loss, 0.001):
+                failures.append(f"RX loss on {port} {value * 100:.2f}% worse than baseline {base_loss * 100:.2f}%")
+    return failures, loss
+
+
+# Scheduler comparison rows: label, report key, format
+COMPARE = (
+    ("scheduler", "sched", "{}"),
+    ("period mean us", "period_mean_us", "{:.1f}"),
+    ("period p99 us", "period_p99_us", "{}"),
+    ("period max us", "period_max_us", "{}"),
+    ("jitter us", "jitter_us", "{:.1f}"),
+    ("idle core0 /s", "idle0", "{}"),
+    ("idle core1 /s", "idle1", "{}"),
+    ("task stacks B", "stack", "{}"),
+    ("heap free B", "heap_free", "{}"),
+    ("heap min B", "heap_min", "{}"),
+    ("frame overruns", "overruns", "{}"),
+    ("frame slips", "slips", "{}"),
+)
+
+
+def compare(base, report):
+    """Print the stored run and this one side by side."""
+    print(f"{'':16s} {'baseline':>12s} {'this run':>12s}")
+    for label, key, fmt in COMPARE:
+        cells = [fmt.format(r[key]) if key in r else "-" for r in (base, report)]
+        print(f"{label:16s} {cells[0]:>12s} {cells[1]:>12s}")
+    # Fewer idle hook runs per second on the same hardware means more CPU taken by the firmware
+    for core in (0, 1):
+        before, after = base.get(f"idle{core}"), report.get(f"idle{core}")
+        if before and after:
+            print(f"core{core} busy time change {(1.0 - after / before) * 100:+.1f}% of the baseline idle time")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--host", required=True, help="module address")
+    parser.add_argument("--diag-port", type=int, default=DIAG_PORT)
+    parser.add_argument("--pps", type=float, default=1000, help="total packets per second")
+    parser.add_argument("--duration", type=int, default=30, help="load window in seconds")
+    parser.add_argument("--size", type=int, default=64, help="payload bytes")
+    parser.add_argument("--ports", default=f"{STEER_PORT},{GPS_PORT}", help="comma separated target ports")
+    parser.add_argument("--broadcast", action="store_true", help="send to the broadcast address as well")
+    parser.add_argument("--broadcast-address", default="255.255.255.255")
+    parser.add_argument("--max-loss", type=float, default=0.01, help="allowed RX loss fraction")
+    parser.add_argument("--json", help="store the run for later --baseline comparisons")
+    parser.add_argument("--baseline", help="earlier --json run to compare against")
+    parser.add_argument("--tolerance", type=float, default=0.2, help="allowed relative regression")
+    args = parser.parse_args()
+
+    ports = [int(p) for p in args.ports.split(",") if p]
+    targets = [(args.host, port) for port in ports]
+    if args.broadcast:
+        targets += [(args.broadcast_address, port) for port in ports]
+
+    reply = parse_report(command(args.host, args.diag_port, f"stress start {args.duration}"))
+    baseline_s = reply.get("baseline_ms", 3000) / 1000.0
+    if args.pps > 0:
+        print(f"baseline {baseline_s:.1f} s, then {args.pps:.0f} pps for {args.duration} s to "
+              f"{', '.join(f'{a}:{p}' for a, p in targets)}", file=sys.stderr)
+    else:
+        print(f"baseline {baseline_s:.1f} s, then {args.duration} s without load", file=sys.stderr)
+    time.sleep(baseline_s + 0.3)
+
+    # Stop a little early so every packet lands inside the module's load window
+    sent, elapsed = flood(targets, args.pps, args.duration - 0.6, args.size)
+
+    report = {}
+    deadline = time.monotonic() + 5.0
+    while time.monotonic() < deadline:
+        time.sleep(0.5)
+        report = parse_report(command(args.host, args.diag_port, "stress report"))
+        if report.get("phase") == "done":
+            break
+    if report.get("phase") != "done":
+        print("module did not finish the run", file=sys.stderr)
+        return 2
+
+    failures, loss = judge(report, sent, args)
+    total = sum(sent.values())
+    print(f"sent {total} packets in {elapsed:.1f} s ({total / elapsed:.0f} pps)")
+    for port, count in sent.items():
+        print(f"  port {port}: sent {count}, loss {loss.get(port, 0.0) * 100:.2f}%")
+    print(f"control loop: cycles={report['cycles']} mean={report['period_mean_us']:.0f}us "
+          f"p99={report['period_p99_us']}us max={report['period_max_us']}us jitter={report['jitter_us']:.0f}us "
+          f"(limits p99 {report['limit_p99_us']}us, max {report['limit_max_us']}us)")
+    print(f"cpu load: core0 {report['cpu0'] * 100:.0f}% core1 {report['cpu1'] * 100:.0f}%")
+    print(f"scheduler: {report.get('sched', '-')} stacks={report.get('stack', '-')}B "
+          f"heap free={report.get('heap_free', '-')}B min={report.get('heap_min', '-')}B "
+          f"overruns={report.get('overruns', '-')} slips={report.get('slips', '-')}")
+    if args.baseline:
+        with open(args.baseline) as f:
+            compare(json.load(f)["report"], report)
+    print("PASS" if not failures else "FAIL")
+    for failure in failures:
+        print(f"  {failure}")
+
+    if args.json:
+        with open(args.json, "w") as f:
+            json.dump({"args": vars(args), "sent": sent, "loss": loss, "report": report}, f, indent=2)
+    return 0 if not failures else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())